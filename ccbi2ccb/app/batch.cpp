@@ -0,0 +1,436 @@
+#include "batch.h"
+#include "convert.h"
+#include "publish.h"
+#include "check.h"
+#include "../ccbanalyzer/CBIReader.h"
+#include "../util/file/ssFile.h"
+#include "../util/thread/ssWorkerPool.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+
+using namespace std;
+
+/*the batch converts .ccbi to .ccb, or back when publishing*/
+static const char* getInputExtension(const CCBIBatchOptions &options)
+{
+	return kCCBIBatchPublish == options.mode ? ".ccb" : ".ccbi";
+}
+
+static const char* getOutputExtension(const CCBIBatchOptions &options)
+{
+	if (kCCBIBatchPublish == options.mode)
+	{
+		return ".ccbi";
+	}
+	return getCCBIOutputExtension(options.convert);
+}
+
+static bool isInputFile(const string &path, const CCBIBatchOptions &options)
+{
+	return CCBIReader::endsWith(CCBIReader::toLowerCase(path.c_str()).c_str(), getInputExtension(options));
+}
+
+/*directory below which the matches of a glob keep their relative path*/
+static string globRoot(const string &pattern)
+{
+	string root = pattern;
+	while (SSHasWildcard(root))
+	{
+		root = SSDirName(root);
+	}
+	return root;
+}
+
+/*the output keeps the path of the input below root, under outDir or root itself*/
+static void addFile(const string &path, const string &root, const CCBIBatchOptions &options, vector<CCBIBatchJob> &jobs)
+{
+	CCBIBatchJob job;
+	job.input = path;
+	job.ok = false;
+	job.root = root;
+
+	string relative = path;
+	if (!root.empty() && 0 == path.compare(0, root.size(), root))
+	{
+		relative = path.substr(root.size());
+		while (!relative.empty() && ('/' == relative[0] || '\\' == relative[0]))
+		{
+			relative.erase(0, 1);
+		}
+	}
+
+	if (kCCBIBatchCheck != options.mode)
+	{
+		relative = CCBIReader::deletePathExtension(relative.c_str()) + getOutputExtension(options);
+		job.output = SSJoinPath(options.outDir.empty() ? root : options.outDir, relative);
+	}
+
+	jobs.push_back(job);
+}
+
+static void addSource(const string &source, const CCBIBatchOptions &options, vector<CCBIBatchJob> &jobs)
+{
+	if ('@' == source[0])
+	{
+		/*manifest: one source per line*/
+		vector<string> lines;
+		if (!SSReadLines(source.substr(1), lines))
+		{
+			CCBIBatchJob job;
+			job.input = source;
+			job.ok = false;
+			job.error = "can not read the manifest";
+			jobs.push_back(job);
+			return;
+		}
+		for (size_t i = 0; i < lines.size(); i++)
+		{
+			if ('#' != lines[i][0])
+			{
+				addSource(lines[i], options, jobs);
+			}
+		}
+	}
+	else if (SSHasWildcard(source))
+	{
+		vector<string> files;
+		SSExpandGlob(source, files);
+		string root = globRoot(source);
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			addFile(files[i], root, options, jobs);
+		}
+	}
+	else if (SSIsDirectory(source))
+	{
+		vector<string> files;
+		SSListFiles(source, true, files);
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			if (isInputFile(files[i], options))
+			{
+				addFile(files[i], source, options, jobs);
+			}
+		}
+	}
+	else
+	{
+		addFile(source, SSDirName(source), options, jobs);
+	}
+}
+
+/*the ccbi files a job includes, named below root*/
+static void readReferences(const CCBIBatchJob *pJob, string root, vector<string> *pReferences)
+{
+	CCBIReader reader(pJob->input.c_str());
+	reader.setCCBIRootPath(SSJoinPath(root, "").c_str());
+
+	/*a file that can not be decoded fails when it is converted*/
+	if (NULL != reader.getBytes() && reader.readHeader() && reader.readStringCache()
+		&& reader.readSequences() && reader.readNodeGraph())
+	{
+		reader.getCCBIFileReferences(*pReferences);
+	}
+}
+
+/*fail every job of the cycle closed by ref, which is open on the stack*/
+static void failCycle(const vector<pair<int, size_t> > &stack, int ref, vector<CCBIBatchJob> &jobs)
+{
+	size_t first = stack.size();
+	while (stack[first - 1].first != ref)
+	{
+		first--;
+	}
+	first--;
+
+	string cycle;
+	for (size_t i = first; i < stack.size(); i++)
+	{
+		cycle += jobs[stack[i].first].input + " -> ";
+	}
+	cycle += jobs[ref].input;
+
+	for (size_t i = first; i < stack.size(); i++)
+	{
+		CCBIBatchJob &job = jobs[stack[i].first];
+		if (job.error.empty())
+		{
+			job.error = "inclusion cycle " + cycle;
+		}
+	}
+}
+
+/*level of a job: 0 if it includes nothing, else one above its highest reference*/
+static void computeLevels(const vector<vector<int> > &references, vector<CCBIBatchJob> &jobs)
+{
+	enum { kUnvisited, kOpen, kDone };
+	vector<int> state(jobs.size(), kUnvisited);
+
+	/*depth first without recursion: the job and its next reference to visit*/
+	vector<pair<int, size_t> > stack;
+	for (size_t start = 0; start < jobs.size(); start++)
+	{
+		if (kUnvisited != state[start])
+		{
+			continue;
+		}
+
+		state[start] = kOpen;
+		stack.push_back(make_pair((int)start, (size_t)0));
+		while (!stack.empty())
+		{
+			int job = stack.back().first;
+			if (stack.back().second < references[job].size())
+			{
+				int ref = references[job][stack.back().second++];
+				if (kOpen == state[ref])
+				{
+					failCycle(stack, ref, jobs);
+				}
+				else if (kUnvisited == state[ref])
+				{
+					state[ref] = kOpen;
+					stack.push_back(make_pair(ref, (size_t)0));
+				}
+				continue;
+			}
+
+			int level = 0;
+			for (size_t i = 0; i < references[job].size(); i++)
+			{
+				level = max(level, jobs[references[job][i]].level + 1);
+			}
+			jobs[job].level = level;
+			state[job] = kDone;
+			stack.pop_back();
+		}
+	}
+}
+
+/*add a job for every file the jobs include, recursively, and order them*/
+static void resolveReferences(const CCBIBatchOptions &options, vector<CCBIBatchJob> &jobs)
+{
+	/*one job per file, whatever the spelling of its path*/
+	map<string, int> indices;
+	for (size_t i = 0; i < jobs.size(); i++)
+	{
+		indices.insert(make_pair(SSNormalizePath(jobs[i].input), (int)i));
+	}
+
+	/*read the references of each new round of jobs in parallel*/
+	vector<vector<int> > references;
+	SSWorkerPool pool(options.numThreads);
+	for (size_t scanned = 0; scanned < jobs.size();)
+	{
+		size_t end = jobs.size();
+		vector<vector<string> > found(end - scanned);
+		for (size_t i = scanned; i < end; i++)
+		{
+			if (jobs[i].error.empty())
+			{
+				string root = options.referenceRoot.empty() ? jobs[i].root : options.referenceRoot;
+				pool.submit(bind(readReferences, &jobs[i], SSNormalizePath(root), &found[i - scanned]));
+			}
+		}
+		pool.wait();
+
+		references.resize(end);
+		for (size_t i = scanned; i < end; i++)
+		{
+			const vector<string> &paths = found[i - scanned];
+			for (size_t j = 0; j < paths.size(); j++)
+			{
+				string path = SSNormalizePath(paths[j]);
+				map<string, int>::iterator it = indices.find(path);
+				if (it == indices.end())
+				{
+					string root = SSNormalizePath(options.referenceRoot.empty() ? jobs[i].root : options.referenceRoot);
+					addFile(path, root, options, jobs);
+					if (!SSIsFile(path))
+					{
+						jobs.back().error = "missing, included by " + jobs[i].input;
+					}
+					it = indices.insert(make_pair(path, (int)jobs.size() - 1)).first;
+				}
+				references[i].push_back(it->second);
+			}
+		}
+
+		scanned = end;
+	}
+
+	computeLevels(references, jobs);
+}
+
+static bool jobInputLess(const CCBIBatchJob &a, const CCBIBatchJob &b)
+{
+	return a.input < b.input;
+}
+
+static bool jobInputEqual(const CCBIBatchJob &a, const CCBIBatchJob &b)
+{
+	return a.input == b.input;
+}
+
+void collectBatchJobs(const CCBIBatchOptions &options, vector<CCBIBatchJob> &jobs)
+{
+	for (size_t i = 0; i < options.sources.size(); i++)
+	{
+		if (!options.sources[i].empty())
+		{
+			addSource(options.sources[i], options, jobs);
+		}
+	}
+
+	if (options.resolve)
+	{
+		resolveReferences(options, jobs);
+	}
+
+	/*same order and same outputs whatever order the sources came in*/
+	stable_sort(jobs.begin(), jobs.end(), jobInputLess);
+	jobs.erase(unique(jobs.begin(), jobs.end(), jobInputEqual), jobs.end());
+
+	map<string, string> owners;
+	for (size_t i = 0; i < jobs.size(); i++)
+	{
+		if (!jobs[i].error.empty() || jobs[i].output.empty())
+		{
+			continue;
+		}
+
+		map<string, string>::iterator it = owners.find(jobs[i].output);
+		if (it != owners.end())
+		{
+			jobs[i].error = "output " + jobs[i].output + " is already written for " + it->second;
+		}
+		else
+		{
+			owners[jobs[i].output] = jobs[i].input;
+		}
+	}
+}
+
+static void runJob(CCBIBatchJob *pJob, const CCBIBatchOptions *pOptions)
+{
+	if (kCCBIBatchCheck == pOptions->mode)
+	{
+		string report;
+		pJob->ok = checkCCBIFile(pJob->input.c_str(), report);
+		(pJob->ok ? pJob->summary : pJob->error) = report;
+		return;
+	}
+
+	if (!SSMakeDirectories(SSDirName(pJob->output)))
+	{
+		pJob->error = "can not create the output directory";
+		return;
+	}
+
+	CCBIStats *pStats = pOptions->statsFile.empty() ? NULL : &pJob->stats;
+	if (!pOptions->cache.dir.empty())
+	{
+		const char *pInput = pJob->input.c_str();
+		bool publish = kCCBIBatchPublish == pOptions->mode;
+		CCBIConvertFunction convert = publish
+			? CCBIConvertFunction(bind(publishCCBFile, pInput, placeholders::_1, placeholders::_2, cref(pOptions->convert)))
+			: CCBIConvertFunction(bind(convertCCBIFile, pInput, placeholders::_1, placeholders::_2, cref(pOptions->convert), pStats));
+
+		pJob->ok = runCachedConversion(pOptions->cache, getCCBICacheTag(publish, pOptions->convert),
+			pInput, pJob->output.c_str(), convert, pJob->cache, pJob->error);
+	}
+	else if (kCCBIBatchPublish == pOptions->mode)
+	{
+		pJob->ok = publishCCBFile(pJob->input.c_str(), pJob->output.c_str(), pJob->error, pOptions->convert);
+	}
+	else
+	{
+		pJob->ok = convertCCBIFile(pJob->input.c_str(), pJob->output.c_str(), pJob->error, pOptions->convert, pStats);
+	}
+}
+
+int runBatch(const CCBIBatchOptions &options)
+{
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	vector<CCBIBatchJob> jobs;
+	collectBatchJobs(options, jobs);
+
+	{
+		/*a level only starts once every file it includes is done*/
+		int maxLevel = 0;
+		for (size_t i = 0; i < jobs.size(); i++)
+		{
+			maxLevel = max(maxLevel, jobs[i].level);
+		}
+
+		SSWorkerPool pool(options.numThreads);
+		for (int level = 0; level <= maxLevel; level++)
+		{
+			for (size_t i = 0; i < jobs.size(); i++)
+			{
+				if (jobs[i].error.empty() && level == jobs[i].level)
+				{
+					pool.submit(bind(runJob, &jobs[i], &options));
+				}
+			}
+			pool.wait();
+		}
+	}
+
+	int failed = 0;
+	int hits = 0;
+	int unchanged = 0;
+	for (size_t i = 0; i < jobs.size(); i++)
+	{
+		if (jobs[i].ok && kCCBIBatchCheck == options.mode)
+		{
+			printf("ok    %s: %s\n", jobs[i].input.c_str(), jobs[i].summary.c_str());
+		}
+		else if (jobs[i].ok)
+		{
+			const CCBICacheResult &cache = jobs[i].cache;
+			printf("ok    %s -> %s%s\n", jobs[i].input.c_str(), jobs[i].output.c_str(),
+				cache.unchanged ? " (unchanged)" : cache.hit ? " (cached)" : "");
+			hits += cache.hit ? 1 : 0;
+			unchanged += cache.unchanged ? 1 : 0;
+		}
+		else
+		{
+			printf("FAIL  %s: %s\n", jobs[i].input.c_str(), jobs[i].error.c_str());
+			failed++;
+		}
+	}
+
+	double seconds = chrono::duration_cast<chrono::duration<double> >(chrono::steady_clock::now() - start).count();
+	printf("%d %s, %d failed, %d files in %.2fs\n", (int)jobs.size() - failed,
+		kCCBIBatchCheck == options.mode ? "valid" : "converted", failed, (int)jobs.size(), seconds);
+	if (!options.cache.dir.empty() && kCCBIBatchCheck != options.mode)
+	{
+		printf("%d from the cache, %d outputs unchanged\n", hits, unchanged);
+	}
+
+	if (!options.statsFile.empty() && kCCBIBatchConvert == options.mode)
+	{
+		vector<CCBIStatsRecord> records(jobs.size());
+		for (size_t i = 0; i < jobs.size(); i++)
+		{
+			records[i].input = jobs[i].input;
+			records[i].ok = jobs[i].ok;
+			records[i].cached = jobs[i].cache.hit;
+			records[i].stats = jobs[i].stats;
+		}
+
+		if (!writeCCBIStats(options.statsFile.c_str(), records))
+		{
+			printf("%s: can not write the stats\n", options.statsFile.c_str());
+			failed++;
+		}
+	}
+
+	return failed;
+}
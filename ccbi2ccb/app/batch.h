@@ -0,0 +1,82 @@
+#ifndef _CCBII_BATCH_H_
+#define _CCBII_BATCH_H_
+
+#include <string>
+#include <vector>
+
+#include "convert.h"
+#include "cache.h"
+#include "stats.h"
+
+enum {
+	kCCBIBatchConvert = 0,
+	kCCBIBatchPublish,
+	kCCBIBatchCheck
+};
+
+/**
+* @brief One input of a batch run and its result
+*/
+struct CCBIBatchJob
+{
+	std::string input;
+	std::string output;
+	bool ok;
+	std::string error;
+	/*what a check found in a valid file*/
+	std::string summary;
+	/*how the cache served the job, if one is used*/
+	CCBICacheResult cache;
+	/*directory the output path is relative to, and the root of its references*/
+	std::string root;
+	/*jobs run level by level, after every file they reference*/
+	int level;
+	/*kept when CCBIBatchOptions::statsFile is set*/
+	CCBIStats stats;
+
+	CCBIBatchJob() : ok(false), level(0) {}
+};
+
+/**
+* @brief Options of a batch run
+*/
+struct CCBIBatchOptions
+{
+	/*directories, glob patterns or @manifest files*/
+	std::vector<std::string> sources;
+	/*output root, empty to write each ccb next to its ccbi*/
+	std::string outDir;
+	/*worker threads, 0 for one per core*/
+	int numThreads;
+	/*applied to every job*/
+	CCBIConvertOptions convert;
+	/*kCCBIBatchConvert, kCCBIBatchPublish (.ccb to .ccbi) or kCCBIBatchCheck (no output)*/
+	int mode;
+	/*not used by kCCBIBatchCheck*/
+	CCBICacheOptions cache;
+	/*also run every ccbi the sources include, found through their CCBFile properties*/
+	bool resolve;
+	/*root the included files are named relative to, empty for the root of each source*/
+	std::string referenceRoot;
+	/*json file receiving the stats of every converted file and their total, empty for none*/
+	std::string statsFile;
+
+	CCBIBatchOptions() : numThreads(0), mode(kCCBIBatchConvert), resolve(false) {}
+};
+
+/**
+* @brief Expand the sources into a sorted, duplicate free list of jobs
+*
+* With resolve the list is closed over the ccbi files the jobs include,
+* each job's level is set after the ones it includes, and the jobs of an
+* inclusion cycle fail.
+*/
+void collectBatchJobs(const CCBIBatchOptions &options, std::vector<CCBIBatchJob> &jobs);
+
+/**
+* @brief Run every job on a worker pool and print a summary in job order
+* @return the number of failed jobs
+*/
+int runBatch(const CCBIBatchOptions &options);
+
+#endif
@@ -0,0 +1,114 @@
+#include "cache.h"
+#include "../ccbanalyzer/CBIReader.h"
+#include "../util/file/ssFile.h"
+#include "../util/hash/ssHash.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace std;
+
+/*bump whenever a conversion writes different bytes for the same input*/
+static const int kCCBICacheVersion = 2;
+
+string getCCBICacheTag(bool publish, const CCBIConvertOptions &options)
+{
+	/*the depth limit decides whether a deep input converts at all; the
+	number of threads does not change the output*/
+	char tag[96];
+	if (publish)
+	{
+		sprintf(tag, "cache %d publish ccbi %d max depth %d", kCCBICacheVersion, kCCBIVersion, options.maxDepth);
+	}
+	else
+	{
+		sprintf(tag, "cache %d convert format %d max depth %d", kCCBICacheVersion, options.format, options.maxDepth);
+	}
+	return tag;
+}
+
+/*a 128 bit key from two seeds, spread over 256 sub directories*/
+static string getEntryPath(const string &dir, const string &tag, const string &input)
+{
+	unsigned long long seed = SSHash64(tag.data(), tag.size());
+	unsigned long long high = SSHash64(input.data(), input.size(), seed);
+	unsigned long long low = SSHash64(input.data(), input.size(), ~seed);
+
+	char key[40];
+	sprintf(key, "%016llx%016llx", high, low);
+
+	return SSJoinPath(SSJoinPath(dir, string(key, 2)), key);
+}
+
+/*add the output to the cache; a failure only costs the next run a conversion*/
+static void storeEntry(const string &entry, const char *pOutFile)
+{
+	/*workers converting equal inputs store the same entry, each through a temp of its own*/
+	char suffix[32];
+	sprintf(suffix, ".%016llx.tmp", SSHash64(pOutFile, strlen(pOutFile)));
+	string temp = entry + suffix;
+
+	if (!SSMakeDirectories(SSDirName(entry)) || !SSCopyFile(pOutFile, temp) || !SSReplaceFile(temp, entry))
+	{
+		SSRemoveFile(temp);
+	}
+}
+
+bool runCachedConversion(const CCBICacheOptions &cache, const string &tag,
+	const char *pInFile, const char *pOutFile, const CCBIConvertFunction &convert,
+	CCBICacheResult &result, string &error)
+{
+	string input;
+	if (!SSReadFile(pInFile, input))
+	{
+		error = "can not read the input file";
+		return false;
+	}
+
+	string entry = getEntryPath(cache.dir, tag, input);
+	string temp = string(pOutFile) + ".tmp";
+
+	result.hit = SSIsFile(entry);
+	result.unchanged = false;
+
+	if (result.hit)
+	{
+		if (SSFilesEqual(entry, pOutFile))
+		{
+			result.unchanged = true;
+			return true;
+		}
+
+		SSRemoveFile(temp);
+		bool placed = (cache.link && SSLinkFile(entry, temp)) || SSCopyFile(entry, temp);
+		if (!placed || !SSReplaceFile(temp, pOutFile))
+		{
+			SSRemoveFile(temp);
+			error = "can not write the output file";
+			return false;
+		}
+		return true;
+	}
+
+	if (!convert(temp.c_str(), error))
+	{
+		SSRemoveFile(temp);
+		return false;
+	}
+
+	if (SSFilesEqual(temp, pOutFile))
+	{
+		SSRemoveFile(temp);
+		result.unchanged = true;
+	}
+	else if (!SSReplaceFile(temp, pOutFile))
+	{
+		SSRemoveFile(temp);
+		error = "can not write the output file";
+		return false;
+	}
+
+	storeEntry(entry, pOutFile);
+
+	return true;
+}
@@ -0,0 +1,62 @@
+#ifndef _CCBII_CACHE_H_
+#define _CCBII_CACHE_H_
+
+#include <functional>
+#include <string>
+
+#include "convert.h"
+
+/**
+* @brief Content addressed cache of converted files
+*
+* An entry is the output of one conversion, named by a hash of the input
+* bytes and of everything else the output depends on (see
+* getCCBICacheTag()). Entries are never evicted; deleting the directory
+* empties the cache.
+*/
+struct CCBICacheOptions
+{
+	/*directory of the cache, empty for no cache*/
+	std::string dir;
+	/*place hits as hard links to the entry instead of copies of it*/
+	bool link;
+
+	CCBICacheOptions() : link(false) {}
+};
+
+/**
+* @brief What runCachedConversion() did
+*/
+struct CCBICacheResult
+{
+	/*the output came from the cache, nothing was decoded*/
+	bool hit;
+	/*the output already held these bytes and was not written*/
+	bool unchanged;
+
+	CCBICacheResult() : hit(false), unchanged(false) {}
+};
+
+/*writes the output of the conversion to the given path*/
+typedef std::function<bool(const char *pOutFile, std::string &error)> CCBIConvertFunction;
+
+/**
+* @brief Name everything besides the input that the output depends on
+* @param publish ccb to ccbi instead of ccbi to ccb
+*/
+std::string getCCBICacheTag(bool publish, const CCBIConvertOptions &options);
+
+/**
+* @brief Produce pOutFile from pInFile, through the cache
+*
+* On a hit the entry is copied (or linked) to pOutFile, on a miss convert
+* runs and its output is added to the cache. Either way pOutFile is
+* replaced in one step, never written into, and is left alone when it
+* already holds the same bytes so that its mtime only moves with its
+* content.
+*/
+bool runCachedConversion(const CCBICacheOptions &cache, const std::string &tag,
+	const char *pInFile, const char *pOutFile, const CCBIConvertFunction &convert,
+	CCBICacheResult &result, std::string &error);
+
+#endif
@@ -0,0 +1,31 @@
+#include "check.h"
+#include "../ccbanalyzer/CBIMappedFile.h"
+#include "../ccbanalyzer/CBIChecker.h"
+
+#include <stdio.h>
+
+bool checkCCBIFile(const char *pCCBIFile, std::string &report)
+{
+	CCBIMappedFile file;
+	if (!file.open(pCCBIFile))
+	{
+		report = "can not read the input file";
+		return false;
+	}
+
+	CCBIChecker checker(file.getBytes(), file.getLength());
+
+	char summary[128];
+	if (!checker.check())
+	{
+		sprintf(summary, "offset %lu: ", (unsigned long)checker.getErrorOffset());
+		report = summary + checker.getError();
+		return false;
+	}
+
+	sprintf(summary, "%d nodes, %d properties, %d keyframes, %d strings, %d sequences",
+		checker.getNumNodes(), checker.getNumProperties(), checker.getNumKeyframes(),
+		checker.getNumStrings(), checker.getNumSequences());
+	report = summary;
+	return true;
+}
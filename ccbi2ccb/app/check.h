@@ -0,0 +1,13 @@
+#ifndef _CCBII_CHECK_H_
+#define _CCBII_CHECK_H_
+
+#include <string>
+
+/**
+* @brief Validate one ccbi file without converting it
+* @param report a one line summary when the file is valid, the first
+*        problem and its offset when it is not
+*/
+bool checkCCBIFile(const char *pCCBIFile, std::string &report);
+
+#endif
@@ -0,0 +1,229 @@
+#include "convert.h"
+#include "../ccbanalyzer/CBIReader.h"
+#include "../ccbanalyzer/CBIXMLEmitter.h"
+#include "../ccbanalyzer/CBIJSONEmitter.h"
+#include "../util/file/ssFile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+
+bool replaceCCBIOutput(const std::string &temp, const char *pOutFile, bool written)
+{
+	if (written && SSReplaceFile(temp, pOutFile))
+	{
+		return true;
+	}
+	SSRemoveFile(temp);
+	return false;
+}
+
+bool parseCCBIFormat(const char *pName, int &format)
+{
+	if (0 == strcmp(pName, "xml"))
+	{
+		format = kCCBIFormatXML;
+		return true;
+	}
+	if (0 == strcmp(pName, "bplist"))
+	{
+		format = kCCBIFormatBinary;
+		return true;
+	}
+	if (0 == strcmp(pName, "json"))
+	{
+		format = kCCBIFormatJSON;
+		return true;
+	}
+	return false;
+}
+
+const char* getCCBIOutputExtension(const CCBIConvertOptions &options)
+{
+	return kCCBIFormatJSON == options.format ? ".json" : ".ccb";
+}
+
+/*add the time since start to a phase of the stats, if they are kept, and start the next*/
+static void endPhase(CCBIStats *pStats, int phase, std::chrono::steady_clock::time_point &start)
+{
+	if (NULL != pStats)
+	{
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		pStats->phaseSeconds[phase] += std::chrono::duration_cast<std::chrono::duration<double> >(now - start).count();
+		start = now;
+	}
+}
+
+bool convertCCBIFile(const char *pCCBIFile, const char *pOutCCBFile, std::string &error,
+	const CCBIConvertOptions &options, CCBIStats *pStats)
+{
+	/*opening the input counts to the header*/
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	CCBIReader ccbir(pCCBIFile);
+	ccbir.setMaxDepth(options.maxDepth);
+	if (NULL == ccbir.getBytes())
+	{
+		error = "can not read the input file";
+		return false;
+	}
+
+	/*decode the whole file into the tree, the reader tells where it fails*/
+	if (!ccbir.readHeader())
+	{
+		error = ccbir.describeError();
+		return false;
+	}
+
+	endPhase(pStats, kCCBIPhaseReadHeader, start);
+
+	if (!ccbir.readStringCache())
+	{
+		error = ccbir.describeError();
+		return false;
+	}
+	endPhase(pStats, kCCBIPhaseReadStringCache, start);
+	if (!ccbir.readSequences())
+	{
+		error = ccbir.describeError();
+		return false;
+	}
+	endPhase(pStats, kCCBIPhaseReadSequences, start);
+	if (!ccbir.readNodeGraph())
+	{
+		error = ccbir.describeError();
+		return false;
+	}
+	endPhase(pStats, kCCBIPhaseReadNodeGraph, start);
+
+	/*then write it out as a ccb*/
+	CCBIPlistWriter writer;
+	emitCCBITree(ccbir.getTree(), ccbir.getLength(), options, writer);
+	endPhase(pStats, kCCBIPhaseEmit, start);
+
+	/*the json is written as it is, without newline translation*/
+	std::string temp = std::string(pOutCCBFile) + ".tmp";
+	if (!replaceCCBIOutput(temp, pOutCCBFile, writer.flushTo(temp.c_str(), kCCBIFormatXML != options.format)))
+	{
+		error = "can not write the output file";
+		return false;
+	}
+
+	if (NULL != pStats)
+	{
+		endPhase(pStats, kCCBIPhaseFlush, start);
+
+		countCCBITree(ccbir.getTree(), *pStats);
+		pStats->numFiles = 1;
+		pStats->inputBytes = ccbir.getPosition();
+		pStats->outputBytes = writer.getSize();
+	}
+
+	return true;
+}
+
+bool convertCCBIFileReusing(const char *pCCBIFile, const char *pOutCCBFile, std::string &error,
+	const CCBIConvertOptions &options, CCBIConvertBuffers &buffers)
+{
+	if (!SSReadFile(pCCBIFile, buffers.input))
+	{
+		error = "can not read the input file";
+		return false;
+	}
+
+	CCBIReader ccbir((const unsigned char*)buffers.input.data(), buffers.input.size());
+	ccbir.setMaxDepth(options.maxDepth);
+	if (!ccbir.readHeader() || !ccbir.readStringCache() || !ccbir.readSequences() || !ccbir.readNodeGraph())
+	{
+		error = ccbir.describeError();
+		return false;
+	}
+
+	buffers.output.clear();
+	emitCCBITree(ccbir.getTree(), buffers.input.size(), options, buffers.output);
+
+	std::string temp = std::string(pOutCCBFile) + ".tmp";
+	if (!replaceCCBIOutput(temp, pOutCCBFile, buffers.output.flushTo(temp.c_str(), kCCBIFormatXML != options.format)))
+	{
+		error = "can not write the output file";
+		return false;
+	}
+
+	return true;
+}
+
+/*decode the node graph one event at a time into an emitter with the
+emitStart(), writeNodeStart(), writeNodeEnd() and emitEnd() of the xml one*/
+template <typename Emitter>
+static bool streamNodeGraph(CCBIReader &ccbir, Emitter &emitter, CCBIPlistWriter &writer,
+	FILE *pOutput, std::string &error)
+{
+	/*the output is handed on whenever this much of it is buffered*/
+	static const size_t kDrainSize = 64 * 1024;
+
+	emitter.emitStart();
+
+	int event;
+	int index;
+	while (kCCBINodeGraphEnd != (event = ccbir.readNodeEvent(index)))
+	{
+		if (kCCBINodeGraphError == event)
+		{
+			error = ccbir.describeError();
+			return false;
+		}
+
+		if (kCCBINodeStart == event)
+		{
+			emitter.writeNodeStart(index);
+		}
+		else
+		{
+			emitter.writeNodeEnd(index);
+		}
+
+		if (writer.getSize() >= kDrainSize && !writer.drainTo(pOutput))
+		{
+			error = "can not write the output";
+			return false;
+		}
+	}
+
+	emitter.emitEnd();
+	if (!writer.drainTo(pOutput) || 0 != fflush(pOutput))
+	{
+		error = "can not write the output";
+		return false;
+	}
+
+	return true;
+}
+
+bool convertCCBIStream(FILE *pInput, FILE *pOutput, std::string &error,
+	const CCBIConvertOptions &options)
+{
+	if (kCCBIFormatBinary == options.format)
+	{
+		error = "only the xml and json formats can be streamed";
+		return false;
+	}
+
+	CCBIReader ccbir(pInput);
+	ccbir.setMaxDepth(options.maxDepth);
+	if (!ccbir.readHeader() || !ccbir.readStringCache() || !ccbir.readSequences())
+	{
+		error = ccbir.describeError();
+		return false;
+	}
+
+	CCBIPlistWriter writer;
+	if (kCCBIFormatJSON == options.format)
+	{
+		CCBIJSONEmitter emitter(ccbir.getTree(), writer);
+		return streamNodeGraph(ccbir, emitter, writer, pOutput, error);
+	}
+
+	CCBIXMLEmitter emitter(ccbir.getTree(), writer);
+	return streamNodeGraph(ccbir, emitter, writer, pOutput, error);
+}
@@ -0,0 +1,69 @@
+#ifndef _CCBII_CONVERT_H_
+#define _CCBII_CONVERT_H_
+
+#include <string>
+
+#include <stdio.h>
+
+#include "../ccbanalyzer/CBIReader.h"
+#include "../ccbanalyzer/CBIConverter.h"
+#include "../ccbanalyzer/CBIPlistWriter.h"
+#include "stats.h"
+
+/**
+* @brief Move the temp an output was written to over pOutFile, or drop it
+* when it was not written
+*
+* Outputs are never rewritten in place: one which --cache-link made a hard
+* link to a cache entry is replaced by a new file, the entry is left as it is.
+*/
+bool replaceCCBIOutput(const std::string &temp, const char *pOutFile, bool written);
+
+/**
+* @brief Parse the value of --format, "xml", "bplist" or "json"
+*/
+bool parseCCBIFormat(const char *pName, int &format);
+
+/*extension of the converted files, ".ccb" or ".json"*/
+const char* getCCBIOutputExtension(const CCBIConvertOptions &options);
+
+/**
+* @brief Convert one ccbi file into a ccb plist, or its json
+* @param error set to a short reason when the conversion fails
+* @param pStats if not NULL, receives the time of every phase and the
+*        counts of the file, when the conversion succeeds
+*/
+bool convertCCBIFile(const char *pCCBIFile, const char *pOutCCBFile, std::string &error,
+	const CCBIConvertOptions &options = CCBIConvertOptions(), CCBIStats *pStats = NULL);
+
+/**
+* @brief The input and output buffers of a conversion, kept for the next
+* one so a resident process does not grow them again for every file
+*/
+struct CCBIConvertBuffers
+{
+	std::string input;
+	CCBIPlistWriter output;
+};
+
+/**
+* @brief Convert one ccbi file like convertCCBIFile(), through buffers
+* that keep their capacity from file to file
+*/
+bool convertCCBIFileReusing(const char *pCCBIFile, const char *pOutCCBFile, std::string &error,
+	const CCBIConvertOptions &options, CCBIConvertBuffers &buffers);
+
+/**
+* @brief Convert a ccbi read from a stream (stdin, a pipe) into a ccb xml
+* plist or its json
+*
+* The input is decoded and the output written one node at a time, so
+* memory is bounded by the string cache, the sequences and the depth of the
+* node graph instead of the size of the file. The xml and json formats can
+* be written this way, a bplist needs the whole document for its offset table.
+* @param pOutput receives the output as it is produced, it is not closed
+*/
+bool convertCCBIStream(FILE *pInput, FILE *pOutput, std::string &error,
+	const CCBIConvertOptions &options = CCBIConvertOptions());
+
+#endif
@@ -2,68 +2,489 @@
 #include <fstream>
 #include "../ccbanalyzer/CBIReader.h"
 #include "../ccbanalyzer/ccbimapping.h"
+#include "batch.h"
+#include "watch.h"
+#include "select.h"
+#include "convert.h"
+#include "publish.h"
+#include "check.h"
+#include "cache.h"
+#include "stats.h"
 
+#include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
-#include <algorithm>
+#include <string.h>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+#include <string>
 #include <vector>
 
 using namespace std;
 
-void Display(vector<int>& v, const char* s);
+static void printUsage()
+{
+	printf("usage: ccbi2ccb [--format=xml|bplist|json] [--max-depth=N] [-j threads] [--cache dir] [--stats out.json] [--stream] <in.ccbi> <out.ccb>\n");
+	printf("       ccbi2ccb --publish [--max-depth=N] [--cache dir] <in.ccb> <out.ccbi>\n");
+	printf("       ccbi2ccb --check <in.ccbi> ...\n");
+	printf("       ccbi2ccb --select <query> [--format=xml|json] [--index] <in.ccbi> [<out> | -]\n");
+	printf("       ccbi2ccb --watch <dir> [--format=xml|bplist|json] [-j threads] [--debounce ms] [-o outdir]\n");
+	printf("       ccbi2ccb --batch [--format=xml|bplist|json] [--publish | --check] [--resolve [--root dir]] [-j threads] [--cache dir] [--stats out.json] [-o outdir] <dir | glob | @manifest> ...\n");
+	printf("\n");
+	printf("  --format    xml plist (the default), binary plist (bplist00) or json\n");
+	printf("              with the same document; --batch writes json to .json files\n");
+	printf("  --max-depth=N  refuse node graphs deeper than N levels, default %d\n", kCCBIDefaultMaxDepth);
+	printf("  --publish   compile xml .ccb files back into version 5 .ccbi files\n");
+	printf("  --stream    decode and write one node at a time with bounded memory,\n");
+	printf("              xml or json; implied when <in.ccbi> or <out.ccb> is '-' for\n");
+	printf("              stdin or stdout\n");
+	printf("  --check     only validate the .ccbi files and report the first problem\n");
+	printf("              of each with its offset, nothing is written\n");
+	printf("  --select    write only the sequences (query 'sequences') or the nodes of\n");
+	printf("              a path like CCLayer/panel/CCSprite[3], to stdout by default;\n");
+	printf("              a node is named by its class, its member variable, both as\n");
+	printf("              Class(member) or '*', [n] picks child n; other subtrees are\n");
+	printf("              skipped\n");
+	printf("  --index     keep the offsets of the selected nodes in <in.ccbi>.idx so\n");
+	printf("              the same query of the unchanged file decodes only them\n");
+	printf("  --watch     stay resident and convert every .ccbi written below dir from\n");
+	printf("              then on, once its writes settle for --debounce ms (300)\n");
+	printf("  --batch     convert every .ccbi (.ccb with --publish) of the directories\n");
+	printf("              (recursively), every file matching the globs ('*', '?',\n");
+	printf("              '**') and every source listed in the manifest files, one\n");
+	printf("              per line\n");
+	printf("  --resolve   also convert every .ccbi the inputs include (CCBFile\n");
+	printf("              properties), recursively and each once; a file is\n");
+	printf("              converted after the ones it includes, inclusion cycles fail\n");
+	printf("  --root dir  directory the included files are named relative to; by\n");
+	printf("              default the directory of the input or of its source\n");
+	printf("  -j threads  number of worker threads, default one per core; a single\n");
+	printf("              file uses them to write a large node graph\n");
+	printf("  -o outdir   write the .ccb files below outdir, keeping their relative\n");
+	printf("              path; by default each .ccb is written next to its .ccbi\n");
+	printf("  --cache dir reuse the outputs of inputs converted before, found by a hash\n");
+	printf("              of their bytes, and leave outputs that would not change\n");
+	printf("              untouched; not used with --stream\n");
+	printf("  --cache-link  place cached outputs as hard links instead of copies\n");
+	printf("  --stats out.json  write the time of every phase of each converted file,\n");
+	printf("              its counts of strings, nodes, properties and keyframes\n");
+	printf("              and their total as json; not used with --stream or --publish\n");
+}
 
-int main(int argc, char *argv[])
+/**
+* @brief Handle --cache dir and --cache-link, moving i past their values
+* @return false if argv[i] is not one of them
+*/
+static bool parseCacheOption(int argc, char *argv[], int &i, CCBICacheOptions &cache)
+{
+	if (0 == strcmp(argv[i], "--cache") && i + 1 < argc)
+	{
+		cache.dir = argv[++i];
+		return true;
+	}
+	if (0 == strcmp(argv[i], "--cache-link"))
+	{
+		cache.link = true;
+		return true;
+	}
+	return false;
+}
+
+/**
+* @brief Handle an option every mode takes
+* @return false if pArg is not one, or its value is bad
+*/
+static bool parseConvertOption(const char *pArg, CCBIConvertOptions &options)
+{
+	static const char kFormat[] = "--format=";
+	static const char kMaxDepth[] = "--max-depth=";
+
+	if (0 == strncmp(pArg, kFormat, sizeof(kFormat) - 1))
+	{
+		return parseCCBIFormat(pArg + sizeof(kFormat) - 1, options.format);
+	}
+	if (0 == strncmp(pArg, kMaxDepth, sizeof(kMaxDepth) - 1))
+	{
+		options.maxDepth = atoi(pArg + sizeof(kMaxDepth) - 1);
+		return options.maxDepth > 0;
+	}
+	return false;
+}
+
+static int batchMain(int argc, char *argv[])
+{
+	CCBIBatchOptions options;
+
+	for (int i = 2; i < argc; i++)
+	{
+		if (parseConvertOption(argv[i], options.convert) || parseCacheOption(argc, argv, i, options.cache))
+		{
+			continue;
+		}
+		else if (0 == strcmp(argv[i], "--publish"))
+		{
+			options.mode = kCCBIBatchPublish;
+		}
+		else if (0 == strcmp(argv[i], "--check"))
+		{
+			options.mode = kCCBIBatchCheck;
+		}
+		else if (0 == strcmp(argv[i], "--resolve"))
+		{
+			options.resolve = true;
+		}
+		else if (0 == strcmp(argv[i], "--root") && i + 1 < argc)
+		{
+			options.referenceRoot = argv[++i];
+		}
+		else if (0 == strcmp(argv[i], "--stats") && i + 1 < argc)
+		{
+			options.statsFile = argv[++i];
+		}
+		else if (0 == strncmp(argv[i], "--", 2))
+		{
+			printUsage();
+			return 2;
+		}
+		else if (0 == strcmp(argv[i], "-j") && i + 1 < argc)
+		{
+			options.numThreads = atoi(argv[++i]);
+		}
+		else if (0 == strcmp(argv[i], "-o") && i + 1 < argc)
+		{
+			options.outDir = argv[++i];
+		}
+		else
+		{
+			options.sources.push_back(argv[i]);
+		}
+	}
+
+	/*published ccb files name their includes as ccb, nothing to resolve*/
+	if (options.sources.empty() || (options.resolve && kCCBIBatchPublish == options.mode))
+	{
+		printUsage();
+		return 2;
+	}
+
+	return 0 == runBatch(options) ? 0 : 1;
+}
+
+static int watchMain(int argc, char *argv[])
 {
-	CCBIReader *ccbir = new CCBIReader(argv[1], argv[2]);
+	CCBIWatchOptions options;
 
-	/*xml head*/
-	ccbir->writeXMLDeclaration();
-	ccbir->writeXMLRootStartPart();
-	ccbir->writeXMLDictStartTag();
+	for (int i = 2; i < argc; i++)
+	{
+		if (parseConvertOption(argv[i], options.convert))
+		{
+			continue;
+		}
+		else if (0 == strcmp(argv[i], "--debounce") && i + 1 < argc)
+		{
+			options.debounceMs = atoi(argv[++i]);
+		}
+		else if (0 == strncmp(argv[i], "--", 2))
+		{
+			printUsage();
+			return 2;
+		}
+		else if (0 == strcmp(argv[i], "-j") && i + 1 < argc)
+		{
+			options.numThreads = atoi(argv[++i]);
+		}
+		else if (0 == strcmp(argv[i], "-o") && i + 1 < argc)
+		{
+			options.outDir = argv[++i];
+		}
+		else if (options.dir.empty())
+		{
+			options.dir = argv[i];
+		}
+		else
+		{
+			printUsage();
+			return 2;
+		}
+	}
 
-	ccbir->readHeader();
+	if (options.dir.empty() || options.debounceMs < 0)
+	{
+		printUsage();
+		return 2;
+	}
 
-	ccbir->readStringCache();
+	return runWatch(options) ? 0 : 1;
+}
+
+static int selectMain(int argc, char *argv[])
+{
+	CCBISelectOptions options;
+	const char *pInput = NULL;
+	const char *pOutput = NULL;
 
-	/*write the default values*/
-	ccbir->writeXMLNotes();
-	ccbir->writeXMLResolutions();
+	for (int i = 2; i < argc; i++)
+	{
+		if (parseConvertOption(argv[i], options.convert))
+		{
+			continue;
+		}
+		else if (0 == strcmp(argv[i], "--index"))
+		{
+			options.useIndex = true;
+		}
+		else if (0 == strncmp(argv[i], "--", 2))
+		{
+			printUsage();
+			return 2;
+		}
+		else if (options.query.empty())
+		{
+			options.query = argv[i];
+		}
+		else if (NULL == pInput)
+		{
+			pInput = argv[i];
+		}
+		else if (NULL == pOutput)
+		{
+			pOutput = argv[i];
+		}
+		else
+		{
+			printUsage();
+			return 2;
+		}
+	}
 
-	/*write the sequences into the local file*/
-	ccbir->readSequences();
+	if (NULL == pInput)
+	{
+		printUsage();
+		return 2;
+	}
+	pOutput = NULL == pOutput ? "-" : pOutput;
+
+	/*text mode, so the line ends match the ones of a converted file*/
+	FILE *pOut = stdout;
+	string temp = string(pOutput) + ".tmp";
+	if (0 != strcmp(pOutput, "-") && NULL == (pOut = fopen(temp.c_str(), "w")))
+	{
+		printf("%s: can not write the output file\n", pOutput);
+		return 1;
+	}
+
+	string error;
+	bool ok = selectCCBIFile(pInput, pOut, error, options);
+	if (stdout != pOut)
+	{
+		bool closed = 0 == fclose(pOut);
+		if (!replaceCCBIOutput(temp, pOutput, ok && closed) && ok)
+		{
+			ok = false;
+			error = "can not write the output file";
+		}
+	}
+
+	if (!ok)
+	{
+		/*stdout may be the output, report on stderr*/
+		fprintf(stderr, "%s: %s\n", pInput, error.c_str());
+		return 1;
+	}
+
+	return 0;
+}
 
-	/*write the nodegraph into the local file*/
-	ccbir->writeXMLNodegraphHead();
-	ccbir->readNodeGraph();
+static int checkMain(int argc, char *argv[])
+{
+	if (argc < 3)
+	{
+		printUsage();
+		return 2;
+	}
 
-	/*write the xml tail*/
-	ccbir->writeXMLDictEndTag();
-	ccbir->writeXMLRootEndPart();
+	int failed = 0;
+	for (int i = 2; i < argc; i++)
+	{
+		string report;
+		if (checkCCBIFile(argv[i], report))
+		{
+			printf("ok    %s: %s\n", argv[i], report.c_str());
+		}
+		else
+		{
+			printf("FAIL  %s: %s\n", argv[i], report.c_str());
+			failed++;
+		}
+	}
 
-	/*
-	srand(time(NULL));
+	return 0 == failed ? 0 : 1;
+}
 
-	vector<int> v();
+/*convert a single file as a stream, "-" standing for stdin or stdout*/
+static int streamMain(const char *pInput, const char *pOutput, const CCBIConvertOptions &options)
+{
+	FILE *pIn = stdin;
+	FILE *pOut = stdout;
+	if (0 == strcmp(pInput, "-"))
+	{
+#ifdef _WIN32
+		_setmode(_fileno(stdin), _O_BINARY);
+#endif
+	}
+	else if (NULL == (pIn = fopen(pInput, "rb")))
+	{
+		printf("%s: can not read the input file\n", pInput);
+		return 1;
+	}
 
-	vector<int> collection(10);
-	for (int i = 0; i < 10; i++)
+	/*text mode, so the line ends match the ones of a converted file*/
+	string temp = string(pOutput) + ".tmp";
+	if (0 != strcmp(pOutput, "-") && NULL == (pOut = fopen(temp.c_str(), "w")))
 	{
-		collection[i] = rand() % 10000;
+		printf("%s: can not write the output file\n", pOutput);
+		if (stdin != pIn)
+		{
+			fclose(pIn);
+		}
+		return 1;
 	}
 
-	Display(collection, "Before sorting");
-	sort(collection.begin(), collection.end());
-	Display(collection, "After sorting");
-	*/
+	string error;
+	bool ok = convertCCBIStream(pIn, pOut, error, options);
 
-	printf("%s", XML_SIMPLE_ELEMENT("hello", ""));
+	if (stdin != pIn)
+	{
+		fclose(pIn);
+	}
+	if (stdout != pOut)
+	{
+		bool closed = 0 == fclose(pOut);
+		if (!replaceCCBIOutput(temp, pOutput, ok && closed) && ok)
+		{
+			ok = false;
+			error = "can not write the output file";
+		}
+	}
+
+	if (!ok)
+	{
+		/*stdout may be the output, report on stderr*/
+		fprintf(stderr, "%s: %s\n", pInput, error.c_str());
+		return 1;
+	}
 
 	return 0;
 }
 
-void Display(vector<int>& v, const char* s)
+int main(int argc, char *argv[])
 {
-	cout << endl << s << endl;
-	copy(v.begin(), v.end(), ostream_iterator<int>(cout, "\t"));
-	cout << endl;
-}
\ No newline at end of file
+	if (argc >= 2 && 0 == strcmp(argv[1], "--batch"))
+	{
+		return batchMain(argc, argv);
+	}
+	if (argc >= 2 && 0 == strcmp(argv[1], "--check"))
+	{
+		return checkMain(argc, argv);
+	}
+	if (argc >= 2 && 0 == strcmp(argv[1], "--select"))
+	{
+		return selectMain(argc, argv);
+	}
+	if (argc >= 2 && 0 == strcmp(argv[1], "--watch"))
+	{
+		return watchMain(argc, argv);
+	}
+
+	/*a single file is worth the cores, a batch already spreads its files over them*/
+	CCBIConvertOptions options;
+	options.numThreads = 0;
+	bool publish = false;
+	bool stream = false;
+	const char *pStatsFile = NULL;
+	CCBICacheOptions cache;
+	vector<const char*> files;
+	for (int i = 1; i < argc; i++)
+	{
+		if (parseConvertOption(argv[i], options) || parseCacheOption(argc, argv, i, cache))
+		{
+			continue;
+		}
+		if (0 == strcmp(argv[i], "-j") && i + 1 < argc)
+		{
+			options.numThreads = atoi(argv[++i]);
+			continue;
+		}
+		if (0 == strcmp(argv[i], "--publish"))
+		{
+			publish = true;
+			continue;
+		}
+		if (0 == strcmp(argv[i], "--stream"))
+		{
+			stream = true;
+			continue;
+		}
+		if (0 == strcmp(argv[i], "--stats") && i + 1 < argc)
+		{
+			pStatsFile = argv[++i];
+			continue;
+		}
+		if (0 == strncmp(argv[i], "--", 2))
+		{
+			printUsage();
+			return 2;
+		}
+		files.push_back(argv[i]);
+	}
+
+	if (files.size() != 2)
+	{
+		printUsage();
+		return 2;
+	}
+
+	if (!publish && (stream || 0 == strcmp(files[0], "-") || 0 == strcmp(files[1], "-")))
+	{
+		return streamMain(files[0], files[1], options);
+	}
+
+	string error;
+	bool ok;
+	CCBIStatsRecord record;
+	CCBIStats *pStats = NULL == pStatsFile ? NULL : &record.stats;
+	if (!cache.dir.empty())
+	{
+		CCBIConvertFunction convert = publish
+			? CCBIConvertFunction(bind(publishCCBFile, files[0], placeholders::_1, placeholders::_2, cref(options)))
+			: CCBIConvertFunction(bind(convertCCBIFile, files[0], placeholders::_1, placeholders::_2, cref(options), pStats));
+
+		CCBICacheResult result;
+		ok = runCachedConversion(cache, getCCBICacheTag(publish, options), files[0], files[1], convert, result, error);
+		record.cached = result.hit;
+	}
+	else
+	{
+		ok = publish ? publishCCBFile(files[0], files[1], error, options)
+			: convertCCBIFile(files[0], files[1], error, options, pStats);
+	}
+	if (!ok)
+	{
+		printf("%s: %s\n", files[0], error.c_str());
+	}
+
+	if (NULL != pStatsFile && !publish)
+	{
+		vector<CCBIStatsRecord> records(1, record);
+		records[0].input = files[0];
+		records[0].ok = ok;
+		if (!writeCCBIStats(pStatsFile, records))
+		{
+			printf("%s: can not write the stats\n", pStatsFile);
+			return 1;
+		}
+	}
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+#include "publish.h"
+#include "../ccbanalyzer/CBIMappedFile.h"
+#include "../ccbanalyzer/CBIPlistParser.h"
+#include "../ccbanalyzer/CBIPlistDocument.h"
+#include "../ccbanalyzer/CBIPublisher.h"
+#include "../ccbanalyzer/CBIWriter.h"
+
+#include <stdio.h>
+
+bool publishCCBFile(const char *pCCBFile, const char *pOutCCBIFile, std::string &error,
+	const CCBIConvertOptions &options)
+{
+	CCBIMappedFile file;
+	if (!file.open(pCCBFile))
+	{
+		error = "can not read the input file";
+		return false;
+	}
+
+	/*the ccb dict keys come in any order, so parse it whole first*/
+	CCBIPlistParser parser;
+	CCBIPlistDocument document;
+	if (!document.parse((const char*)file.getBytes(), file.getLength(), parser))
+	{
+		char offset[32];
+		sprintf(offset, " at byte %lu", (unsigned long)parser.getErrorOffset());
+		error = parser.getError() + offset;
+		return false;
+	}
+
+	CCBITree tree;
+	CCBIPublisher publisher(document, tree);
+	publisher.setMaxDepth(options.maxDepth);
+	if (!publisher.build())
+	{
+		error = publisher.getError();
+		return false;
+	}
+
+	CCBIWriter writer;
+	if (!writer.writeTree(tree))
+	{
+		error = writer.getError();
+		return false;
+	}
+
+	std::string temp = std::string(pOutCCBIFile) + ".tmp";
+	if (!replaceCCBIOutput(temp, pOutCCBIFile, writer.flushTo(temp.c_str())))
+	{
+		error = "can not write the output file";
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,16 @@
+#ifndef _CCBII_PUBLISH_H_
+#define _CCBII_PUBLISH_H_
+
+#include <string>
+
+#include "convert.h"
+
+/**
+* @brief Publish one ccb plist (xml) into a version 5 ccbi file
+* @param error set to a short reason when publishing fails
+* @param options only maxDepth applies, to the node graph of the ccb
+*/
+bool publishCCBFile(const char *pCCBFile, const char *pOutCCBIFile, std::string &error,
+	const CCBIConvertOptions &options = CCBIConvertOptions());
+
+#endif
@@ -0,0 +1,438 @@
+#include "select.h"
+#include "../ccbanalyzer/CBIReader.h"
+#include "../ccbanalyzer/CBIXMLEmitter.h"
+#include "../ccbanalyzer/CBIJSONEmitter.h"
+#include "../ccbanalyzer/CBIMappedFile.h"
+#include "../util/file/ssFile.h"
+#include "../util/hash/ssHash.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <vector>
+
+using namespace std;
+
+static const char kSequencesQuery[] = "sequences";
+
+/*offsets of the matched nodes of each query*/
+typedef map<string, vector<unsigned long long> > CCBISelectIndex;
+
+/**
+* @brief One level of a node path
+*/
+struct CCBIPathSegment
+{
+	/*empty for any*/
+	string className;
+	string memberName;
+	/*a single name, which the class or the member variable name may match*/
+	bool eitherName;
+	/*-1 for any child of the parent*/
+	int child;
+};
+
+static bool parseNodePath(const string &query, vector<CCBIPathSegment> &path)
+{
+	size_t start = 0;
+	while (start <= query.size())
+	{
+		size_t end = query.find('/', start);
+		end = string::npos == end ? query.size() : end;
+		string text = query.substr(start, end - start);
+		start = end + 1;
+
+		CCBIPathSegment segment;
+		segment.eitherName = true;
+		segment.child = -1;
+
+		size_t bracket = text.find('[');
+		if (string::npos != bracket)
+		{
+			char *pEnd = NULL;
+			const char *pIndex = text.c_str() + bracket + 1;
+			long child = strtol(pIndex, &pEnd, 10);
+			if (pEnd == pIndex || child < 0 || ']' != *pEnd || pEnd + 1 != text.c_str() + text.size())
+			{
+				return false;
+			}
+			segment.child = (int)child;
+			text.erase(bracket);
+		}
+
+		size_t paren = text.find('(');
+		if (string::npos != paren)
+		{
+			if (text.size() < paren + 3 || ')' != text[text.size() - 1])
+			{
+				return false;
+			}
+			segment.memberName = text.substr(paren + 1, text.size() - paren - 2);
+			segment.eitherName = false;
+			text.erase(paren);
+		}
+		else if (text.empty())
+		{
+			return false;
+		}
+
+		segment.className = "*" == text ? "" : text;
+		path.push_back(segment);
+	}
+
+	return true;
+}
+
+static bool isCachedString(const CCBITree &tree, int index, const string &name)
+{
+	if (index < 0)
+	{
+		return false;
+	}
+	CCBIStringView view = tree.getString(index);
+	return view.length == name.size() && 0 == memcmp(view.pChars, name.data(), view.length);
+}
+
+static bool matchesSegment(const CCBITree &tree, const CCBINode &node, int child, const CCBIPathSegment &segment)
+{
+	if (segment.child >= 0 && segment.child != child)
+	{
+		return false;
+	}
+	if (segment.className.empty())
+	{
+		return segment.memberName.empty() || isCachedString(tree, node.memberVarAssignmentNameIndex, segment.memberName);
+	}
+	if (segment.eitherName)
+	{
+		return isCachedString(tree, node.classNameIndex, segment.className)
+			|| isCachedString(tree, node.memberVarAssignmentNameIndex, segment.className);
+	}
+	return isCachedString(tree, node.classNameIndex, segment.className)
+		&& isCachedString(tree, node.memberVarAssignmentNameIndex, segment.memberName);
+}
+
+/*an open node of depth d with children[d] children read may still have a match below it*/
+static bool mayMatchMore(const vector<int> &children, const vector<CCBIPathSegment> &path)
+{
+	for (size_t d = 0; d < children.size(); d++)
+	{
+		const CCBIPathSegment &segment = path[d + 1];
+		if (segment.child < 0 || children[d] <= segment.child)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/*write the subtree of the node of the given depth, whose kCCBINodeStart was just read*/
+template <typename Emitter>
+static bool writeSubtree(CCBIReader &ccbir, Emitter &emitter, int depth, string &error)
+{
+	emitter.writeNodeStart(depth);
+
+	int index;
+	for (;;)
+	{
+		int event = ccbir.readNodeEvent(index);
+		if (kCCBINodeStart == event)
+		{
+			emitter.writeNodeStart(index);
+		}
+		else if (kCCBINodeEnd == event)
+		{
+			emitter.writeNodeEnd(index);
+			if (depth == index)
+			{
+				return true;
+			}
+		}
+		else
+		{
+			error = ccbir.describeError();
+			return false;
+		}
+	}
+}
+
+/*walk the node graph down the path, write the matches and note their offsets*/
+template <typename Emitter>
+static bool writeMatchedNodes(CCBIReader &ccbir, Emitter &emitter, const vector<CCBIPathSegment> &path,
+	vector<unsigned long long> &offsets, string &error)
+{
+	const CCBITree &tree = ccbir.getTree();
+
+	/*children read so far of each open node; the open nodes are on the path*/
+	vector<int> children;
+
+	int index;
+	for (;;)
+	{
+		unsigned long long offset = ccbir.getPosition();
+		int event = ccbir.readNodeEvent(index);
+		if (kCCBINodeGraphEnd == event)
+		{
+			return true;
+		}
+		if (kCCBINodeGraphError == event)
+		{
+			error = ccbir.describeError();
+			return false;
+		}
+		if (kCCBINodeEnd == event)
+		{
+			children.pop_back();
+			continue;
+		}
+
+		/*index is the depth of the node*/
+		int child = 0 == index ? 0 : children.back()++;
+		if (!matchesSegment(tree, tree.nodes[index], child, path[index]))
+		{
+			if (!mayMatchMore(children, path))
+			{
+				return true;
+			}
+			/*its end is the next event, which drops it again*/
+			if (!ccbir.skipNodeSubtree())
+			{
+				error = ccbir.describeError();
+				return false;
+			}
+			children.push_back(0);
+		}
+		else if (index + 1 < (int)path.size())
+		{
+			children.push_back(0);
+		}
+		else
+		{
+			offsets.push_back(offset);
+			if (!writeSubtree(ccbir, emitter, index, error))
+			{
+				return false;
+			}
+			if (!mayMatchMore(children, path))
+			{
+				return true;
+			}
+		}
+	}
+}
+
+/*write the subtrees at the offsets an earlier walk matched*/
+template <typename Emitter>
+static bool writeIndexedNodes(CCBIReader &ccbir, Emitter &emitter, const vector<unsigned long long> &offsets,
+	string &error)
+{
+	for (size_t i = 0; i < offsets.size(); i++)
+	{
+		int index;
+		if (!ccbir.seekNode(offsets[i]) || kCCBINodeStart != ccbir.readNodeEvent(index))
+		{
+			error = "the index does not match the file";
+			return false;
+		}
+		if (!writeSubtree(ccbir, emitter, index, error))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/*pPath is NULL for the sequences; pIndexed, if set, are the matches of the path*/
+template <typename Emitter>
+static bool writeSelection(CCBIReader &ccbir, CCBIPlistWriter &writer, const vector<CCBIPathSegment> *pPath,
+	const vector<unsigned long long> *pIndexed, vector<unsigned long long> &offsets, string &error)
+{
+	Emitter emitter(ccbir.getTree(), writer);
+	emitter.emitSelectionStart();
+
+	if (NULL == pPath)
+	{
+		emitter.writeSequences();
+	}
+	else
+	{
+		emitter.writeSelectedNodesStart();
+		bool ok = NULL != pIndexed
+			? writeIndexedNodes(ccbir, emitter, *pIndexed, error)
+			: writeMatchedNodes(ccbir, emitter, *pPath, offsets, error);
+		if (!ok)
+		{
+			return false;
+		}
+		emitter.writeSelectedNodesEnd();
+	}
+
+	emitter.emitEnd();
+	return true;
+}
+
+static bool selectInto(const CCBIMappedFile &file, const CCBISelectOptions &options, const vector<CCBIPathSegment> *pPath,
+	const vector<unsigned long long> *pIndexed, CCBIPlistWriter &writer, vector<unsigned long long> &offsets,
+	string &error)
+{
+	CCBIReader ccbir(file.getBytes(), file.getLength());
+	ccbir.setMaxDepth(options.convert.maxDepth);
+
+	/*everything before the node graph is needed to decode any node of it*/
+	if (!ccbir.readHeader() || !ccbir.readStringCache() || !ccbir.readSequences())
+	{
+		error = ccbir.describeError();
+		return false;
+	}
+
+	if (kCCBIFormatJSON == options.convert.format)
+	{
+		return writeSelection<CCBIJSONEmitter>(ccbir, writer, pPath, pIndexed, offsets, error);
+	}
+	return writeSelection<CCBIXMLEmitter>(ccbir, writer, pPath, pIndexed, offsets, error);
+}
+
+/*the index holds the size and a hash of the bytes of the file it was made
+from on its first line; a size and mtime would miss a rewrite within a second*/
+static string getIndexStamp(const CCBIMappedFile &file)
+{
+	char stamp[96];
+	sprintf(stamp, "ccbi2ccb select index 2 %llu %016llx", (unsigned long long)file.getLength(),
+		SSHash64(file.getBytes(), file.getLength()));
+	return stamp;
+}
+
+static void loadSelectIndex(const string &path, const string &stamp, CCBISelectIndex &index)
+{
+	vector<string> lines;
+	if (!SSReadLines(path, lines) || lines.empty() || stamp != lines[0])
+	{
+		return;
+	}
+
+	/*a line per query: the query, a tab and the offsets*/
+	for (size_t i = 1; i < lines.size(); i++)
+	{
+		size_t tab = lines[i].find('\t');
+		if (string::npos == tab)
+		{
+			continue;
+		}
+
+		vector<unsigned long long> &offsets = index[lines[i].substr(0, tab)];
+		const char *pAt = lines[i].c_str() + tab + 1;
+		for (;;)
+		{
+			char *pEnd = NULL;
+			unsigned long long offset = strtoull(pAt, &pEnd, 10);
+			if (pEnd == pAt)
+			{
+				break;
+			}
+			offsets.push_back(offset);
+			pAt = pEnd;
+		}
+	}
+}
+
+static bool saveSelectIndex(const string &path, const string &stamp, const CCBISelectIndex &index)
+{
+	/*written aside and moved over, a reader never sees half of it*/
+	string temp = path + ".tmp";
+	FILE *pFile = fopen(temp.c_str(), "w");
+	if (NULL == pFile)
+	{
+		return false;
+	}
+
+	fprintf(pFile, "%s\n", stamp.c_str());
+	for (CCBISelectIndex::const_iterator it = index.begin(); it != index.end(); ++it)
+	{
+		fprintf(pFile, "%s\t", it->first.c_str());
+		for (size_t i = 0; i < it->second.size(); i++)
+		{
+			fprintf(pFile, 0 == i ? "%llu" : " %llu", it->second[i]);
+		}
+		fputc('\n', pFile);
+	}
+
+	bool ok = 0 == ferror(pFile);
+	ok = 0 == fclose(pFile) && ok && SSReplaceFile(temp, path);
+	if (!ok)
+	{
+		SSRemoveFile(temp);
+	}
+	return ok;
+}
+
+bool selectCCBIFile(const char *pCCBIFile, FILE *pOutput, string &error, const CCBISelectOptions &options)
+{
+	if (kCCBIFormatBinary == options.convert.format)
+	{
+		error = "only the xml and json formats can be selected";
+		return false;
+	}
+
+	bool sequences = kSequencesQuery == options.query;
+	vector<CCBIPathSegment> path;
+	if (!sequences && !parseNodePath(options.query, path))
+	{
+		error = "bad node path '" + options.query + "'";
+		return false;
+	}
+	const vector<CCBIPathSegment> *pPath = sequences ? NULL : &path;
+
+	/*the bytes hashed for the index are the ones decoded*/
+	CCBIMappedFile file;
+	if (!file.open(pCCBIFile))
+	{
+		error = "can not read the input file";
+		return false;
+	}
+
+	/*the sequences come before the node graph, only node paths are indexed*/
+	string indexPath = string(pCCBIFile) + ".idx";
+	string stamp;
+	CCBISelectIndex index;
+	bool useIndex = options.useIndex && !sequences;
+	if (useIndex)
+	{
+		stamp = getIndexStamp(file);
+		loadSelectIndex(indexPath, stamp, index);
+	}
+
+	CCBISelectIndex::const_iterator hit = useIndex ? index.find(options.query) : index.end();
+	bool indexed = hit != index.end();
+
+	CCBIPlistWriter writer;
+	vector<unsigned long long> offsets;
+	bool ok = selectInto(file, options, pPath, indexed ? &hit->second : NULL, writer, offsets, error);
+	if (!ok && indexed)
+	{
+		/*a damaged index, walk the file again*/
+		writer.clear();
+		error.clear();
+		indexed = false;
+		ok = selectInto(file, options, pPath, NULL, writer, offsets, error);
+	}
+	if (!ok)
+	{
+		return false;
+	}
+
+	/*a failed save only costs the next query a walk*/
+	if (useIndex && !indexed)
+	{
+		index[options.query] = offsets;
+		saveSelectIndex(indexPath, stamp, index);
+	}
+
+	if (!writer.drainTo(pOutput) || 0 != fflush(pOutput))
+	{
+		error = "can not write the output";
+		return false;
+	}
+
+	return true;
+}
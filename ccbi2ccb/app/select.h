@@ -0,0 +1,42 @@
+#ifndef _CCBII_SELECT_H_
+#define _CCBII_SELECT_H_
+
+#include <stdio.h>
+
+#include <string>
+
+#include "convert.h"
+
+/**
+* @brief What selectCCBIFile() writes of a ccbi
+*/
+struct CCBISelectOptions
+{
+	/*"sequences", or a node path*/
+	std::string query;
+	/*keep the offsets of the matched nodes in <in.ccbi>.idx for the next queries*/
+	bool useIndex;
+	/*the xml or json format, and the depth limit*/
+	CCBIConvertOptions convert;
+
+	CCBISelectOptions() : useIndex(false) {}
+};
+
+/**
+* @brief Write only part of a ccbi, as an xml plist or json dict
+*
+* The query "sequences" writes the sequences. Any other query is a node
+* path from the root down, like CCLayer/panel/CCSprite[3]: each node is
+* named by its class or member variable name, both as Class(member), or
+* * for any, and [n] keeps only child n of its parent. The matched nodes
+* are written with their subtrees into a "nodes" array. The other
+* subtrees are decoded without being kept or written, and decoding stops
+* once no further node can match.
+*
+* With useIndex, a repeat query of an unchanged file decodes only the
+* subtrees it matched before.
+*/
+bool selectCCBIFile(const char *pCCBIFile, FILE *pOutput, std::string &error,
+	const CCBISelectOptions &options);
+
+#endif
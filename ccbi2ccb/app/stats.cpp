@@ -0,0 +1,177 @@
+#include "stats.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace std;
+
+static const char *kCCBIPhaseNames[kCCBIPhaseMAX] =
+{
+	"readHeader", "readStringCache", "readSequences", "readNodeGraph", "emit", "flush"
+};
+
+/*************************************************************************
+Implementation of CCBIStats
+*************************************************************************/
+CCBIStats::CCBIStats()
+: numFiles(0)
+, inputBytes(0)
+, numStrings(0)
+, stringBytes(0)
+, numSequences(0)
+, numNodes(0)
+, maxDepth(0)
+, outputBytes(0)
+{
+	for (int i = 0; i < kCCBIPhaseMAX; i++)
+	{
+		phaseSeconds[i] = 0;
+	}
+	for (int i = 0; i < kCCBIPropTypeMAX; i++)
+	{
+		numProperties[i] = 0;
+		numKeyframes[i] = 0;
+	}
+}
+
+void CCBIStats::add(const CCBIStats &stats)
+{
+	numFiles += stats.numFiles;
+	for (int i = 0; i < kCCBIPhaseMAX; i++)
+	{
+		phaseSeconds[i] += stats.phaseSeconds[i];
+	}
+
+	inputBytes += stats.inputBytes;
+	numStrings += stats.numStrings;
+	stringBytes += stats.stringBytes;
+	numSequences += stats.numSequences;
+	numNodes += stats.numNodes;
+	maxDepth = maxDepth > stats.maxDepth ? maxDepth : stats.maxDepth;
+	for (int i = 0; i < kCCBIPropTypeMAX; i++)
+	{
+		numProperties[i] += stats.numProperties[i];
+		numKeyframes[i] += stats.numKeyframes[i];
+	}
+	outputBytes += stats.outputBytes;
+}
+
+void countCCBITree(const CCBITree &tree, CCBIStats &stats)
+{
+	stats.numStrings = tree.strings.size();
+	stats.stringBytes = 0;
+	for (int i = 0; i < tree.strings.size(); i++)
+	{
+		stats.stringBytes += tree.strings[i].length;
+	}
+	stats.numSequences = tree.sequences.size();
+	stats.numNodes = tree.nodes.size();
+
+	/*the ancestors of node i whose subtree it is in, the root at the bottom*/
+	vector<int> open;
+	stats.maxDepth = 0;
+	for (int i = 0; i < tree.nodes.size(); i++)
+	{
+		while (!open.empty() && i >= tree.nodes[open.back()].subtreeEnd)
+		{
+			open.pop_back();
+		}
+		open.push_back(i);
+		stats.maxDepth = stats.maxDepth > (int)open.size() ? stats.maxDepth : (int)open.size();
+	}
+
+	for (int i = 0; i < tree.properties.size(); i++)
+	{
+		int type = tree.properties[i].type;
+		if (type >= 0 && type < kCCBIPropTypeMAX)
+		{
+			stats.numProperties[type]++;
+		}
+	}
+	for (int i = 0; i < tree.animatedProperties.size(); i++)
+	{
+		const CCBIAnimatedProperty &animatedProp = tree.animatedProperties[i];
+		if (animatedProp.type >= 0 && animatedProp.type < kCCBIPropTypeMAX)
+		{
+			stats.numKeyframes[animatedProp.type] += animatedProp.numKeyframes;
+		}
+	}
+}
+
+/*paths may hold backslashes and quotes, the rest is plain ascii*/
+static string jsonString(const string &text)
+{
+	string quoted = "\"";
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		if ('"' == text[i] || '\\' == text[i])
+		{
+			quoted += '\\';
+		}
+		quoted += text[i];
+	}
+	return quoted + "\"";
+}
+
+/*"Type": count for every type with a count, as an object*/
+static void writeTypeCounts(FILE *pFile, const unsigned long long *pCounts)
+{
+	fprintf(pFile, "{");
+	const char *pSeparator = "";
+	for (int i = 0; i < kCCBIPropTypeMAX; i++)
+	{
+		if (0 != pCounts[i])
+		{
+			fprintf(pFile, "%s\"%s\": %llu", pSeparator, CCBIMainPropTypeName::getPropTypeName(i), pCounts[i]);
+			pSeparator = ", ";
+		}
+	}
+	fprintf(pFile, "}");
+}
+
+static void writeStats(FILE *pFile, const CCBIStats &stats)
+{
+	fprintf(pFile, "\"phases\": {");
+	for (int i = 0; i < kCCBIPhaseMAX; i++)
+	{
+		fprintf(pFile, "%s\"%s\": %.3f", 0 == i ? "" : ", ", kCCBIPhaseNames[i], stats.phaseSeconds[i] * 1000);
+	}
+	fprintf(pFile, "}, \"inputBytes\": %llu, \"strings\": %llu, \"stringBytes\": %llu, \"sequences\": %llu",
+		stats.inputBytes, stats.numStrings, stats.stringBytes, stats.numSequences);
+	fprintf(pFile, ", \"nodes\": %llu, \"maxDepth\": %d, \"properties\": ", stats.numNodes, stats.maxDepth);
+	writeTypeCounts(pFile, stats.numProperties);
+	fprintf(pFile, ", \"keyframes\": ");
+	writeTypeCounts(pFile, stats.numKeyframes);
+	fprintf(pFile, ", \"outputBytes\": %llu", stats.outputBytes);
+}
+
+bool writeCCBIStats(const char *pPath, const vector<CCBIStatsRecord> &records)
+{
+	FILE *pFile = fopen(pPath, "w");
+	if (NULL == pFile)
+	{
+		return false;
+	}
+
+	CCBIStats total;
+	fprintf(pFile, "{\n\t\"version\": 1,\n\t\"files\": [\n");
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		const CCBIStatsRecord &record = records[i];
+		fprintf(pFile, "\t\t{ \"file\": %s, \"ok\": %s, \"cached\": %s", jsonString(record.input).c_str(),
+			record.ok ? "true" : "false", record.cached ? "true" : "false");
+		if (record.ok && !record.cached)
+		{
+			fprintf(pFile, ", ");
+			writeStats(pFile, record.stats);
+			total.add(record.stats);
+		}
+		fprintf(pFile, " }%s\n", i + 1 < records.size() ? "," : "");
+	}
+
+	fprintf(pFile, "\t],\n\t\"total\": { \"files\": %d, ", total.numFiles);
+	writeStats(pFile, total);
+	fprintf(pFile, " }\n}\n");
+
+	return 0 == fclose(pFile);
+}
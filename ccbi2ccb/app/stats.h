@@ -0,0 +1,79 @@
+#ifndef _CCBII_STATS_H_
+#define _CCBII_STATS_H_
+
+#include <string>
+#include <vector>
+
+#include "../ccbanalyzer/CBIReader.h"
+#include "../ccbanalyzer/CBITree.h"
+
+/*timed phases of a conversion, named in the json as in kCCBIPhaseNames*/
+enum {
+	kCCBIPhaseReadHeader = 0,
+	kCCBIPhaseReadStringCache,
+	kCCBIPhaseReadSequences,
+	kCCBIPhaseReadNodeGraph,
+	kCCBIPhaseEmit,
+	kCCBIPhaseFlush,
+	kCCBIPhaseMAX
+};
+
+/**
+* @brief Where the time of a conversion goes, and what the file is made of
+*
+* Filled by convertCCBIFile() when it is given one; a batch adds up the
+* stats of its files. The counters are taken from the decoded tree after
+* the fact, so decoding itself is not slowed down.
+*/
+struct CCBIStats
+{
+	/*files converted, 1 for a single file*/
+	int numFiles;
+	double phaseSeconds[kCCBIPhaseMAX];
+
+	unsigned long long inputBytes;
+	unsigned long long numStrings;
+	unsigned long long stringBytes;
+	unsigned long long numSequences;
+	unsigned long long numNodes;
+	/*levels of the deepest node graph, 1 for a root alone*/
+	int maxDepth;
+	/*by kCCBIPropType*, keyframes by the type of their animated property*/
+	unsigned long long numProperties[kCCBIPropTypeMAX];
+	unsigned long long numKeyframes[kCCBIPropTypeMAX];
+	unsigned long long outputBytes;
+
+	CCBIStats();
+
+	void add(const CCBIStats &stats);
+};
+
+/**
+* @brief Count the strings, sequences, nodes, depth, properties and keyframes of a tree
+*/
+void countCCBITree(const CCBITree &tree, CCBIStats &stats);
+
+/**
+* @brief The stats of one file of a run, or why it has none
+*/
+struct CCBIStatsRecord
+{
+	std::string input;
+	bool ok;
+	/*the output came from the cache, nothing was measured*/
+	bool cached;
+	CCBIStats stats;
+
+	CCBIStatsRecord() : ok(false), cached(false) {}
+};
+
+/**
+* @brief Write the records, one per line, and their total as a json document
+*
+* {"version": 1, "files": [{"file": ..., "ok": ..., "cached": ..., ...}, ...],
+*  "total": {...}}; times are in milliseconds and the total only adds up
+* the files that were converted.
+*/
+bool writeCCBIStats(const char *pPath, const std::vector<CCBIStatsRecord> &records);
+
+#endif
@@ -0,0 +1,204 @@
+#include "watch.h"
+#include "convert.h"
+#include "../ccbanalyzer/CBIReader.h"
+#include "../util/file/ssDirWatcher.h"
+#include "../util/file/ssFile.h"
+#include "../util/thread/ssWorkerPool.h"
+
+#include <stdio.h>
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+using namespace std;
+
+typedef chrono::steady_clock WatchClock;
+
+/**
+* @brief What the watch loop and the workers share
+*/
+struct CCBIWatchState
+{
+	const CCBIWatchOptions *pOptions;
+	mutex lock;
+	/*files being converted*/
+	set<string> running;
+	/*running files written again meanwhile, and the ones of them done since*/
+	set<string> dirty;
+	vector<string> again;
+	/*buffers of finished conversions, taken by the next ones*/
+	vector<CCBIConvertBuffers*> idle;
+
+	CCBIWatchState() : pOptions(NULL) {}
+	~CCBIWatchState()
+	{
+		for (size_t i = 0; i < idle.size(); i++)
+		{
+			delete idle[i];
+		}
+	}
+};
+
+static bool isWatchedFile(const string &path)
+{
+	return CCBIReader::endsWith(CCBIReader::toLowerCase(path.c_str()).c_str(), ".ccbi");
+}
+
+/*the output keeps the path of the input below the watched directory*/
+static string getOutputPath(const string &input, const CCBIWatchOptions &options)
+{
+	string relative = input;
+	if (0 == input.compare(0, options.dir.size(), options.dir))
+	{
+		relative = input.substr(options.dir.size());
+		while (!relative.empty() && ('/' == relative[0] || '\\' == relative[0]))
+		{
+			relative.erase(0, 1);
+		}
+	}
+
+	relative = CCBIReader::deletePathExtension(relative.c_str()) + getCCBIOutputExtension(options.convert);
+	return SSJoinPath(options.outDir.empty() ? options.dir : options.outDir, relative);
+}
+
+static void convertChanged(CCBIWatchState *pState, const string &input)
+{
+	const CCBIWatchOptions &options = *pState->pOptions;
+
+	CCBIConvertBuffers *pBuffers = NULL;
+	{
+		lock_guard<mutex> lock(pState->lock);
+		if (!pState->idle.empty())
+		{
+			pBuffers = pState->idle.back();
+			pState->idle.pop_back();
+		}
+	}
+	if (NULL == pBuffers)
+	{
+		pBuffers = new CCBIConvertBuffers();
+	}
+
+	WatchClock::time_point start = WatchClock::now();
+	string output = getOutputPath(input, options);
+	string error;
+	bool ok = false;
+	if (!SSMakeDirectories(SSDirName(output)))
+	{
+		error = "can not create the output directory";
+	}
+	else
+	{
+		ok = convertCCBIFileReusing(input.c_str(), output.c_str(), error, options.convert, *pBuffers);
+	}
+	double ms = chrono::duration_cast<chrono::duration<double, milli> >(WatchClock::now() - start).count();
+
+	lock_guard<mutex> lock(pState->lock);
+	pState->idle.push_back(pBuffers);
+	pState->running.erase(input);
+	if (0 != pState->dirty.erase(input))
+	{
+		pState->again.push_back(input);
+	}
+
+	if (ok)
+	{
+		printf("ok    %s -> %s (%.1f ms)\n", input.c_str(), output.c_str(), ms);
+	}
+	else
+	{
+		printf("FAIL  %s: %s\n", input.c_str(), error.c_str());
+	}
+	fflush(stdout);
+}
+
+bool runWatch(const CCBIWatchOptions &options)
+{
+	SSDirWatcher watcher;
+	if (!watcher.open(options.dir))
+	{
+		printf("%s: can not watch the directory\n", options.dir.c_str());
+		return false;
+	}
+
+	printf("watching %s\n", options.dir.c_str());
+	fflush(stdout);
+
+	/*the pool is declared after the state, so its workers are joined before the state goes*/
+	CCBIWatchState state;
+	state.pOptions = &options;
+	SSWorkerPool pool(options.numThreads);
+
+	/*changed files and their last write, converted once that is debounceMs ago*/
+	map<string, WatchClock::time_point> pending;
+	chrono::milliseconds debounce(options.debounceMs);
+
+	for (;;)
+	{
+		WatchClock::time_point now = WatchClock::now();
+
+		/*sleep until the next file settles, or wake for the reruns of the running ones*/
+		int timeoutMs = -1;
+		for (map<string, WatchClock::time_point>::const_iterator it = pending.begin(); it != pending.end(); ++it)
+		{
+			int left = (int)chrono::duration_cast<chrono::milliseconds>(it->second + debounce - now).count();
+			left = left < 0 ? 0 : left;
+			timeoutMs = timeoutMs < 0 || left < timeoutMs ? left : timeoutMs;
+		}
+		{
+			lock_guard<mutex> lock(state.lock);
+			if (!state.dirty.empty() && (timeoutMs < 0 || timeoutMs > options.debounceMs))
+			{
+				timeoutMs = options.debounceMs;
+			}
+		}
+
+		vector<string> files;
+		if (!watcher.wait(timeoutMs, files))
+		{
+			printf("%s: the watch broke\n", options.dir.c_str());
+			return false;
+		}
+
+		now = WatchClock::now();
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			if (isWatchedFile(files[i]))
+			{
+				pending[files[i]] = now;
+			}
+		}
+
+		lock_guard<mutex> lock(state.lock);
+		for (size_t i = 0; i < state.again.size(); i++)
+		{
+			pending.insert(make_pair(state.again[i], now));
+		}
+		state.again.clear();
+
+		for (map<string, WatchClock::time_point>::iterator it = pending.begin(); it != pending.end();)
+		{
+			if (now - it->second < debounce)
+			{
+				++it;
+				continue;
+			}
+
+			/*a file converted now is converted again once that is done*/
+			if (state.running.count(it->first))
+			{
+				state.dirty.insert(it->first);
+			}
+			else
+			{
+				state.running.insert(it->first);
+				pool.submit(bind(convertChanged, &state, it->first));
+			}
+			pending.erase(it++);
+		}
+	}
+}
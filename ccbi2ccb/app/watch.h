@@ -0,0 +1,38 @@
+#ifndef _CCBII_WATCH_H_
+#define _CCBII_WATCH_H_
+
+#include <string>
+
+#include "convert.h"
+
+/**
+* @brief Options of a watch run
+*/
+struct CCBIWatchOptions
+{
+	/*watched with every directory below it*/
+	std::string dir;
+	/*output root, empty to write each ccb next to its ccbi*/
+	std::string outDir;
+	/*worker threads converting the changed files*/
+	int numThreads;
+	/*a file is converted once no write to it came for this long*/
+	int debounceMs;
+	/*applied to every file*/
+	CCBIConvertOptions convert;
+
+	CCBIWatchOptions() : numThreads(2), debounceMs(300) {}
+};
+
+/**
+* @brief Convert every .ccbi written below options.dir from now on, until
+* the watch breaks
+*
+* Bursts of writes to a file are converted once, after they settle; a file
+* written again while it is converted is converted again after. Each
+* worker keeps its buffers warm from file to file. Prints a line per file.
+* @return false if the directory can not be watched or the watch breaks
+*/
+bool runWatch(const CCBIWatchOptions &options);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef _CCBII_BENCH_H_
+#define _CCBII_BENCH_H_
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/*each benchmark gets its own name as argv[0] and the files after it*/
+int benchReadInt(int argc, char *argv[]);
+int benchReal(int argc, char *argv[]);
+int benchDecode(int argc, char *argv[]);
+int benchConvert(int argc, char *argv[]);
+
+/**
+* @brief Record one measurement for the --json report and --baseline check
+*
+* Times ("ns", "ms") are better lower, rates ("MB/s", "files/s") and
+* ratios ("x") better higher.
+*/
+void addBenchResult(const char *pBench, const std::string &name, double value, const char *pUnit);
+
+/*the last path component of a sample, to name its results*/
+std::string getBenchFileName(const char *pPath);
+
+/**
+* @brief The files named on the command line, or the sample files
+*/
+void getBenchFiles(int argc, char *argv[], std::vector<const char*> &files);
+
+inline double elapsedNs(std::chrono::high_resolution_clock::time_point start)
+{
+	return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+#endif
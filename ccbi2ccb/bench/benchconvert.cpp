@@ -0,0 +1,193 @@
+/*
+* End-to-end throughput over the sample files: decoding into a CCBITree,
+* writing the xml, the binary plist and the json from it in memory, and the whole
+* convertCCBIFile() run with its file read and write.
+*
+* Rates are of input (ccbi) bytes, in MB/s, and of files per second; the
+* totals are over every file, each converted as often as the others.
+*
+* usage: ccbibench convert [file.ccbi ...]
+*/
+#include "bench.h"
+#include "../app/convert.h"
+#include "../ccbanalyzer/CBIReader.h"
+#include "../ccbanalyzer/CBIXMLEmitter.h"
+#include "../ccbanalyzer/CBIBinaryPlistEmitter.h"
+#include "../ccbanalyzer/CBIJSONEmitter.h"
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*each stage of each file runs at least this long*/
+static const double kMinNs = 200e6;
+
+static const char *kOutFile = "ccbibench.tmp.ccb";
+
+static volatile size_t gSink;
+
+static bool decode(CCBIReader &reader)
+{
+	return NULL != reader.getBytes() && reader.readHeader() && reader.readStringCache()
+		&& reader.readSequences() && reader.readNodeGraph();
+}
+
+/*one run of a stage on pFile, false if it fails*/
+typedef bool (*Stage)(const char *pFile);
+
+static bool decodeStage(const char *pFile)
+{
+	CCBIReader reader(pFile);
+	return decode(reader);
+}
+
+static bool xmlStage(const char *pFile)
+{
+	CCBIReader reader(pFile);
+	if (!decode(reader)) {
+		return false;
+	}
+
+	CCBIPlistWriter writer;
+	writer.reserve(reader.getLength() * CCBIXMLEmitter::kOutputSizeRatio);
+	CCBIXMLEmitter emitter(reader.getTree(), writer);
+	emitter.emit();
+	gSink = writer.getSize();
+	return true;
+}
+
+static bool bplistStage(const char *pFile)
+{
+	CCBIReader reader(pFile);
+	if (!decode(reader)) {
+		return false;
+	}
+
+	CCBIBinaryPlistWriter plist;
+	CCBIBinaryPlistEmitter emitter(reader.getTree(), plist);
+	emitter.emit();
+
+	CCBIPlistWriter writer;
+	plist.serialize(writer);
+	gSink = writer.getSize();
+	return true;
+}
+
+static bool jsonStage(const char *pFile)
+{
+	CCBIReader reader(pFile);
+	if (!decode(reader)) {
+		return false;
+	}
+
+	CCBIPlistWriter writer;
+	writer.reserve(reader.getLength() * CCBIJSONEmitter::kOutputSizeRatio);
+	CCBIJSONEmitter emitter(reader.getTree(), writer);
+	emitter.emit();
+	gSink = writer.getSize();
+	return true;
+}
+
+static bool convertStage(const char *pFile)
+{
+	string error;
+	return convertCCBIFile(pFile, kOutFile, error);
+}
+
+struct StageEntry
+{
+	const char *pName;
+	Stage run;
+};
+
+static const StageEntry kStages[] =
+{
+	{ "decode", decodeStage },
+	{ "xml", xmlStage },
+	{ "bplist", bplistStage },
+	{ "json", jsonStage },
+	{ "convert", convertStage },
+};
+static const int kNumStages = sizeof(kStages) / sizeof(kStages[0]);
+
+/*ns per run of stage on pFile, negative if it fails*/
+static double timeStage(Stage stage, const char *pFile)
+{
+	if (!stage(pFile)) {
+		return -1;
+	}
+
+	int runs = 0;
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	double ns = 0;
+	do {
+		stage(pFile);
+		runs++;
+		ns = elapsedNs(start);
+	} while (ns < kMinNs);
+
+	return ns / runs;
+}
+
+int benchConvert(int argc, char *argv[])
+{
+	vector<const char*> files;
+	getBenchFiles(argc, argv, files);
+
+	vector<double> totalNs(kNumStages, 0);
+	double totalBytes = 0;
+	int numFiles = 0;
+
+	for (size_t f = 0; f < files.size(); f++) {
+		CCBIReader probe(files[f]);
+		if (NULL == probe.getBytes()) {
+			printf("%-32s can not open\n", files[f]);
+			continue;
+		}
+		double bytes = (double)probe.getLength();
+
+		vector<double> ns(kNumStages, 0);
+		bool ok = true;
+		for (int s = 0; s < kNumStages && ok; s++) {
+			ns[s] = timeStage(kStages[s].run, files[f]);
+			ok = ns[s] >= 0;
+		}
+		if (!ok) {
+			printf("%-32s can not convert\n", files[f]);
+			continue;
+		}
+
+		string name = getBenchFileName(files[f]);
+		printf("%-32s %7u bytes", files[f], (unsigned int)bytes);
+		for (int s = 0; s < kNumStages; s++) {
+			double mbs = bytes / ns[s] * 1e9 / (1024 * 1024);
+			printf("  %s %7.1f MB/s", kStages[s].pName, mbs);
+			addBenchResult("convert", string(kStages[s].pName) + "/" + name, mbs, "MB/s");
+			totalNs[s] += ns[s];
+		}
+		printf("  %7.0f files/s\n", 1e9 / ns[kNumStages - 1]);
+		addBenchResult("convert", "convert/" + name, 1e9 / ns[kNumStages - 1], "files/s");
+
+		totalBytes += bytes;
+		numFiles++;
+	}
+	remove(kOutFile);
+
+	if (0 == numFiles) {
+		return 1;
+	}
+
+	printf("%-32s %7u bytes", "total", (unsigned int)totalBytes);
+	for (int s = 0; s < kNumStages; s++) {
+		double mbs = totalBytes / totalNs[s] * 1e9 / (1024 * 1024);
+		printf("  %s %7.1f MB/s", kStages[s].pName, mbs);
+		addBenchResult("convert", string(kStages[s].pName) + "/total", mbs, "MB/s");
+	}
+	double filesPerSecond = numFiles / totalNs[kNumStages - 1] * 1e9;
+	printf("  %7.0f files/s\n", filesPerSecond);
+	addBenchResult("convert", "convert/total", filesPerSecond, "files/s");
+
+	return 0;
+}
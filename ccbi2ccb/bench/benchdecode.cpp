@@ -0,0 +1,295 @@
+/*
+* Microbenchmarks of the CCBIReader primitives: readInt (unsigned and
+* signed), readFloat for every kCCBIFloat* encoding, readUTF8,
+* readCachedString and parseProperties for every property type.
+*
+* The inputs are synthetic, encoded with CCBIWriter so they are valid by
+* construction; the int values lean to the small counts and indices real
+* files are made of. Reported as ns per decoded value (per property for
+* parseProperties).
+*
+* usage: ccbibench decode
+*/
+#include "bench.h"
+#include "../ccbanalyzer/CBIReader.h"
+#include "../ccbanalyzer/CBIPropertyCodec.h"
+#include "../ccbanalyzer/CBIWriter.h"
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*values per input, and decoded values per case before the time is taken*/
+static const int kValuesPerInput = 4096;
+static const int kPropertiesPerInput = 512;
+static const int kMinOps = 2000000;
+
+/*keeps the decoded values, and so the decoding, alive*/
+static volatile long long gSink;
+
+static unsigned int gRandom = 12345;
+
+static unsigned int nextRandom()
+{
+	gRandom = gRandom * 1103515245u + 12345u;
+	return gRandom >> 8;
+}
+
+/*mostly small values, like the counts and string indices of a real file*/
+static int randomUnsigned()
+{
+	unsigned int r = nextRandom() % 100;
+	if (r < 70) {
+		return (int)(nextRandom() % 16);
+	}
+	if (r < 95) {
+		return (int)(nextRandom() % 1024);
+	}
+	return (int)(nextRandom() % (1 << 20));
+}
+
+static int randomSigned()
+{
+	int value = randomUnsigned();
+	return (nextRandom() & 1) ? -value : value;
+}
+
+/*a float that CCBIWriter stores with the given kCCBIFloat* type*/
+static float floatOfType(int type)
+{
+	switch (type) {
+	case kCCBIFloat0:
+		return 0;
+	case kCCBIFloat1:
+		return 1;
+	case kCCBIFloatMinus1:
+		return -1;
+	case kCCBIFloat05:
+		return 0.5f;
+	case kCCBIFloatInteger:
+		return (float)randomSigned();
+	default:
+		return (float)randomSigned() + 0.25f;
+	}
+}
+
+static string randomString()
+{
+	string text;
+	int length = 4 + (int)(nextRandom() % 29);
+	for (int i = 0; i < length; i++) {
+		text += (char)('a' + nextRandom() % 26);
+	}
+	return text;
+}
+
+/*a string cache of numStrings entries*/
+static void writeStringCache(CCBIWriter &writer, int numStrings)
+{
+	writer.writeInt(numStrings, false);
+	for (int i = 0; i < numStrings; i++) {
+		string text = randomString();
+		writer.writeUTF8(text.data(), text.size());
+	}
+}
+
+/*a value of every field of the codec*/
+static void writeValues(CCBIWriter &writer, const CCBIPropertyCodec &codec)
+{
+	static const float kFloats[] = { 0, 1, 0.5f, 3, 12.25f, -7.5f };
+
+	for (int i = 0; i < codec.numFields; i++) {
+		switch (codec.fields[i]) {
+		case kCCBIFieldFloat:
+			writer.writeFloat(kFloats[nextRandom() % (sizeof(kFloats) / sizeof(kFloats[0]))]);
+			break;
+		case kCCBIFieldUnsigned:
+		case kCCBIFieldString:
+			writer.writeInt(randomUnsigned() % 64, false);
+			break;
+		case kCCBIFieldSigned:
+			writer.writeInt(randomSigned(), true);
+			break;
+		case kCCBIFieldByte:
+			writer.writeByte((unsigned char)nextRandom());
+			break;
+		case kCCBIFieldBool:
+			writer.writeBool(0 != (nextRandom() & 1));
+			break;
+		}
+	}
+}
+
+/*the decoding under test: count values from the reader, summed into the result*/
+typedef long long (*DecodeLoop)(CCBIReader &reader, int count);
+
+static long long readUnsignedLoop(CCBIReader &reader, int count)
+{
+	long long sum = 0;
+	for (int i = 0; i < count; i++) {
+		sum += reader.readInt(false);
+	}
+	return sum;
+}
+
+static long long readSignedLoop(CCBIReader &reader, int count)
+{
+	long long sum = 0;
+	for (int i = 0; i < count; i++) {
+		sum += reader.readInt(true);
+	}
+	return sum;
+}
+
+static long long readFloatLoop(CCBIReader &reader, int count)
+{
+	long long sum = 0;
+	for (int i = 0; i < count; i++) {
+		sum += (long long)(reader.readFloat() * 4);
+	}
+	return sum;
+}
+
+static long long readUTF8Loop(CCBIReader &reader, int count)
+{
+	long long sum = 0;
+	for (int i = 0; i < count; i++) {
+		sum += reader.readUTF8().size();
+	}
+	return sum;
+}
+
+static long long readCachedStringLoop(CCBIReader &reader, int count)
+{
+	long long sum = 0;
+	for (int i = 0; i < count; i++) {
+		sum += reader.readCachedString().length;
+	}
+	return sum;
+}
+
+static long long parsePropertiesLoop(CCBIReader &reader, int)
+{
+	CCBINode node;
+	reader.parseProperties(node);
+	return node.numProperties;
+}
+
+static void report(const string &name, double ns)
+{
+	printf("%-32s %8.2f ns\n", name.c_str(), ns);
+	addBenchResult("decode", name, ns, "ns");
+}
+
+/**
+* @brief Time loop over the input and report the ns per value
+* @param stringCache the input starts with a string cache, read before the clock starts
+* @return false, with the reason printed instead of a time, if the input does not decode
+*/
+static bool timeDecode(const string &name, const CCBIWriter &input, int count, bool stringCache, DecodeLoop loop)
+{
+	int rounds = 1;
+	while (rounds * count < kMinOps) {
+		rounds *= 2;
+	}
+
+	double ns = 0;
+	long long sum = 0;
+	for (int r = 0; r < rounds; r++) {
+		CCBIReader reader(input.getBytes(), input.getLength());
+		if (stringCache) {
+			reader.readStringCache();
+		}
+
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		sum += loop(reader, count);
+		ns += elapsedNs(start);
+
+		/*a failed decode stops early and would pass for a fast one*/
+		if (reader.hasFailed()) {
+			printf("%-32s failed: %s\n", name.c_str(), reader.describeError().c_str());
+			return false;
+		}
+	}
+	gSink = sum;
+
+	report(name, ns / ((double)rounds * count));
+	return true;
+}
+
+int benchDecode(int, char *[])
+{
+	{
+		CCBIWriter input;
+		for (int i = 0; i < kValuesPerInput; i++) {
+			input.writeInt(randomUnsigned(), false);
+		}
+		if (!timeDecode("readInt/unsigned", input, kValuesPerInput, false, readUnsignedLoop)) {
+			return 1;
+		}
+	}
+	{
+		CCBIWriter input;
+		for (int i = 0; i < kValuesPerInput; i++) {
+			input.writeInt(randomSigned(), true);
+		}
+		if (!timeDecode("readInt/signed", input, kValuesPerInput, false, readSignedLoop)) {
+			return 1;
+		}
+	}
+
+	static const char *kFloatTypeNames[] = { "Float0", "Float1", "FloatMinus1", "Float05", "FloatInteger", "FloatFull" };
+	for (int type = kCCBIFloat0; type <= kCCBIFloatFull; type++) {
+		CCBIWriter input;
+		for (int i = 0; i < kValuesPerInput; i++) {
+			input.writeFloat(floatOfType(type));
+		}
+		string name = string("readFloat/") + kFloatTypeNames[type];
+		if (!timeDecode(name, input, kValuesPerInput, false, readFloatLoop)) {
+			return 1;
+		}
+	}
+
+	{
+		CCBIWriter input;
+		for (int i = 0; i < kValuesPerInput; i++) {
+			string text = randomString();
+			input.writeUTF8(text.data(), text.size());
+		}
+		if (!timeDecode("readUTF8", input, kValuesPerInput, false, readUTF8Loop)) {
+			return 1;
+		}
+	}
+	{
+		CCBIWriter input;
+		writeStringCache(input, 256);
+		for (int i = 0; i < kValuesPerInput; i++) {
+			input.writeInt((int)(nextRandom() % 256), false);
+		}
+		if (!timeDecode("readCachedString", input, kValuesPerInput, true, readCachedStringLoop)) {
+			return 1;
+		}
+	}
+
+	/*the names and string values are indices into a cache of 64 strings*/
+	for (int type = 0; type < kCCBIPropTypeMAX; type++) {
+		CCBIWriter input;
+		writeStringCache(input, 64);
+		input.writeInt(kPropertiesPerInput, false);
+		input.writeInt(0, false);
+		for (int i = 0; i < kPropertiesPerInput; i++) {
+			input.writeInt(type, false);
+			input.writeInt(randomUnsigned() % 64, false);
+			input.writeByte(kCCBIPlatformAll);
+			writeValues(input, kCCBIPropertyCodecs[type]);
+		}
+		string name = string("parseProperties/") + CCBIMainPropTypeName::getPropTypeName(type);
+		if (!timeDecode(name, input, kPropertiesPerInput, true, parsePropertiesLoop)) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
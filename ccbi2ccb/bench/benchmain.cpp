@@ -0,0 +1,252 @@
+/*
+* usage: ccbibench [--json out.json] [--baseline old.json] [--threshold percent]
+*                  [readint|real|decode|convert] [file.ccbi ...]
+*
+* Without a benchmark name every benchmark runs, on the sample files if no
+* files are given either. ccbigen writes larger inputs of any shape.
+*
+* --json writes every result to a file, one result per line, to keep
+* runs. --baseline compares the results with such a file and fails if any
+* of them is more than threshold percent (default 10) worse.
+*/
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+
+using namespace std;
+
+static const char *kDefaultSamples[] =
+{
+	"LightingAnimation.ccbi",
+	"WelcomeLogo.ccbi",
+	"../Debug/MoneyShortage.ccbi",
+	"../Debug/TigerMachine.ccbi",
+};
+
+struct BenchEntry
+{
+	const char *pName;
+	int (*run)(int argc, char *argv[]);
+};
+
+static const BenchEntry kBenches[] =
+{
+	{ "readint", benchReadInt },
+	{ "real", benchReal },
+	{ "decode", benchDecode },
+	{ "convert", benchConvert },
+};
+static const int kNumBenches = sizeof(kBenches) / sizeof(kBenches[0]);
+
+struct BenchResult
+{
+	string bench;
+	string name;
+	double value;
+	string unit;
+};
+
+static vector<BenchResult> gResults;
+
+void addBenchResult(const char *pBench, const string &name, double value, const char *pUnit)
+{
+	BenchResult result;
+	result.bench = pBench;
+	result.name = name;
+	result.value = value;
+	result.unit = pUnit;
+	gResults.push_back(result);
+}
+
+string getBenchFileName(const char *pPath)
+{
+	const char *pName = pPath;
+	for (const char *p = pPath; '\0' != *p; p++) {
+		if ('/' == *p || '\\' == *p) {
+			pName = p + 1;
+		}
+	}
+	return pName;
+}
+
+void getBenchFiles(int argc, char *argv[], vector<const char*> &files)
+{
+	for (int i = 1; i < argc; i++) {
+		files.push_back(argv[i]);
+	}
+	if (files.empty()) {
+		files.assign(kDefaultSamples, kDefaultSamples + sizeof(kDefaultSamples) / sizeof(kDefaultSamples[0]));
+	}
+}
+
+/*names and units are plain ascii, only quotes and backslashes need escaping*/
+static string jsonString(const string &text)
+{
+	string quoted = "\"";
+	for (size_t i = 0; i < text.size(); i++) {
+		if ('"' == text[i] || '\\' == text[i]) {
+			quoted += '\\';
+		}
+		quoted += text[i];
+	}
+	return quoted + "\"";
+}
+
+static bool writeJson(const char *pPath)
+{
+	FILE *pFile = fopen(pPath, "w");
+	if (NULL == pFile) {
+		return false;
+	}
+
+	fprintf(pFile, "{\n\t\"version\": 1,\n\t\"results\": [\n");
+	for (size_t i = 0; i < gResults.size(); i++) {
+		const BenchResult &result = gResults[i];
+		fprintf(pFile, "\t\t{ \"bench\": %s, \"name\": %s, \"value\": %.6g, \"unit\": %s }%s\n",
+			jsonString(result.bench).c_str(), jsonString(result.name).c_str(), result.value,
+			jsonString(result.unit).c_str(), i + 1 < gResults.size() ? "," : "");
+	}
+	fprintf(pFile, "\t]\n}\n");
+
+	return 0 == fclose(pFile);
+}
+
+/*the text of "key": "value" on a line written by writeJson*/
+static bool findJsonString(const char *pLine, const char *pKey, string &value)
+{
+	string pattern = string("\"") + pKey + "\": \"";
+	const char *p = strstr(pLine, pattern.c_str());
+	if (NULL == p) {
+		return false;
+	}
+	p += pattern.size();
+
+	value.clear();
+	for (; '\0' != *p && '"' != *p; p++) {
+		if ('\\' == *p && '\0' != p[1]) {
+			p++;
+		}
+		value += *p;
+	}
+	return '"' == *p;
+}
+
+/*results of an earlier --json run, by "bench/name"*/
+static bool readBaseline(const char *pPath, map<string, double> &baseline)
+{
+	FILE *pFile = fopen(pPath, "r");
+	if (NULL == pFile) {
+		return false;
+	}
+
+	char line[1024];
+	while (NULL != fgets(line, sizeof(line), pFile)) {
+		string bench;
+		string name;
+		const char *pValue = strstr(line, "\"value\": ");
+		if (NULL != pValue && findJsonString(line, "bench", bench) && findJsonString(line, "name", name)) {
+			baseline[bench + "/" + name] = atof(pValue + strlen("\"value\": "));
+		}
+	}
+
+	fclose(pFile);
+	return true;
+}
+
+static bool isHigherBetter(const string &unit)
+{
+	return "x" == unit || (unit.size() > 2 && 0 == unit.compare(unit.size() - 2, 2, "/s"));
+}
+
+/*@return the number of results worse than the baseline by more than threshold percent*/
+static int compareBaseline(const map<string, double> &baseline, double threshold)
+{
+	int regressions = 0;
+	int compared = 0;
+	for (size_t i = 0; i < gResults.size(); i++) {
+		const BenchResult &result = gResults[i];
+		map<string, double>::const_iterator it = baseline.find(result.bench + "/" + result.name);
+		if (it == baseline.end() || 0 == it->second || 0 == result.value) {
+			continue;
+		}
+		compared++;
+
+		/*how much worse, in percent: a slower time or a lower rate*/
+		double worse = isHigherBetter(result.unit) ? (it->second / result.value - 1) * 100
+			: (result.value / it->second - 1) * 100;
+		if (worse > threshold) {
+			printf("REGRESSION  %s/%s  %.6g -> %.6g %s  (%.1f%% worse)\n", result.bench.c_str(),
+				result.name.c_str(), it->second, result.value, result.unit.c_str(), worse);
+			regressions++;
+		}
+	}
+
+	printf("%d results compared with the baseline, %d regressed by more than %.1f%%\n",
+		compared, regressions, threshold);
+	return regressions;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *pJson = NULL;
+	const char *pBaseline = NULL;
+	double threshold = 10;
+
+	int first = 1;
+	for (; first + 1 < argc && 0 == strncmp(argv[first], "--", 2); first += 2) {
+		if (0 == strcmp(argv[first], "--json")) {
+			pJson = argv[first + 1];
+		}
+		else if (0 == strcmp(argv[first], "--baseline")) {
+			pBaseline = argv[first + 1];
+		}
+		else if (0 == strcmp(argv[first], "--threshold")) {
+			threshold = atof(argv[first + 1]);
+		}
+		else {
+			printf("unknown option %s\n", argv[first]);
+			return 2;
+		}
+	}
+	/*argv[first - 1] stands in for the program name of the benchmarks*/
+	argc -= first - 1;
+	argv += first - 1;
+
+	map<string, double> baseline;
+	if (NULL != pBaseline && !readBaseline(pBaseline, baseline)) {
+		printf("can not read %s\n", pBaseline);
+		return 2;
+	}
+
+	int result = 0;
+	bool ran = false;
+	if (argc > 1) {
+		for (int i = 0; i < kNumBenches; i++) {
+			if (0 == strcmp(argv[1], kBenches[i].pName)) {
+				result = kBenches[i].run(argc - 1, argv + 1);
+				ran = true;
+			}
+		}
+	}
+
+	if (!ran) {
+		for (int i = 0; i < kNumBenches; i++) {
+			printf("== %s\n", kBenches[i].pName);
+			result |= kBenches[i].run(argc, argv);
+		}
+	}
+
+	if (NULL != pJson && !writeJson(pJson)) {
+		printf("can not write %s\n", pJson);
+		result |= 1;
+	}
+	if (NULL != pBaseline && 0 != compareBaseline(baseline, threshold)) {
+		result |= 1;
+	}
+
+	return result;
+}
@@ -0,0 +1,166 @@
+/*
+* Microbenchmark of the ccbi int decoder: the bit-by-bit loop the reader
+* used to run against CCBIBitReader::readGamma.
+*
+* The sample files do not say where their ints start without a full parse,
+* so every byte and every 16 bit word of each file is re-encoded as an
+* Elias-gamma int; that keeps the value mix close to the real files
+* (mostly small counts and indices with a tail of larger values).
+*
+* usage: ccbibench readint [file.ccbi ...]
+*/
+#include "bench.h"
+#include "../ccbanalyzer/CBIBitReader.h"
+#include "../ccbanalyzer/CBIMappedFile.h"
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+using namespace std;
+
+/*the loop CCBIReader::readInt used before the table driven decoder*/
+static int legacyReadInt(const unsigned char *pBytes, size_t &currentByte, bool pSigned)
+{
+	int currentBit = 0;
+
+	int numBits = 0;
+	for (;;) {
+		bool bit = 0 != (pBytes[currentByte] & (1 << currentBit));
+		if (++currentBit >= 8) {
+			currentBit = 0;
+			currentByte++;
+		}
+		if (bit) {
+			break;
+		}
+		numBits++;
+	}
+
+	long long current = 0;
+	for (int a = numBits - 1; a >= 0; a--) {
+		bool bit = 0 != (pBytes[currentByte] & (1 << currentBit));
+		if (++currentBit >= 8) {
+			currentBit = 0;
+			currentByte++;
+		}
+		if (bit) {
+			current |= 1LL << a;
+		}
+	}
+	current |= 1LL << numBits;
+
+	int num;
+	if (pSigned) {
+		int s = current % 2;
+		if (s) {
+			num = (int)(current / 2);
+		}
+		else {
+			num = (int)(-current / 2);
+		}
+	}
+	else {
+		num = (int)(current - 1);
+	}
+
+	if (currentBit) {
+		currentByte++;
+	}
+
+	return num;
+}
+
+static void writeGamma(vector<unsigned char> &out, unsigned long long current)
+{
+	int numBits = 0;
+	while ((current >> (numBits + 1)) != 0) {
+		numBits++;
+	}
+
+	vector<bool> bits;
+	for (int i = 0; i < numBits; i++) {
+		bits.push_back(false);
+	}
+	bits.push_back(true);
+	for (int a = numBits - 1; a >= 0; a--) {
+		bits.push_back(0 != ((current >> a) & 1));
+	}
+
+	unsigned char byte = 0;
+	for (size_t i = 0; i < bits.size(); i++) {
+		if (bits[i]) {
+			byte |= (unsigned char)(1 << (i & 7));
+		}
+		if (7 == (i & 7)) {
+			out.push_back(byte);
+			byte = 0;
+		}
+	}
+	if (0 != (bits.size() & 7)) {
+		out.push_back(byte);
+	}
+}
+
+int benchReadInt(int argc, char *argv[])
+{
+	vector<const char*> files;
+	getBenchFiles(argc, argv, files);
+
+	for (size_t f = 0; f < files.size(); f++) {
+		CCBIMappedFile input;
+		if (!input.open(files[f]) || !input.isOpen()) {
+			printf("%-32s can not open\n", files[f]);
+			continue;
+		}
+
+		/*odd entries are decoded as signed, like readInt(true) call sites*/
+		vector<unsigned char> stream;
+		size_t count = 0;
+		const unsigned char *bytes = input.getBytes();
+		for (size_t i = 0; i < input.getLength(); i++) {
+			writeGamma(stream, (unsigned long long)bytes[i] + 1);
+			count++;
+			if (i + 1 < input.getLength()) {
+				writeGamma(stream, ((unsigned long long)bytes[i] << 8 | bytes[i + 1]) + 1);
+				count++;
+			}
+		}
+
+		/*repeat until each side has run for a measurable time*/
+		int rounds = 1;
+		while (rounds * count < 20000000) {
+			rounds *= 2;
+		}
+
+		long long legacySum = 0;
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		for (int r = 0; r < rounds; r++) {
+			size_t pos = 0;
+			for (size_t i = 0; i < count; i++) {
+				legacySum += legacyReadInt(&stream[0], pos, 0 != (i & 1));
+			}
+		}
+		double legacyNs = elapsedNs(start);
+
+		long long gammaSum = 0;
+		start = chrono::high_resolution_clock::now();
+		for (int r = 0; r < rounds; r++) {
+			size_t pos = 0;
+			for (size_t i = 0; i < count; i++) {
+				unsigned long long current = CCBIBitReader::readGamma(&stream[0], stream.size(), pos);
+				gammaSum += (i & 1) ? CCBIBitReader::toSigned(current) : CCBIBitReader::toUnsigned(current);
+			}
+		}
+		double gammaNs = elapsedNs(start);
+
+		double ints = (double)count * rounds;
+		printf("%-32s %8u ints  bitwise %6.2f ns/int  word %6.2f ns/int  speedup %5.2fx%s\n",
+			files[f], (unsigned int)count, legacyNs / ints, gammaNs / ints, legacyNs / gammaNs,
+			legacySum == gammaSum ? "" : "  MISMATCH");
+		addBenchResult("readint", "bitwise/" + getBenchFileName(files[f]), legacyNs / ints, "ns");
+		addBenchResult("readint", "word/" + getBenchFileName(files[f]), gammaNs / ints, "ns");
+	}
+
+	return 0;
+}
@@ -0,0 +1,158 @@
+/*
+* Benchmark of <real> formatting: the ostream path the converter started
+* with, the "%g" sprintf it used next, and CCBIRealFormat.
+*
+* The floats are the ones a conversion writes: sequence durations, keyframe
+* times and easing options, and every float field of the node properties
+* of the given ccbi files. Also counts how many of them the 6 digit paths
+* fail to read back exactly.
+*
+* usage: ccbibench real [file.ccbi ...]
+*/
+#include "bench.h"
+#include "../ccbanalyzer/CBIReader.h"
+#include "../ccbanalyzer/CBIRealFormat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+/*number of leading values of a property that are floats*/
+static int getFloatFieldCount(const CCBIProperty &property)
+{
+	switch (property.type)
+	{
+	case kCCBIPropTypePosition:
+	case kCCBIPropTypeSize:
+	case kCCBIPropTypeScaleLock:
+	case kCCBIPropTypePoint:
+	case kCCBIPropTypePointLock:
+	case kCCBIPropTypeFloatXY:
+	case kCCBIPropTypeFloatVar:
+		return 2;
+	case kCCBIPropTypeFloat:
+	case kCCBIPropTypeDegrees:
+	case kCCBIPropTypeFloatScale:
+		return 1;
+	case kCCBIPropTypeColor4FVar:
+		return property.numValues;
+	default:
+		return 0;
+	}
+}
+
+static void collectFloats(const CCBITree &tree, vector<float> &floats)
+{
+	for (int i = 0; i < tree.sequences.size(); i++) {
+		floats.push_back(tree.sequences[i].duration);
+	}
+	for (int i = 0; i < tree.keyframes.size(); i++) {
+		floats.push_back(tree.keyframes[i].time);
+		if (CCBIReader::hasEasingOpt(tree.keyframes[i].easingType)) {
+			floats.push_back(tree.keyframes[i].easingOpt);
+		}
+	}
+	for (int i = 0; i < tree.properties.size(); i++) {
+		const CCBIProperty &property = tree.properties[i];
+		int count = getFloatFieldCount(property);
+		for (int v = 0; v < count; v++) {
+			floats.push_back(tree.values[property.firstValue + v].f);
+		}
+	}
+}
+
+/*keeps the summed text lengths, and so the formatting, alive*/
+static volatile size_t gSink;
+
+static bool readsBack(const char *pText, float value)
+{
+	return (float)strtod(pText, NULL) == value;
+}
+
+int benchReal(int argc, char *argv[])
+{
+	vector<const char*> files;
+	getBenchFiles(argc, argv, files);
+
+	for (size_t f = 0; f < files.size(); f++) {
+		CCBIReader reader(files[f]);
+		if (NULL == reader.getBytes() || !reader.readHeader() || !reader.readStringCache()
+			|| !reader.readSequences() || !reader.readNodeGraph()) {
+			printf("%-32s can not decode\n", files[f]);
+			continue;
+		}
+
+		vector<float> floats;
+		collectFloats(reader.getTree(), floats);
+		if (floats.empty()) {
+			printf("%-32s no floats\n", files[f]);
+			continue;
+		}
+
+		size_t count = floats.size();
+		int rounds = 1;
+		while (rounds * count < 2000000) {
+			rounds *= 2;
+		}
+
+		size_t streamChars = 0;
+		ostringstream stream;
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		for (int r = 0; r < rounds; r++) {
+			for (size_t i = 0; i < count; i++) {
+				stream.str(string());
+				stream << floats[i];
+				streamChars += stream.str().size();
+			}
+		}
+		double streamNs = elapsedNs(start);
+
+		size_t printfChars = 0;
+		char text[CCBIRealFormat::kMaxLength];
+		start = chrono::high_resolution_clock::now();
+		for (int r = 0; r < rounds; r++) {
+			for (size_t i = 0; i < count; i++) {
+				printfChars += sprintf(text, "%g", (double)floats[i]);
+			}
+		}
+		double printfNs = elapsedNs(start);
+
+		size_t formatChars = 0;
+		start = chrono::high_resolution_clock::now();
+		for (int r = 0; r < rounds; r++) {
+			for (size_t i = 0; i < count; i++) {
+				formatChars += CCBIRealFormat::format(floats[i], text);
+			}
+		}
+		double formatNs = elapsedNs(start);
+
+		int lossy = 0;
+		int formatLossy = 0;
+		for (size_t i = 0; i < count; i++) {
+			sprintf(text, "%g", (double)floats[i]);
+			if (!readsBack(text, floats[i])) {
+				lossy++;
+			}
+			text[CCBIRealFormat::format(floats[i], text)] = '\0';
+			if (!readsBack(text, floats[i])) {
+				formatLossy++;
+			}
+		}
+
+		double values = (double)count * rounds;
+		printf("%-32s %6u reals  ostream %6.1f ns  %%g %6.1f ns  format %6.1f ns  speedup %5.2fx  inexact %%g %d format %d\n",
+			files[f], (unsigned int)count, streamNs / values, printfNs / values, formatNs / values, streamNs / formatNs,
+			lossy, formatLossy);
+		gSink = streamChars + printfChars + formatChars;
+
+		string name = getBenchFileName(files[f]);
+		addBenchResult("real", "ostream/" + name, streamNs / values, "ns");
+		addBenchResult("real", "printf/" + name, printfNs / values, "ns");
+		addBenchResult("real", "format/" + name, formatNs / values, "ns");
+	}
+
+	return 0;
+}
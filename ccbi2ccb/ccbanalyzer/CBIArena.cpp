@@ -0,0 +1,78 @@
+#include "CBIArena.h"
+
+#include <stdlib.h>
+
+#include <new>
+
+/*************************************************************************
+Implementation of CCBIArena
+*************************************************************************/
+CCBIArena::CCBIArena(size_t blockSize)
+: mHead(NULL)
+, mBlockSize(blockSize)
+, mBytesAllocated(0)
+{
+}
+
+CCBIArena::~CCBIArena()
+{
+	release();
+}
+
+void* CCBIArena::alloc(size_t size, size_t align)
+{
+	if (NULL != mHead)
+	{
+		size_t offset = (sizeof(Block) + mHead->used + align - 1) & ~(align - 1);
+		if (offset + size <= sizeof(Block) + mHead->size)
+		{
+			mHead->used = offset + size - sizeof(Block);
+			return (char*)mHead + offset;
+		}
+	}
+
+	/*oversized requests get a block of their own behind the current one*/
+	bool oversized = size + align > mBlockSize;
+	size_t blockSize = oversized ? size + align : mBlockSize;
+
+	Block *block = (Block*)malloc(sizeof(Block) + blockSize);
+	if (NULL == block)
+	{
+		throw std::bad_alloc();
+	}
+	block->size = blockSize;
+	block->used = 0;
+	mBytesAllocated += blockSize;
+
+	if (oversized && NULL != mHead)
+	{
+		block->pNext = mHead->pNext;
+		mHead->pNext = block;
+	}
+	else
+	{
+		block->pNext = mHead;
+		mHead = block;
+	}
+
+	size_t offset = (sizeof(Block) + align - 1) & ~(align - 1);
+	block->used = offset + size - sizeof(Block);
+	return (char*)block + offset;
+}
+
+void CCBIArena::release()
+{
+	while (NULL != mHead)
+	{
+		Block *next = mHead->pNext;
+		free(mHead);
+		mHead = next;
+	}
+
+	mBytesAllocated = 0;
+}
+
+size_t CCBIArena::getBytesAllocated() const
+{
+	return mBytesAllocated;
+}
@@ -0,0 +1,167 @@
+#ifndef _CCBII_CCBIArena_H_
+#define _CCBII_CCBIArena_H_
+
+#include <stddef.h>
+#include <string.h>
+
+/**
+* @brief Bump allocator, every allocation is released at once with release()
+*/
+class CCBIArena
+{
+private:
+	struct Block
+	{
+		Block *pNext;
+		size_t size;
+		size_t used;
+	};
+
+	Block *mHead;
+	size_t mBlockSize;
+	size_t mBytesAllocated;
+
+public:
+	static const size_t kDefaultBlockSize = 64 * 1024;
+
+	explicit CCBIArena(size_t blockSize = kDefaultBlockSize);
+	~CCBIArena();
+
+	/**
+	* @brief Allocate size bytes aligned to align (a power of two)
+	*
+	* Throws std::bad_alloc when no block can be had, like new.
+	*/
+	void* alloc(size_t size, size_t align = 8);
+
+	/**
+	* @brief Free every block; pointers handed out before become invalid
+	*/
+	void release();
+
+	size_t getBytesAllocated() const;
+
+private:
+	CCBIArena(const CCBIArena&);
+	CCBIArena& operator=(const CCBIArena&);
+};
+
+/**
+* @brief Growable array of plain data living in a CCBIArena
+*
+* Growing copies the elements into a larger arena allocation and leaves the
+* old one to the arena, so T must be copyable with memcpy.
+*/
+template <typename T>
+class CCBIArenaArray
+{
+private:
+	CCBIArena *mArena;
+	T *mData;
+	int mSize;
+	int mCapacity;
+
+public:
+	CCBIArenaArray()
+	: mArena(NULL)
+	, mData(NULL)
+	, mSize(0)
+	, mCapacity(0)
+	{
+	}
+
+	void init(CCBIArena *pArena)
+	{
+		mArena = pArena;
+		mData = NULL;
+		mSize = 0;
+		mCapacity = 0;
+	}
+
+	void reserve(int capacity)
+	{
+		if (capacity <= mCapacity)
+		{
+			return;
+		}
+
+		T *data = (T*)mArena->alloc(sizeof(T) * (size_t)capacity, sizeof(T) < 8 ? 4 : 8);
+		if (0 != mSize)
+		{
+			memcpy((void*)data, (const void*)mData, sizeof(T) * (size_t)mSize);
+		}
+		mData = data;
+		mCapacity = capacity;
+	}
+
+	/**
+	* @return the index of the new element
+	*/
+	int push_back(const T &value)
+	{
+		if (mSize == mCapacity)
+		{
+			reserve(mCapacity < 16 ? 16 : mCapacity * 2);
+		}
+		mData[mSize] = value;
+		return mSize++;
+	}
+
+	/**
+	* @brief Append count default elements and return the index of the first
+	*/
+	int append(int count)
+	{
+		if (mSize + count > mCapacity)
+		{
+			int capacity = mCapacity < 16 ? 16 : mCapacity * 2;
+			reserve(capacity < mSize + count ? mSize + count : capacity);
+		}
+		int first = mSize;
+		for (int i = 0; i < count; i++)
+		{
+			mData[mSize++] = T();
+		}
+		return first;
+	}
+
+	void truncate(int size)
+	{
+		if (size < mSize)
+		{
+			mSize = size;
+		}
+	}
+
+	int size() const
+	{
+		return mSize;
+	}
+
+	bool empty() const
+	{
+		return 0 == mSize;
+	}
+
+	T& operator[](int index)
+	{
+		return mData[index];
+	}
+
+	const T& operator[](int index) const
+	{
+		return mData[index];
+	}
+
+	T& back()
+	{
+		return mData[mSize - 1];
+	}
+
+	const T* data() const
+	{
+		return mData;
+	}
+};
+
+#endif
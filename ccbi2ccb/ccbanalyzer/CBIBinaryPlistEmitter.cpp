@@ -0,0 +1,531 @@
+#include "CBIBinaryPlistEmitter.h"
+#include "CBIReader.h"
+#include "ccbimapping.h"
+
+using namespace std;
+
+/*************************************************************************
+Implementation of CCBIBinaryPlistEmitter
+*************************************************************************/
+CCBIBinaryPlistEmitter::CCBIBinaryPlistEmitter(const CCBITree &tree, CCBIBinaryPlistWriter &writer)
+: mTree(tree)
+, mWriter(writer)
+, mStringRefs(tree.strings.size(), -1)
+{
+}
+
+void CCBIBinaryPlistEmitter::emit()
+{
+	mWriter.startDict();
+
+	writeHeader();
+
+	/*the default values*/
+	mWriter.writeKey("notes");
+	mWriter.startArray();
+	mWriter.endArray();
+	writeResolutions();
+
+	writeSequences();
+
+	mWriter.writeKey(CCBI_NODEGRAPH_KEY_NODEGRAPH_MAIN);
+	writeNodeGraph();
+
+	mWriter.endDict();
+}
+
+void CCBIBinaryPlistEmitter::writeHeader()
+{
+	mWriter.writeKey("centeredOrigin");
+	mWriter.writeBool(false);
+	mWriter.writeKey("currentResolution");
+	mWriter.writeInteger(0);
+	mWriter.writeKey("currentSequenceId");
+	mWriter.writeInteger(0);
+	mWriter.writeKey("fileType");
+	mWriter.writeString("CocosBuilder");
+	mWriter.writeKey("fileVersion");
+	mWriter.writeInteger(4);
+	mWriter.writeKey("guides");
+	mWriter.startArray();
+	mWriter.endArray();
+
+	mWriter.writeKey("jsControlled");
+	mWriter.writeBool(mTree.header.jsControlled);
+}
+
+void CCBIBinaryPlistEmitter::writeResolutions()
+{
+	mWriter.writeKey("resolutions");
+	mWriter.startArray();
+	mWriter.startDict();
+	mWriter.writeKey("centeredOrigin");
+	mWriter.writeBool(false);
+	mWriter.writeKey("ext");
+	mWriter.writeString("iphone");
+	mWriter.writeKey("height");
+	mWriter.writeInteger(640);
+	mWriter.writeKey("name");
+	mWriter.writeString("iPhone Landscape");
+	mWriter.writeKey("scale");
+	mWriter.writeReal(1);
+	mWriter.writeKey("width");
+	mWriter.writeInteger(400);
+	mWriter.endDict();
+	mWriter.endArray();
+}
+
+void CCBIBinaryPlistEmitter::writeSequences()
+{
+	mWriter.writeKey(CCBI_SEQUENCE_KEY_MAIN);
+	mWriter.startArray();
+
+	for (int i = 0; i < mTree.sequences.size(); i++)
+	{
+		const CCBISequence &sequence = mTree.sequences[i];
+
+		mWriter.startDict();
+		mWriter.writeKey(CCBI_SEQUENCE_KEY_AUTOPLAY_KEY);
+		mWriter.writeBool(true);
+
+		mWriter.writeKey(CCBI_SEQUENCE_KEY_DURATION_LEN);
+		mWriter.writeReal(sequence.duration);
+		mWriter.writeKey("position");
+		mWriter.writeReal(sequence.duration);
+
+		mWriter.writeKey(CCBI_SEQUENCE_KEY_MAIN_NAME);
+		writeCachedString(sequence.nameIndex);
+
+		mWriter.writeKey(CCBI_SEQUENCE_KEY_SEQUENCE_ID);
+		mWriter.writeInteger(sequence.sequenceId);
+
+		if (-1 != sequence.chainedSequenceId)
+		{
+			mWriter.writeKey(CCBI_SEQUENCE_KEY_CHAINEDSEQ_ID);
+			mWriter.writeInteger(sequence.chainedSequenceId);
+		}
+
+		/*other default value setting*/
+		mWriter.writeKey("offset");
+		mWriter.writeReal(0);
+		mWriter.writeKey("resolution");
+		mWriter.writeReal(30);
+		mWriter.writeKey("scale");
+		mWriter.writeReal(512);
+
+		/*the xml writes the keyframes of both channels as empty arrays too*/
+		writeChannel(CCBI_SEQUENCE_CALLBACKCHANNEL_KEY_NAME, 10);
+		writeChannel(CCBI_SEQUENCE_SOUNDCHANNEL_KEY_NAME, 9);
+
+		mWriter.endDict();
+	}
+
+	mWriter.endArray();
+}
+
+void CCBIBinaryPlistEmitter::writeChannel(const char *pName, int type)
+{
+	mWriter.writeKey(pName);
+	mWriter.startDict();
+	mWriter.writeKey(CCBI_SEQUENCE_KEY_KEY_FRAMES);
+	mWriter.startArray();
+	mWriter.endArray();
+	mWriter.writeKey(CCBI_SEQUENCE_CALLBACKCHANNEL_KEY_TYPE);
+	mWriter.writeInteger(type);
+	mWriter.endDict();
+}
+
+void CCBIBinaryPlistEmitter::writeNodeGraph()
+{
+	if (!mTree.nodes.empty())
+	{
+		writeNodes(0, mTree.nodes[0].subtreeEnd);
+	}
+	else
+	{
+		mWriter.startDict();
+		mWriter.endDict();
+	}
+}
+
+void CCBIBinaryPlistEmitter::writeNodes(int first, int end)
+{
+	/*nodes whose children array is still open*/
+	vector<int> open;
+
+	for (int i = first; i < end; i++)
+	{
+		while (!open.empty() && i >= mTree.nodes[open.back()].subtreeEnd)
+		{
+			writeNodeEnd(open.back());
+			open.pop_back();
+		}
+
+		writeNodeStart(i);
+		if (0 != mTree.nodes[i].numChildren)
+		{
+			open.push_back(i);
+		}
+		else
+		{
+			writeNodeEnd(i);
+		}
+	}
+
+	while (!open.empty())
+	{
+		writeNodeEnd(open.back());
+		open.pop_back();
+	}
+}
+
+void CCBIBinaryPlistEmitter::writeNodeStart(int index)
+{
+	const CCBINode &node = mTree.nodes[index];
+
+	mWriter.startDict();
+
+	mWriter.writeKey(CCBI_NODEGRAPH_KEY_BASE_CLASS);
+	writeCachedString(node.classNameIndex);
+
+	mWriter.writeKey("customClass");
+	mWriter.writeString("");
+	mWriter.writeKey("displayName");
+	mWriter.writeString("ccbi2ccbdefault");
+
+	mWriter.writeKey(CCBI_NODEGRAPH_KEY_MEMBERVARASSIGNMENTTYPE);
+	mWriter.writeInteger(node.memberVarAssignmentType);
+
+	if (node.memberVarAssignmentType != kCCBITargetTypeNone)
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_KEY_MEMBERVARASSIGNMENTNAME);
+		writeCachedString(node.memberVarAssignmentNameIndex);
+	}
+
+	writeAnimatedProperties(node);
+
+	mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_PROPERTIES);
+	mWriter.startArray();
+	for (int i = 0; i < node.numProperties; i++)
+	{
+		writeProperty(mTree.properties[node.firstProperty + i]);
+	}
+	mWriter.endArray();
+
+	mWriter.writeKey(CCBI_NODEGRAPH_KEY_CHILDREN);
+	mWriter.startArray();
+}
+
+void CCBIBinaryPlistEmitter::writeNodeEnd(int)
+{
+	mWriter.endArray();
+	mWriter.endDict();
+}
+
+void CCBIBinaryPlistEmitter::writeAnimatedProperties(const CCBINode &node)
+{
+	if (0 == node.numAnimatedSequences)
+	{
+		return;
+	}
+
+	mWriter.writeKey(CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_MAIN);
+	mWriter.startDict();
+	mWriter.writeKey("0");
+	mWriter.startDict();
+
+	for (int i = 0; i < node.numAnimatedProperties; i++)
+	{
+		const CCBIAnimatedProperty &animatedProp = mTree.animatedProperties[node.firstAnimatedProperty + i];
+
+		writeCachedString(animatedProp.nameIndex);
+
+		mWriter.startDict();
+		mWriter.writeKey(CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_KEYFRAMES);
+		mWriter.startArray();
+		for (int k = 0; k < animatedProp.numKeyframes; ++k)
+		{
+			mWriter.startDict();
+			writeKeyframe(animatedProp, mTree.keyframes[animatedProp.firstKeyframe + k]);
+			mWriter.endDict();
+		}
+		mWriter.endArray();
+
+		mWriter.writeKey(CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_NAME);
+		writeCachedString(animatedProp.nameIndex);
+
+		mWriter.writeKey(CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_TYPE);
+		mWriter.writeInteger(CCBIMainPropTypeName::getAnimatedPropTypeValue(animatedProp.type));
+
+		mWriter.endDict();
+	}
+
+	mWriter.endDict();
+	mWriter.endDict();
+}
+
+void CCBIBinaryPlistEmitter::writeKeyframe(const CCBIAnimatedProperty &animatedProp, const CCBIKeyframe &keyframe)
+{
+	const CCBIValue *values = mTree.values.data() + keyframe.firstValue;
+	int type = animatedProp.type;
+
+	mWriter.writeKey("easing");
+	mWriter.startDict();
+	mWriter.writeKey(CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_TYPE);
+	mWriter.writeInteger(keyframe.easingType);
+	if (CCBIReader::hasEasingOpt(keyframe.easingType))
+	{
+		mWriter.writeKey("Opt");
+		mWriter.writeReal(keyframe.easingOpt);
+	}
+	mWriter.endDict();
+
+	mWriter.writeKey(CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_NAME);
+	writeCachedString(animatedProp.nameIndex);
+
+	mWriter.writeKey(CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_TIME);
+	mWriter.writeReal(keyframe.time);
+
+	mWriter.writeKey(CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_TYPE);
+	mWriter.writeInteger(CCBIMainPropTypeName::getAnimatedPropTypeValue(type));
+
+	if (type == kCCBIPropTypeCheck)
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_VALUE);
+		mWriter.writeBool(0 != values[0].i);
+	}
+	else if (type == kCCBIPropTypeByte)
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_VALUE);
+		mWriter.writeInteger(values[0].i);
+	}
+	else if (type == kCCBIPropTypeColor3)
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_VALUE);
+		mWriter.startArray();
+		mWriter.writeInteger(values[0].i);
+		mWriter.writeInteger(values[1].i);
+		mWriter.writeInteger(values[2].i);
+		mWriter.endArray();
+	}
+	else if (type == kCCBIPropTypeDegrees)
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_VALUE);
+		mWriter.writeReal(values[0].f);
+	}
+	else if (type == kCCBIPropTypeScaleLock || type == kCCBIPropTypePosition
+		|| type == kCCBIPropTypeFloatXY)
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_VALUE);
+		mWriter.startArray();
+		mWriter.writeReal(values[0].f);
+		mWriter.writeReal(values[1].f);
+		mWriter.endArray();
+	}
+	else if (type == kCCBIPropTypeSpriteFrame)
+	{
+		/*the ccb lists the sprite file before the sheet*/
+		mWriter.writeKey(CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_VALUE);
+		mWriter.startArray();
+		writeCachedString(values[1].i);
+		writeCachedString(values[0].i);
+		mWriter.endArray();
+	}
+}
+
+void CCBIBinaryPlistEmitter::writeProperty(const CCBIProperty &property)
+{
+	const CCBIValue *values = mTree.values.data() + property.firstValue;
+
+	mWriter.startDict();
+
+	mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_NAME);
+	writeCachedString(property.nameIndex);
+
+	mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_TYPE);
+	mWriter.writeString(CCBIMainPropTypeName::getPropTypeName(property.type));
+
+	switch (property.type)
+	{
+	case kCCBIPropTypePosition:
+	case kCCBIPropTypeSize:
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE);
+		mWriter.startArray();
+		mWriter.writeReal(values[0].f);
+		mWriter.writeReal(values[1].f);
+		mWriter.writeInteger(values[2].i);
+		mWriter.endArray();
+
+		break;
+	}
+	case kCCBIPropTypeScaleLock:
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE);
+		mWriter.startArray();
+		mWriter.writeReal(values[0].f);
+		mWriter.writeReal(values[1].f);
+		mWriter.writeBool(false);
+		mWriter.writeInteger(values[2].i);
+		mWriter.endArray();
+
+		break;
+	}
+	case kCCBIPropTypePoint:
+	case kCCBIPropTypePointLock:
+	case kCCBIPropTypeFloatXY:
+	case kCCBIPropTypeFloatVar:
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE);
+		mWriter.startArray();
+		mWriter.writeReal(values[0].f);
+		mWriter.writeReal(values[1].f);
+		mWriter.endArray();
+
+		break;
+	}
+	case kCCBIPropTypeFloat:
+	case kCCBIPropTypeDegrees:
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE);
+		mWriter.writeReal(values[0].f);
+
+		break;
+	}
+	case kCCBIPropTypeFloatScale:
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE);
+		mWriter.startArray();
+		mWriter.writeReal(values[0].f);
+		mWriter.writeInteger(values[1].i);
+		mWriter.endArray();
+
+		break;
+	}
+	case kCCBIPropTypeInteger:
+	case kCCBIPropTypeIntegerLabeled:
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE);
+		mWriter.writeInteger(values[0].i);
+
+		break;
+	}
+	case kCCBIPropTypeCheck:
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE);
+		mWriter.writeBool(0 != values[0].i);
+
+		break;
+	}
+	case kCCBIPropTypeSpriteFrame:
+	case kCCBIPropTypeAnimation:
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE);
+		mWriter.startArray();
+		writeCachedString(values[0].i);
+		writeCachedString(values[1].i);
+		mWriter.endArray();
+
+		break;
+	}
+	case kCCBIPropTypeTexture:
+	case kCCBIPropTypeFntFile:
+	case kCCBIPropTypeFontTTF:
+	case kCCBIPropTypeString:
+	case kCCBIPropTypeText:
+	case kCCBIPropTypeCCBIFile:
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE);
+		writeCachedString(values[0].i);
+
+		break;
+	}
+	case kCCBIPropTypeByte:
+	{
+		/*0xff is written as 0*/
+		mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE);
+		mWriter.writeInteger(0xff == values[0].i ? 0 : values[0].i);
+
+		break;
+	}
+	case kCCBIPropTypeColor3:
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE);
+		mWriter.startArray();
+		mWriter.writeInteger(values[0].i);
+		mWriter.writeInteger(values[1].i);
+		mWriter.writeInteger(values[2].i);
+		mWriter.endArray();
+
+		break;
+	}
+	case kCCBIPropTypeColor4FVar:
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE);
+		mWriter.startArray();
+		for (int c = 0; c < 8; c++)
+		{
+			mWriter.writeReal(values[c].f);
+		}
+		mWriter.endArray();
+
+		break;
+	}
+	case kCCBIPropTypeFlip:
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE);
+		mWriter.startArray();
+		mWriter.writeBool(0 != values[0].i);
+		mWriter.writeBool(0 != values[1].i);
+		mWriter.endArray();
+
+		break;
+	}
+	case kCCBIPropTypeBlendmode:
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE);
+		mWriter.startArray();
+		mWriter.writeInteger(values[0].i);
+		mWriter.writeInteger(values[1].i);
+		mWriter.endArray();
+
+		break;
+	}
+	case kCCBIPropTypeBlock:
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE);
+		mWriter.startArray();
+		writeCachedString(values[0].i);
+		mWriter.writeInteger(values[1].i);
+		mWriter.endArray();
+
+		break;
+	}
+	case kCCBIPropTypeBlockCCControl:
+	{
+		mWriter.writeKey(CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE);
+		mWriter.startArray();
+		writeCachedString(values[0].i);
+		mWriter.writeInteger(values[1].i);
+		mWriter.writeInteger(values[2].i);
+		mWriter.endArray();
+
+		break;
+	}
+	default:
+		break;
+	}
+
+	mWriter.endDict();
+}
+
+void CCBIBinaryPlistEmitter::writeCachedString(int index)
+{
+	int &ref = mStringRefs[index];
+	if (-1 == ref)
+	{
+		CCBIStringView string = mTree.getString(index);
+		ref = mWriter.addString(string.pChars, string.length);
+	}
+	mWriter.writeRef(ref);
+}
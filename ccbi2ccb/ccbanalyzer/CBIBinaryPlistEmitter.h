@@ -0,0 +1,62 @@
+#ifndef _CCBII_CCBIBinaryPlistEmitter_H_
+#define _CCBII_CCBIBinaryPlistEmitter_H_
+
+#include <vector>
+
+#include "CBITree.h"
+#include "CBIBinaryPlistWriter.h"
+
+/**
+* @brief Write a decoded CCBITree as a ccb binary plist (bplist00)
+*
+* Builds the same document as CCBIXMLEmitter. Every string cache entry
+* becomes a single string object however often it is used. Where the xml
+* writes a key without a value, the binary document leaves the key out.
+*/
+class CCBIBinaryPlistEmitter
+{
+private:
+	const CCBITree &mTree;
+	CCBIBinaryPlistWriter &mWriter;
+
+	/*object of string cache entry i, -1 until first used*/
+	std::vector<int> mStringRefs;
+
+public:
+	/*the binary document is much smaller than the xml one*/
+	static const size_t kOutputSizeRatio = 8;
+
+	CCBIBinaryPlistEmitter(const CCBITree &tree, CCBIBinaryPlistWriter &writer);
+
+	/**
+	* @brief Build the whole document
+	*/
+	void emit();
+
+	void writeHeader();
+	void writeSequences();
+	void writeNodeGraph();
+
+	/**
+	* @brief Write the nodes of the subtree [first, end) in pre-order
+	*/
+	void writeNodes(int first, int end);
+
+private:
+	void writeNodeStart(int index);
+	void writeNodeEnd(int index);
+
+	void writeChannel(const char *pName, int type);
+	void writeAnimatedProperties(const CCBINode &node);
+	void writeKeyframe(const CCBIAnimatedProperty &animatedProp, const CCBIKeyframe &keyframe);
+	void writeProperty(const CCBIProperty &property);
+
+	void writeCachedString(int index);
+
+	void writeResolutions();
+
+	CCBIBinaryPlistEmitter(const CCBIBinaryPlistEmitter&);
+	CCBIBinaryPlistEmitter& operator=(const CCBIBinaryPlistEmitter&);
+};
+
+#endif
@@ -0,0 +1,399 @@
+#include "CBIBinaryPlistWriter.h"
+#include "CBIUTF8.h"
+
+#include <string.h>
+
+using namespace std;
+
+/*object type nibbles of the bplist00 format*/
+enum
+{
+	kMarkerFalse = 0x08,
+	kMarkerTrue = 0x09,
+	kMarkerInteger = 0x10,
+	kMarkerReal = 0x20,
+	kMarkerASCIIString = 0x50,
+	kMarkerUnicodeString = 0x60,
+	kMarkerArray = 0xa0,
+	kMarkerDict = 0xd0
+};
+
+static const char kMagic[] = "bplist00";
+static const int kTrailerSize = 32;
+
+/*************************************************************************
+Implementation of CCBIBinaryPlistWriter
+*************************************************************************/
+CCBIBinaryPlistWriter::CCBIBinaryPlistWriter()
+{
+	clear();
+}
+
+void CCBIBinaryPlistWriter::clear()
+{
+	mObjects.clear();
+	mStringBytes.clear();
+	mRefs.clear();
+	mPending.clear();
+	mOpen.clear();
+	mTopObject = -1;
+
+	mBoolRefs[0] = -1;
+	mBoolRefs[1] = -1;
+	mSmallIntegerRefs.assign(kSmallIntegerCount, -1);
+	mConstStringRefs.clear();
+}
+
+int CCBIBinaryPlistWriter::addObject(const Object &object)
+{
+	mObjects.push_back(object);
+	return (int)mObjects.size() - 1;
+}
+
+int CCBIBinaryPlistWriter::addString(const char *pString, size_t length)
+{
+	Object object;
+	object.kind = kObjectString;
+	object.count = (int)length;
+	object.first = mStringBytes.size();
+	object.integer = 0;
+	mStringBytes.insert(mStringBytes.end(), pString, pString + length);
+
+	return addObject(object);
+}
+
+int CCBIBinaryPlistWriter::addConstString(const char *pString)
+{
+	string key(pString);
+	unordered_map<string, int>::const_iterator it = mConstStringRefs.find(key);
+	if (it != mConstStringRefs.end())
+	{
+		return it->second;
+	}
+
+	int ref = addString(key.data(), key.size());
+	mConstStringRefs[key] = ref;
+	return ref;
+}
+
+int CCBIBinaryPlistWriter::addInteger(long long value)
+{
+	bool small = value >= 0 && value < kSmallIntegerCount;
+	if (small && -1 != mSmallIntegerRefs[(int)value])
+	{
+		return mSmallIntegerRefs[(int)value];
+	}
+
+	Object object;
+	object.kind = kObjectInteger;
+	object.count = 0;
+	object.first = 0;
+	object.integer = value;
+
+	int ref = addObject(object);
+	if (small)
+	{
+		mSmallIntegerRefs[(int)value] = ref;
+	}
+	return ref;
+}
+
+int CCBIBinaryPlistWriter::addReal(double value)
+{
+	Object object;
+	object.kind = kObjectReal;
+	object.count = 0;
+	object.first = 0;
+	object.real = value;
+
+	return addObject(object);
+}
+
+int CCBIBinaryPlistWriter::addBool(bool value)
+{
+	int &ref = mBoolRefs[value ? 1 : 0];
+	if (-1 == ref)
+	{
+		Object object;
+		object.kind = kObjectBool;
+		object.count = 0;
+		object.first = 0;
+		object.integer = value ? 1 : 0;
+		ref = addObject(object);
+	}
+	return ref;
+}
+
+void CCBIBinaryPlistWriter::writeRef(int ref)
+{
+	if (mOpen.empty())
+	{
+		mTopObject = ref;
+		return;
+	}
+	mPending.push_back(ref);
+}
+
+void CCBIBinaryPlistWriter::writeKey(const char *pKey)
+{
+	writeRef(addConstString(pKey));
+}
+
+void CCBIBinaryPlistWriter::writeString(const char *pString)
+{
+	writeRef(addConstString(pString));
+}
+
+void CCBIBinaryPlistWriter::writeInteger(long long value)
+{
+	writeRef(addInteger(value));
+}
+
+void CCBIBinaryPlistWriter::writeReal(double value)
+{
+	writeRef(addReal(value));
+}
+
+void CCBIBinaryPlistWriter::writeBool(bool value)
+{
+	writeRef(addBool(value));
+}
+
+void CCBIBinaryPlistWriter::startArray()
+{
+	Frame frame;
+	frame.kind = kObjectArray;
+	frame.firstPending = mPending.size();
+	mOpen.push_back(frame);
+}
+
+void CCBIBinaryPlistWriter::endArray()
+{
+	endContainer(kObjectArray);
+}
+
+void CCBIBinaryPlistWriter::startDict()
+{
+	Frame frame;
+	frame.kind = kObjectDict;
+	frame.firstPending = mPending.size();
+	mOpen.push_back(frame);
+}
+
+void CCBIBinaryPlistWriter::endDict()
+{
+	endContainer(kObjectDict);
+}
+
+void CCBIBinaryPlistWriter::endContainer(int kind)
+{
+	if (mOpen.empty() || mOpen.back().kind != kind)
+	{
+		return;
+	}
+
+	size_t firstPending = mOpen.back().firstPending;
+	mOpen.pop_back();
+
+	size_t count = mPending.size() - firstPending;
+
+	Object object;
+	object.kind = kind;
+	object.first = mRefs.size();
+	object.integer = 0;
+
+	if (kObjectDict == kind)
+	{
+		/*written as key, value, key, value... but stored as keys, then values*/
+		object.count = (int)(count / 2);
+		for (size_t i = 0; i < count; i += 2)
+		{
+			mRefs.push_back(mPending[firstPending + i]);
+		}
+		for (size_t i = 1; i < count; i += 2)
+		{
+			mRefs.push_back(mPending[firstPending + i]);
+		}
+	}
+	else
+	{
+		object.count = (int)count;
+		mRefs.insert(mRefs.end(), mPending.begin() + firstPending, mPending.end());
+	}
+	mPending.resize(firstPending);
+
+	writeRef(addObject(object));
+}
+
+int CCBIBinaryPlistWriter::getObjectCount() const
+{
+	return (int)mObjects.size();
+}
+
+void CCBIBinaryPlistWriter::serialize(CCBIPlistWriter &out) const
+{
+	size_t start = out.getSize();
+	int numObjects = (int)mObjects.size();
+	int refSize = getByteCount((unsigned long long)(numObjects > 0 ? numObjects - 1 : 0));
+
+	/*objects in reference order, noting where each one lands*/
+	out.write(kMagic, sizeof(kMagic) - 1);
+
+	vector<unsigned long long> offsets(numObjects);
+	for (int i = 0; i < numObjects; i++)
+	{
+		offsets[i] = out.getSize() - start;
+		writeObject(out, mObjects[i], refSize);
+	}
+
+	unsigned long long offsetTable = out.getSize() - start;
+	int offsetSize = getByteCount(offsetTable);
+	for (int i = 0; i < numObjects; i++)
+	{
+		writeBigEndian(out, offsets[i], offsetSize);
+	}
+
+	/*trailer: 6 unused bytes, the two sizes, then three 64 bit fields*/
+	char unused[6] = { 0 };
+	out.write(unused, sizeof(unused));
+	out.writeChar((char)offsetSize);
+	out.writeChar((char)refSize);
+	writeBigEndian(out, (unsigned long long)numObjects, 8);
+	writeBigEndian(out, (unsigned long long)(mTopObject < 0 ? 0 : mTopObject), 8);
+	writeBigEndian(out, offsetTable, 8);
+}
+
+void CCBIBinaryPlistWriter::writeObject(CCBIPlistWriter &out, const Object &object, int refSize) const
+{
+	switch (object.kind)
+	{
+	case kObjectBool:
+		out.writeChar((char)(0 != object.integer ? kMarkerTrue : kMarkerFalse));
+		break;
+	case kObjectInteger:
+		writeIntegerObject(out, object.integer);
+		break;
+	case kObjectReal:
+	{
+		unsigned long long bits;
+		memcpy(&bits, &object.real, sizeof(bits));
+		out.writeChar((char)(kMarkerReal | 3));
+		writeBigEndian(out, bits, 8);
+		break;
+	}
+	case kObjectString:
+		writeStringObject(out, object);
+		break;
+	case kObjectArray:
+		writeMarker(out, kMarkerArray, object.count);
+		for (int i = 0; i < object.count; i++)
+		{
+			writeBigEndian(out, (unsigned long long)mRefs[object.first + i], refSize);
+		}
+		break;
+	case kObjectDict:
+		writeMarker(out, kMarkerDict, object.count);
+		for (int i = 0; i < object.count * 2; i++)
+		{
+			writeBigEndian(out, (unsigned long long)mRefs[object.first + i], refSize);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+void CCBIBinaryPlistWriter::writeStringObject(CCBIPlistWriter &out, const Object &object) const
+{
+	const unsigned char *pBytes = (const unsigned char*)(mStringBytes.empty() ? NULL : &mStringBytes[0] + object.first);
+	size_t length = object.count;
+
+	bool ascii = true;
+	for (size_t i = 0; i < length && ascii; i++)
+	{
+		ascii = pBytes[i] < 0x80;
+	}
+
+	if (ascii)
+	{
+		writeMarker(out, kMarkerASCIIString, length);
+		out.write((const char*)pBytes, length);
+		return;
+	}
+
+	/*anything else is stored as big endian UTF-16*/
+	vector<unsigned short> units;
+	units.reserve(length);
+	size_t pos = 0;
+	while (pos < length)
+	{
+		unsigned int c = CCBIUTF8::decode(pBytes, length, pos);
+		if (c >= 0x10000)
+		{
+			c -= 0x10000;
+			units.push_back((unsigned short)(0xd800 | (c >> 10)));
+			units.push_back((unsigned short)(0xdc00 | (c & 0x3ff)));
+		}
+		else
+		{
+			units.push_back((unsigned short)c);
+		}
+	}
+
+	writeMarker(out, kMarkerUnicodeString, units.size());
+	for (size_t i = 0; i < units.size(); i++)
+	{
+		writeBigEndian(out, units[i], 2);
+	}
+}
+
+void CCBIBinaryPlistWriter::writeMarker(CCBIPlistWriter &out, int type, size_t count)
+{
+	/*counts from 15 on follow the marker as an integer object*/
+	if (count < 15)
+	{
+		out.writeChar((char)(type | (int)count));
+		return;
+	}
+
+	out.writeChar((char)(type | 0x0f));
+	writeIntegerObject(out, (long long)count);
+}
+
+void CCBIBinaryPlistWriter::writeIntegerObject(CCBIPlistWriter &out, long long value)
+{
+	/*negative values are always 8 bytes*/
+	int size = value < 0 ? 8 : getByteCount((unsigned long long)value);
+	int power = 1 == size ? 0 : 2 == size ? 1 : 4 == size ? 2 : 3;
+
+	out.writeChar((char)(kMarkerInteger | power));
+	writeBigEndian(out, (unsigned long long)value, size);
+}
+
+void CCBIBinaryPlistWriter::writeBigEndian(CCBIPlistWriter &out, unsigned long long value, int size)
+{
+	char bytes[8];
+	for (int i = size - 1; i >= 0; i--)
+	{
+		bytes[i] = (char)(value & 0xff);
+		value >>= 8;
+	}
+	out.write(bytes, size);
+}
+
+int CCBIBinaryPlistWriter::getByteCount(unsigned long long value)
+{
+	if (value <= 0xffull)
+	{
+		return 1;
+	}
+	if (value <= 0xffffull)
+	{
+		return 2;
+	}
+	if (value <= 0xffffffffull)
+	{
+		return 4;
+	}
+	return 8;
+}
@@ -0,0 +1,125 @@
+#ifndef _CCBII_CCBIBinaryPlistWriter_H_
+#define _CCBII_CCBIBinaryPlistWriter_H_
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "CBIPlistWriter.h"
+
+/**
+* @brief Builder for a bplist00 binary property list
+*
+* Values are written in document order like with CCBIPlistWriter: a value
+* written while a container is open goes into that container, and in a
+* dict keys and values alternate. Every value becomes an object of the
+* object table and addXXX() hands out its reference, so a string used many
+* times can be written once and referenced with writeRef().
+*
+* serialize() lays out the objects, the offset table and the trailer in a
+* single pass once the document is complete.
+*/
+class CCBIBinaryPlistWriter
+{
+private:
+	enum
+	{
+		kObjectBool,
+		kObjectInteger,
+		kObjectReal,
+		kObjectString,
+		kObjectArray,
+		kObjectDict
+	};
+
+	struct Object
+	{
+		int kind;
+		/*bytes of a string, references of a container (dict: keys, then values)*/
+		int count;
+		size_t first;
+		union
+		{
+			long long integer;
+			double real;
+		};
+	};
+
+	struct Frame
+	{
+		int kind;
+		size_t firstPending;
+	};
+
+	std::vector<Object> mObjects;
+	std::vector<char> mStringBytes;
+	std::vector<int> mRefs;
+
+	/*references written into the open containers*/
+	std::vector<int> mPending;
+	std::vector<Frame> mOpen;
+	int mTopObject;
+
+	/*shared objects: the two bools, small ints and the strings given by value*/
+	int mBoolRefs[2];
+	std::vector<int> mSmallIntegerRefs;
+	std::unordered_map<std::string, int> mConstStringRefs;
+
+public:
+	/*integers in [0, kSmallIntegerCount) are written once and shared*/
+	static const int kSmallIntegerCount = 256;
+
+	CCBIBinaryPlistWriter();
+
+	void clear();
+
+	/* Objects, the return value is the reference to the object. */
+	int addString(const char *pString, size_t length);
+	/*deduplicated by content, meant for keys and fixed values*/
+	int addConstString(const char *pString);
+	int addInteger(long long value);
+	int addReal(double value);
+	int addBool(bool value);
+
+	/**
+	* @brief Put the object ref into the open container
+	*/
+	void writeRef(int ref);
+
+	void writeKey(const char *pKey);
+	void writeString(const char *pString);
+	void writeInteger(long long value);
+	void writeReal(double value);
+	void writeBool(bool value);
+
+	void startArray();
+	void endArray();
+	void startDict();
+	void endDict();
+
+	int getObjectCount() const;
+
+	/**
+	* @brief Write the whole bplist00 file into out; the outermost container
+	* is the top object
+	*/
+	void serialize(CCBIPlistWriter &out) const;
+
+private:
+	void endContainer(int kind);
+	int addObject(const Object &object);
+
+	void writeObject(CCBIPlistWriter &out, const Object &object, int refSize) const;
+	void writeStringObject(CCBIPlistWriter &out, const Object &object) const;
+
+	static void writeMarker(CCBIPlistWriter &out, int type, size_t count);
+	static void writeIntegerObject(CCBIPlistWriter &out, long long value);
+	static void writeBigEndian(CCBIPlistWriter &out, unsigned long long value, int size);
+	static int getByteCount(unsigned long long value);
+
+	CCBIBinaryPlistWriter(const CCBIBinaryPlistWriter&);
+	CCBIBinaryPlistWriter& operator=(const CCBIBinaryPlistWriter&);
+};
+
+#endif
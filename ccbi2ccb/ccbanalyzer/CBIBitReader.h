@@ -0,0 +1,182 @@
+#ifndef _CCBII_CCBIBitReader_H_
+#define _CCBII_CCBIBitReader_H_
+
+#include <stddef.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "../util/include/ssMacro.h"
+
+/*the longest int readGamma accepts: 63 zero bits, a one bit and 63 value bits*/
+#define kCCBIMaxIntBytes 16
+
+/**
+* @brief Word-at-a-time decoder for the Elias-gamma ints of a ccbi file
+*
+* A ccbi int is stored least significant bit first as N zero bits, a one
+* bit and N value bits (most significant first), padded to the next byte.
+* Codes of up to 8 bits are resolved with a single table lookup, longer
+* ones from one 64 bit little endian window with a count-trailing-zeros.
+*/
+class CCBIBitReader
+{
+private:
+	/*gamma value of every byte holding a whole code, 0 if the code is longer*/
+	static const unsigned char shortCodeValue[256];
+	static const unsigned char reversedByte[256];
+
+	CCBIBitReader();
+
+public:
+	/**
+	* @brief Decode the byte aligned code at pos and move pos past its padding
+	* @return the gamma value (>= 1), or 0 if the code runs past the end
+	*/
+	static unsigned long long readGamma(const unsigned char *pBytes, size_t length, size_t &pos)
+	{
+		if (pos < length)
+		{
+			unsigned char value = shortCodeValue[pBytes[pos]];
+			if (0 != value)
+			{
+				pos++;
+				return value;
+			}
+		}
+
+		return readLongGamma(pBytes, length, pos);
+	}
+
+	static int toUnsigned(unsigned long long current)
+	{
+		return (int)(current - 1);
+	}
+
+	static int toSigned(unsigned long long current)
+	{
+		long long half = (long long)(current >> 1);
+		return (int)((current & 1) ? half : -half);
+	}
+
+private:
+	static unsigned long long load64(const unsigned char *pBytes, size_t length, size_t pos)
+	{
+		unsigned long long word = 0;
+		size_t avail = length - pos;
+		if (avail >= sizeof(word))
+		{
+			memcpy(&word, pBytes + pos, sizeof(word));
+		}
+		else
+		{
+			memcpy(&word, pBytes + pos, avail);
+		}
+
+		if (SS_HOST_IS_BIG_ENDIAN)
+		{
+			unsigned long long swapped = 0;
+			for (int i = 0; i < 8; i++)
+			{
+				swapped = (swapped << 8) | ((word >> (i * 8)) & 0xff);
+			}
+			word = swapped;
+		}
+
+		return word;
+	}
+
+	static int countTrailingZeros(unsigned long long word)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		if (_BitScanForward(&index, (unsigned long)word))
+		{
+			return (int)index;
+		}
+		_BitScanForward(&index, (unsigned long)(word >> 32));
+		return (int)index + 32;
+#else
+		return __builtin_ctzll(word);
+#endif
+	}
+
+	static unsigned int reverseBits(unsigned int bits, int count)
+	{
+		unsigned int reversed = ((unsigned int)reversedByte[bits & 0xff] << 24)
+			| ((unsigned int)reversedByte[(bits >> 8) & 0xff] << 16)
+			| ((unsigned int)reversedByte[(bits >> 16) & 0xff] << 8)
+			| (unsigned int)reversedByte[bits >> 24];
+		return reversed >> (32 - count);
+	}
+
+	static unsigned long long readLongGamma(const unsigned char *pBytes, size_t length, size_t &pos)
+	{
+		if (pos >= length)
+		{
+			return 0;
+		}
+
+		unsigned long long word = load64(pBytes, length, pos);
+
+		/*N <= 31 keeps the whole code (2N + 1 bits) inside the window*/
+		if (0 != (word & 0xffffffffULL))
+		{
+			int numBits = countTrailingZeros(word);
+			size_t numBytes = (size_t)(2 * numBits + 1 + 7) >> 3;
+			if (numBytes > length - pos)
+			{
+				return 0;
+			}
+
+			unsigned long long current = 1ULL << numBits;
+			if (numBits > 0)
+			{
+				unsigned int bits = (unsigned int)(word >> (numBits + 1)) & (unsigned int)((1ULL << numBits) - 1);
+				current |= reverseBits(bits, numBits);
+			}
+
+			pos += numBytes;
+			return current;
+		}
+
+		return readGammaBitwise(pBytes, length, pos);
+	}
+
+	/*codes wider than the window, only hit by corrupted or hostile input*/
+	static unsigned long long readGammaBitwise(const unsigned char *pBytes, size_t length, size_t &pos)
+	{
+		size_t bit = pos * 8;
+		size_t end = length * 8;
+
+		int numBits = 0;
+		while (bit < end && !((pBytes[bit >> 3] >> (bit & 7)) & 1))
+		{
+			numBits++;
+			bit++;
+		}
+
+		if (bit >= end || numBits >= 64 || bit + 1 + numBits > end)
+		{
+			return 0;
+		}
+		bit++;
+
+		unsigned long long current = 0;
+		for (int a = numBits - 1; a >= 0; a--, bit++)
+		{
+			if ((pBytes[bit >> 3] >> (bit & 7)) & 1)
+			{
+				current |= 1ULL << a;
+			}
+		}
+		current |= 1ULL << numBits;
+
+		pos = (bit + 7) >> 3;
+		return current;
+	}
+};
+
+#endif
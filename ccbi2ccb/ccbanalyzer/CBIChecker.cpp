@@ -0,0 +1,558 @@
+#include "CBIChecker.h"
+#include "CBIReader.h"
+#include "CBIBitReader.h"
+#include "CBIPropertyCodec.h"
+
+#include <stdio.h>
+
+using namespace std;
+
+/*************************************************************************
+Implementation of CCBIChecker
+*************************************************************************/
+CCBIChecker::CCBIChecker(const unsigned char *pBytes, size_t length)
+: mBytes(pBytes)
+, mLength(NULL == pBytes ? 0 : length)
+, mPos(0)
+, mJSControlled(false)
+, mStringCacheOffset(0)
+, mNumStrings(0)
+, mNumSequences(0)
+, mNumNodes(0)
+, mNumProperties(0)
+, mNumKeyframes(0)
+, mErrorOffset(0)
+{
+}
+
+const std::string& CCBIChecker::getError() const
+{
+	return mError;
+}
+
+size_t CCBIChecker::getErrorOffset() const
+{
+	return mErrorOffset;
+}
+
+int CCBIChecker::getNumStrings() const
+{
+	return mNumStrings;
+}
+
+int CCBIChecker::getNumSequences() const
+{
+	return mNumSequences;
+}
+
+int CCBIChecker::getNumNodes() const
+{
+	return mNumNodes;
+}
+
+int CCBIChecker::getNumProperties() const
+{
+	return mNumProperties;
+}
+
+int CCBIChecker::getNumKeyframes() const
+{
+	return mNumKeyframes;
+}
+
+bool CCBIChecker::fail(size_t offset, const char *pMessage)
+{
+	if (mError.empty())
+	{
+		mError = pMessage;
+		mErrorOffset = offset;
+	}
+	return false;
+}
+
+std::string CCBIChecker::getString(int index) const
+{
+	/*only for messages: walk the cache again rather than index it up front*/
+	size_t pos = mStringCacheOffset;
+	for (int i = 0; i < index; i++)
+	{
+		pos += 2 + (mBytes[pos] << 8 | mBytes[pos + 1]);
+	}
+	return string((const char*)mBytes + pos + 2, mBytes[pos] << 8 | mBytes[pos + 1]);
+}
+
+bool CCBIChecker::check()
+{
+	mPos = 0;
+	mError.clear();
+	mErrorOffset = 0;
+	mNumStrings = 0;
+	mNumSequences = 0;
+	mNumNodes = 0;
+	mNumProperties = 0;
+	mNumKeyframes = 0;
+
+	if (!checkHeader() || !checkStringCache() || !checkSequences() || !checkNodeGraph())
+	{
+		return false;
+	}
+
+	if (mPos != mLength)
+	{
+		char message[64];
+		sprintf(message, "%lu bytes after the node graph", (unsigned long)(mLength - mPos));
+		return fail(mPos, message);
+	}
+
+	return true;
+}
+
+bool CCBIChecker::checkHeader()
+{
+	if (mLength < 4)
+	{
+		return fail(0, "too short for a ccbi header");
+	}
+
+	/*"ibcc", the little endian 'ccbi'; older publishers wrote it upper case*/
+	if (!(0 == memcmp(mBytes, "ibcc", 4) || 0 == memcmp(mBytes, "IBCC", 4)))
+	{
+		return fail(0, "not a ccbi file");
+	}
+	mPos = 4;
+
+	size_t offset = mPos;
+	int version;
+	if (!readInt(false, version))
+	{
+		return false;
+	}
+	if (kCCBIVersion != version)
+	{
+		char message[64];
+		sprintf(message, "version %d, only version %d is supported", version, kCCBIVersion);
+		return fail(offset, message);
+	}
+
+	unsigned char jsControlled;
+	if (!readByte(jsControlled))
+	{
+		return false;
+	}
+	mJSControlled = 0 != jsControlled;
+
+	return true;
+}
+
+bool CCBIChecker::checkStringCache()
+{
+	if (!readCount(mNumStrings))
+	{
+		return false;
+	}
+
+	mStringCacheOffset = mPos;
+	for (int i = 0; i < mNumStrings; i++)
+	{
+		if (mLength - mPos < 2)
+		{
+			return fail(mPos, "string cache runs past the end of the file");
+		}
+
+		size_t length = mBytes[mPos] << 8 | mBytes[mPos + 1];
+		if (mLength - mPos - 2 < length)
+		{
+			char message[64];
+			sprintf(message, "string %d runs past the end of the file", i);
+			return fail(mPos, message);
+		}
+		mPos += 2 + length;
+	}
+
+	return true;
+}
+
+bool CCBIChecker::checkSequences()
+{
+	if (!readCount(mNumSequences))
+	{
+		return false;
+	}
+
+	for (int i = 0; i < mNumSequences; i++)
+	{
+		int nameIndex, sequenceId, chainedSequenceId;
+		if (!readFloat() || !readStringIndex(nameIndex)
+			|| !readInt(false, sequenceId) || !readInt(true, chainedSequenceId))
+		{
+			return false;
+		}
+
+		int numKeyframes;
+		if (!readCount(numKeyframes))
+		{
+			return false;
+		}
+		for (int k = 0; k < numKeyframes; k++)
+		{
+			int callbackType;
+			if (!readFloat() || !readStringIndex(nameIndex) || !readInt(false, callbackType))
+			{
+				return false;
+			}
+		}
+
+		if (!readCount(numKeyframes))
+		{
+			return false;
+		}
+		for (int k = 0; k < numKeyframes; k++)
+		{
+			int fileIndex;
+			if (!readFloat() || !readStringIndex(fileIndex) || !readFloat() || !readFloat() || !readFloat())
+			{
+				return false;
+			}
+		}
+	}
+
+	int autoPlaySequenceId;
+	return readInt(true, autoPlaySequenceId);
+}
+
+bool CCBIChecker::checkNodeGraph()
+{
+	mOpen.clear();
+	if (!checkNode())
+	{
+		return false;
+	}
+
+	/*pre-order without recursion, so a deep graph can not exhaust the stack*/
+	while (!mOpen.empty())
+	{
+		if (0 == mOpen.back())
+		{
+			mOpen.pop_back();
+			continue;
+		}
+
+		mOpen.back()--;
+		if (!checkNode())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool CCBIChecker::checkNode()
+{
+	mNumNodes++;
+
+	int classNameIndex;
+	if (!readStringIndex(classNameIndex))
+	{
+		return false;
+	}
+
+	int nameIndex;
+	if (mJSControlled && !readStringIndex(nameIndex))
+	{
+		return false;
+	}
+
+	size_t offset = mPos;
+	int memberVarAssignmentType;
+	if (!readInt(false, memberVarAssignmentType))
+	{
+		return false;
+	}
+	if (memberVarAssignmentType > kCCBITargetTypeOwner)
+	{
+		char message[64];
+		sprintf(message, "unknown member variable assignment type %d", memberVarAssignmentType);
+		return fail(offset, message);
+	}
+	if (kCCBITargetTypeNone != memberVarAssignmentType && !readStringIndex(nameIndex))
+	{
+		return false;
+	}
+
+	/*animated properties*/
+	int numSequences;
+	if (!readCount(numSequences))
+	{
+		return false;
+	}
+	for (int i = 0; i < numSequences; i++)
+	{
+		int sequenceId, numProps;
+		if (!readInt(false, sequenceId) || !readCount(numProps))
+		{
+			return false;
+		}
+
+		for (int j = 0; j < numProps; j++)
+		{
+			int type, numKeyframes;
+			if (!readStringIndex(nameIndex))
+			{
+				return false;
+			}
+
+			offset = mPos;
+			if (!readInt(false, type))
+			{
+				return false;
+			}
+			if (type >= kCCBIPropTypeMAX)
+			{
+				char message[256];
+				sprintf(message, "unknown animated property type %d (property '%.64s')", type, getString(nameIndex).c_str());
+				return fail(offset, message);
+			}
+
+			if (!readCount(numKeyframes))
+			{
+				return false;
+			}
+			for (int k = 0; k < numKeyframes; k++)
+			{
+				if (!checkKeyframe(type))
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	/*properties*/
+	int numRegular, numExtra;
+	if (!readCount(numRegular) || !readCount(numExtra))
+	{
+		return false;
+	}
+	for (int i = numRegular + numExtra; i > 0; i--)
+	{
+		if (!checkProperty())
+		{
+			return false;
+		}
+	}
+
+	int numChildren;
+	if (!readCount(numChildren))
+	{
+		return false;
+	}
+	if (0 != numChildren)
+	{
+		mOpen.push_back(numChildren);
+	}
+
+	return true;
+}
+
+bool CCBIChecker::checkProperty()
+{
+	mNumProperties++;
+
+	size_t offset = mPos;
+	int type, nameIndex;
+	if (!readInt(false, type) || !readStringIndex(nameIndex))
+	{
+		return false;
+	}
+	if (type >= kCCBIPropTypeMAX)
+	{
+		char message[256];
+		sprintf(message, "unknown property type %d (property '%.64s')", type, getString(nameIndex).c_str());
+		return fail(offset, message);
+	}
+
+	offset = mPos;
+	unsigned char platform;
+	if (!readByte(platform))
+	{
+		return false;
+	}
+	if (platform > kCCBIPlatformMac)
+	{
+		char message[64];
+		sprintf(message, "unknown platform %d", platform);
+		return fail(offset, message);
+	}
+
+	const CCBIPropertyCodec &codec = kCCBIPropertyCodecs[type];
+	return checkValues(codec.fields, codec.numFields);
+}
+
+bool CCBIChecker::checkKeyframe(int type)
+{
+	mNumKeyframes++;
+
+	if (!readFloat())
+	{
+		return false;
+	}
+
+	size_t offset = mPos;
+	int easingType;
+	if (!readInt(false, easingType))
+	{
+		return false;
+	}
+	if (easingType > kCCBIKeyframeEasingBackInOut)
+	{
+		char message[64];
+		sprintf(message, "unknown easing type %d", easingType);
+		return fail(offset, message);
+	}
+	if (CCBIReader::hasEasingOpt(easingType) && !readFloat())
+	{
+		return false;
+	}
+
+	/*a type that is never animated has no value*/
+	const CCBIPropertyCodec *pCodec = getCCBIPropertyCodec(type);
+	return NULL == pCodec || checkValues(pCodec->fields, pCodec->numKeyframeFields);
+}
+
+bool CCBIChecker::checkValues(const char *pFields, int numFields)
+{
+	for (int i = 0; i < numFields; i++)
+	{
+		int value;
+		unsigned char byte;
+		bool ok;
+
+		switch (pFields[i])
+		{
+		case kCCBIFieldFloat:
+			ok = readFloat();
+			break;
+		case kCCBIFieldUnsigned:
+			ok = readInt(false, value);
+			break;
+		case kCCBIFieldSigned:
+			ok = readInt(true, value);
+			break;
+		case kCCBIFieldString:
+			ok = readStringIndex(value);
+			break;
+		default:
+			ok = readByte(byte);
+			break;
+		}
+
+		if (!ok)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool CCBIChecker::readInt(bool pSigned, int &value)
+{
+	size_t offset = mPos;
+	unsigned long long current = CCBIBitReader::readGamma(mBytes, mLength, mPos);
+	if (0 == current)
+	{
+		return fail(offset, mPos >= mLength ? "int runs past the end of the file" : "malformed int");
+	}
+
+	/*the reader keeps ints in 32 bits*/
+	if (pSigned ? current > 0xffffffffULL : current > 0x80000000ULL)
+	{
+		return fail(offset, "int out of range");
+	}
+
+	value = pSigned ? CCBIBitReader::toSigned(current) : CCBIBitReader::toUnsigned(current);
+	return true;
+}
+
+bool CCBIChecker::readCount(int &count)
+{
+	size_t offset = mPos;
+	if (!readInt(false, count))
+	{
+		return false;
+	}
+
+	/*every counted item takes at least one byte*/
+	if ((size_t)count > mLength - mPos)
+	{
+		char message[64];
+		sprintf(message, "count %d is larger than the rest of the file", count);
+		return fail(offset, message);
+	}
+	return true;
+}
+
+bool CCBIChecker::readByte(unsigned char &byte)
+{
+	if (mPos >= mLength)
+	{
+		return fail(mPos, "byte runs past the end of the file");
+	}
+
+	byte = mBytes[mPos++];
+	return true;
+}
+
+bool CCBIChecker::readFloat()
+{
+	size_t offset = mPos;
+	unsigned char type;
+	if (!readByte(type))
+	{
+		return false;
+	}
+
+	switch (type)
+	{
+	case kCCBIFloat0:
+	case kCCBIFloat1:
+	case kCCBIFloatMinus1:
+	case kCCBIFloat05:
+		return true;
+	case kCCBIFloatInteger:
+	{
+		int value;
+		return readInt(true, value);
+	}
+	case kCCBIFloatFull:
+		if (mLength - mPos < 4)
+		{
+			return fail(mPos, "float runs past the end of the file");
+		}
+		mPos += 4;
+		return true;
+	default:
+	{
+		char message[64];
+		sprintf(message, "unknown float type %d", type);
+		return fail(offset, message);
+	}
+	}
+}
+
+bool CCBIChecker::readStringIndex(int &index)
+{
+	size_t offset = mPos;
+	if (!readInt(false, index))
+	{
+		return false;
+	}
+
+	if (index >= mNumStrings)
+	{
+		char message[96];
+		sprintf(message, "string index %d is out of range, the cache has %d strings", index, mNumStrings);
+		return fail(offset, message);
+	}
+	return true;
+}
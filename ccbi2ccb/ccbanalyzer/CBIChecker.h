@@ -0,0 +1,80 @@
+#ifndef _CCBII_CCBIChecker_H_
+#define _CCBII_CCBIChecker_H_
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/**
+* @brief Validate a ccbi file without decoding it into a tree
+*
+* Walks the header, string cache, sequences and node graph with the same
+* gamma decoder as CCBIReader, but only keeps counters: nothing is
+* allocated per node and nothing is written. Every read is bounds checked,
+* so any input is safe to check.
+*
+* The first problem stops the walk; getErrorOffset() is the offset of the
+* field that could not be read or holds a bad value.
+*/
+class CCBIChecker
+{
+private:
+	const unsigned char *mBytes;
+	size_t mLength;
+	size_t mPos;
+	bool mJSControlled;
+	/*offset of the first string cache entry, to name strings in errors*/
+	size_t mStringCacheOffset;
+
+	int mNumStrings;
+	int mNumSequences;
+	int mNumNodes;
+	int mNumProperties;
+	int mNumKeyframes;
+
+	std::string mError;
+	size_t mErrorOffset;
+
+	/*remaining children of every open node*/
+	std::vector<int> mOpen;
+
+public:
+	CCBIChecker(const unsigned char *pBytes, size_t length);
+
+	/**
+	* @return true if the whole file is a well formed version 5 ccbi
+	*/
+	bool check();
+
+	const std::string& getError() const;
+	size_t getErrorOffset() const;
+
+	int getNumStrings() const;
+	int getNumSequences() const;
+	int getNumNodes() const;
+	int getNumProperties() const;
+	int getNumKeyframes() const;
+
+private:
+	bool fail(size_t offset, const char *pMessage);
+	std::string getString(int index) const;
+
+	bool checkHeader();
+	bool checkStringCache();
+	bool checkSequences();
+	bool checkNodeGraph();
+	bool checkNode();
+	bool checkProperty();
+	bool checkKeyframe(int type);
+
+	/*check the first numFields of a value, one kCCBIField* letter each*/
+	bool checkValues(const char *pFields, int numFields);
+
+	bool readInt(bool pSigned, int &value);
+	bool readCount(int &count);
+	bool readByte(unsigned char &byte);
+	bool readFloat();
+	bool readStringIndex(int &index);
+};
+
+#endif
@@ -0,0 +1,108 @@
+#include "CBIConverter.h"
+#include "CBIXMLEmitter.h"
+#include "CBIBinaryPlistEmitter.h"
+#include "CBIJSONEmitter.h"
+
+#include <exception>
+#include <new>
+
+using namespace std;
+
+static int failConvert(int status, const char *pMessage, string *pError)
+{
+	if (NULL != pError)
+	{
+		*pError = pMessage;
+	}
+	return status;
+}
+
+/*************************************************************************
+Implementation of CCBIBufferSink
+*************************************************************************/
+bool CCBIBufferSink::write(const char *pBytes, size_t length)
+{
+	bytes.insert(bytes.end(), pBytes, pBytes + length);
+	return true;
+}
+
+/*************************************************************************
+Implementation of the conversion
+*************************************************************************/
+void emitCCBITree(const CCBITree &tree, size_t inputLength, const CCBIConvertOptions &options,
+	CCBIPlistWriter &writer)
+{
+	if (kCCBIFormatBinary == options.format)
+	{
+		CCBIBinaryPlistWriter plist;
+		CCBIBinaryPlistEmitter emitter(tree, plist);
+		emitter.emit();
+
+		writer.reserve(inputLength * CCBIBinaryPlistEmitter::kOutputSizeRatio);
+		plist.serialize(writer);
+	}
+	else if (kCCBIFormatJSON == options.format)
+	{
+		writer.reserve(inputLength * CCBIJSONEmitter::kOutputSizeRatio);
+
+		CCBIJSONEmitter emitter(tree, writer);
+		emitter.emit();
+	}
+	else
+	{
+		writer.reserve(inputLength * CCBIXMLEmitter::kOutputSizeRatio);
+
+		CCBIXMLEmitter emitter(tree, writer);
+		emitter.setNumThreads(options.numThreads);
+		emitter.emit();
+	}
+}
+
+int convertCCBI(const unsigned char *pBytes, size_t length, CCBIOutputSink &sink,
+	const CCBIConvertOptions &options, string *pError)
+{
+	if (options.format < kCCBIFormatXML || options.format > kCCBIFormatJSON
+		|| options.numThreads < 0 || options.maxDepth < 1)
+	{
+		return failConvert(kCCBIConvertBadOptions, "an option is out of range", pError);
+	}
+	if (NULL == pBytes && 0 != length)
+	{
+		return failConvert(kCCBIConvertBadOptions, "no input bytes", pError);
+	}
+
+	/*allocation failures surface as bad_alloc from the tree, the buffers and the emitters*/
+	try
+	{
+		CCBIReader ccbir(pBytes, length);
+		ccbir.setMaxDepth(options.maxDepth);
+		if (!ccbir.readHeader() || !ccbir.readStringCache() || !ccbir.readSequences()
+			|| !ccbir.readNodeGraph())
+		{
+			if (NULL != pError)
+			{
+				*pError = ccbir.describeError();
+			}
+			return kCCBIConvertBadInput;
+		}
+
+		CCBIPlistWriter writer;
+		emitCCBITree(ccbir.getTree(), length, options, writer);
+
+		if (!sink.write(writer.getBytes(), writer.getSize()))
+		{
+			return failConvert(kCCBIConvertSinkFailed, "the sink refused the output", pError);
+		}
+	}
+	catch (const bad_alloc&)
+	{
+		return failConvert(kCCBIConvertOutOfMemory, "out of memory", pError);
+	}
+	catch (const exception &e)
+	{
+		/*std::thread throws system_error when a worker can not start*/
+		return failConvert(kCCBIConvertFailed, e.what(), pError);
+	}
+
+	return kCCBIConvertOK;
+}
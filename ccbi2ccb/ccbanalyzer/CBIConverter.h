@@ -0,0 +1,89 @@
+#ifndef _CCBII_CCBIConverter_H_
+#define _CCBII_CCBIConverter_H_
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "CBIReader.h"
+#include "CBIPlistWriter.h"
+
+enum {
+	kCCBIFormatXML = 0,
+	kCCBIFormatBinary,
+	kCCBIFormatJSON
+};
+
+/*status of convertCCBI()*/
+enum {
+	kCCBIConvertOK = 0,
+	/*an option is out of range*/
+	kCCBIConvertBadOptions,
+	/*the input is not a ccbi the reader accepts*/
+	kCCBIConvertBadInput,
+	kCCBIConvertOutOfMemory,
+	/*the sink refused the output*/
+	kCCBIConvertSinkFailed,
+	/*anything else, e.g. a worker thread could not be started*/
+	kCCBIConvertFailed
+};
+
+/**
+* @brief How a ccbi file is converted
+*/
+struct CCBIConvertOptions
+{
+	/*kCCBIFormatXML, kCCBIFormatBinary (bplist00) or kCCBIFormatJSON*/
+	int format;
+	/*threads writing the xml node graph of the file, 0 for one per core*/
+	int numThreads;
+	/*deepest node graph accepted, see CCBIReader::setMaxDepth()*/
+	int maxDepth;
+
+	CCBIConvertOptions() : format(kCCBIFormatXML), numThreads(1), maxDepth(kCCBIDefaultMaxDepth) {}
+};
+
+/**
+* @brief Receiver of the output of convertCCBI()
+*/
+class CCBIOutputSink
+{
+public:
+	virtual ~CCBIOutputSink() {}
+
+	/*false to stop the conversion*/
+	virtual bool write(const char *pBytes, size_t length) = 0;
+};
+
+/**
+* @brief Sink keeping the output in memory
+*/
+class CCBIBufferSink : public CCBIOutputSink
+{
+public:
+	std::vector<char> bytes;
+
+	virtual bool write(const char *pBytes, size_t length);
+};
+
+/**
+* @brief Convert a ccbi in memory into a ccb plist, or its json
+*
+* Touches no file and keeps no state between calls: any number of
+* conversions can run at once on different threads, each with its own
+* sink. Nothing is handed to the sink unless the whole input decodes.
+* @param pError if not NULL, set to the reason when the status is not kCCBIConvertOK
+* @return kCCBIConvertOK or the kCCBIConvert* status of the failure
+*/
+int convertCCBI(const unsigned char *pBytes, size_t length, CCBIOutputSink &sink,
+	const CCBIConvertOptions &options = CCBIConvertOptions(), std::string *pError = NULL);
+
+/**
+* @brief Write a decoded tree into writer in options.format
+* @param inputLength size of the ccbi, to reserve the output up front
+*/
+void emitCCBITree(const CCBITree &tree, size_t inputLength, const CCBIConvertOptions &options,
+	CCBIPlistWriter &writer);
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef _CCBII_CCBIEscapeScanner_H_
+#define _CCBII_CCBIEscapeScanner_H_
+
+#include <stddef.h>
+#include <vector>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define CCBI_ESCAPE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/*the bytes equal to one of Marks, tested one mark after the other at compile time*/
+template <char... Marks>
+struct CCBIMarkSet
+{
+	static bool contains(unsigned char)
+	{
+		return false;
+	}
+
+#ifdef CCBI_ESCAPE_SSE2
+	static __m128i match(__m128i)
+	{
+		return _mm_setzero_si128();
+	}
+#endif
+};
+
+template <char Mark, char... Rest>
+struct CCBIMarkSet<Mark, Rest...>
+{
+	static bool contains(unsigned char c)
+	{
+		return (unsigned char)Mark == c || CCBIMarkSet<Rest...>::contains(c);
+	}
+
+#ifdef CCBI_ESCAPE_SSE2
+	static __m128i match(__m128i chunk)
+	{
+		return _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(Mark)), CCBIMarkSet<Rest...>::match(chunk));
+	}
+#endif
+};
+
+/**
+* @brief Output of CCBIEscapeScanner::escape() appending to a byte vector
+*/
+struct CCBIVectorOutput
+{
+	std::vector<char> &bytes;
+
+	explicit CCBIVectorOutput(std::vector<char> &out) : bytes(out) {}
+
+	void write(const char *pBytes, size_t length)
+	{
+		bytes.insert(bytes.end(), pBytes, pBytes + length);
+	}
+
+private:
+	CCBIVectorOutput& operator=(const CCBIVectorOutput&);
+};
+
+/**
+* @brief The escape loop of the xml and json strings, 16 bytes at a time
+*
+* The special bytes are the C0 controls, every non-ASCII byte (its UTF-8
+* sequence has to be validated) and the Marks of the format. The clean runs
+* between them are copied as they are, what a special byte becomes is up
+* to the Escaper of the format.
+*/
+template <char... Marks>
+class CCBIEscapeScanner
+{
+private:
+	CCBIEscapeScanner();
+
+public:
+	static bool isSpecial(unsigned char c)
+	{
+		return c < 0x20 || c >= 0x80 || CCBIMarkSet<Marks...>::contains(c);
+	}
+
+	/**
+	* @return the offset of the first special byte, or length
+	*/
+	static size_t findFirstSpecial(const char *pString, size_t length)
+	{
+		size_t i = 0;
+
+#ifdef CCBI_ESCAPE_SSE2
+		const __m128i control = _mm_set1_epi8(0x1f);
+
+		for (; i + 16 <= length; i += 16)
+		{
+			__m128i chunk = _mm_loadu_si128((const __m128i*)(pString + i));
+
+			/*unsigned c <= 0x1f is max(c, 0x1f) == 0x1f*/
+			__m128i hits = _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control);
+			hits = _mm_or_si128(hits, CCBIMarkSet<Marks...>::match(chunk));
+
+			/*the sign bits are the non-ASCII bytes*/
+			int mask = _mm_movemask_epi8(hits) | _mm_movemask_epi8(chunk);
+			if (0 != mask)
+			{
+#ifdef _MSC_VER
+				unsigned long bit;
+				_BitScanForward(&bit, (unsigned long)mask);
+				return i + bit;
+#else
+				return i + __builtin_ctz(mask);
+#endif
+			}
+		}
+#endif
+
+		for (; i < length; i++)
+		{
+			if (isSpecial((unsigned char)pString[i]))
+			{
+				return i;
+			}
+		}
+
+		return length;
+	}
+
+	/**
+	* @brief Write pString to out, each special byte replaced by its escape
+	* @param out anything with a write(const char *pBytes, size_t length)
+	*
+	* Escaper::escapeSpecial(pString, length, pos, pText) writes the escape of
+	* the special byte at pos, or of the UTF-8 sequence it starts, into pText
+	* (at most Escaper::kMaxEscapeLength chars), moves pos past it and
+	* returns its length.
+	*/
+	template <typename Escaper, typename Output>
+	static void escape(const char *pString, size_t length, Output &out)
+	{
+		size_t i = 0;
+		while (i < length)
+		{
+			/*copy the clean run in one go, then handle the special byte*/
+			size_t special = i + findFirstSpecial(pString + i, length - i);
+			out.write(pString + i, special - i);
+			if (special == length)
+			{
+				break;
+			}
+
+			char text[Escaper::kMaxEscapeLength];
+			i = special;
+			out.write(text, Escaper::escapeSpecial(pString, length, i, text));
+		}
+	}
+};
+
+#endif
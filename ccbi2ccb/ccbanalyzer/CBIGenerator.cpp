@@ -0,0 +1,489 @@
+#include "CBIGenerator.h"
+#include "CBIPropertyCodec.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace std;
+
+/*the name CocosBuilder gives a property of each type*/
+static const char *kPropertyNames[kCCBIPropTypeMAX] =
+{
+	"position", "contentSize", "anchorPoint", "gravity", "scale", "rotation", "tag",
+	"speed", "life", "visible", "displayFrame", "texture", "opacity", "color",
+	"startColor", "flip", "blendFunc", "fntFile", "string", "fontName",
+	"horizontalAlignment", "block", "animation", "ccbFile", "title", "ccControl",
+	"fontSize", "skew"
+};
+
+static const char *kClassNames[] =
+{
+	"CCNode", "CCLayer", "CCLayerColor", "CCSprite", "CCScale9Sprite", "CCLabelTTF",
+	"CCLabelBMFont", "CCMenu", "CCMenuItemImage", "CCControlButton",
+	"CCParticleSystemQuad", "CCBFile"
+};
+static const int kNumClassNames = sizeof(kClassNames) / sizeof(kClassNames[0]);
+
+static const int kNumCallbackNames = 4;
+static const int kNumSoundNames = 4;
+
+/*************************************************************************
+Implementation of CCBIGeneratorOptions
+*************************************************************************/
+CCBIGeneratorOptions::CCBIGeneratorOptions()
+: numNodes(1000)
+, maxDepth(8)
+, fanOut(4)
+, propertiesPerNode(6)
+, numStrings(256)
+, numSequences(2)
+, callbacksPerSequence(2)
+, soundsPerSequence(1)
+, animatedPercent(20)
+, animatedPropertiesPerSequence(2)
+, keyframesPerProperty(4)
+, jsControlled(false)
+, seed(1)
+{
+	/*a sub ccbi would have to exist to convert the file with --resolve*/
+	for (int i = 0; i < kCCBIPropTypeMAX; i++)
+	{
+		typeWeights[i] = kCCBIPropTypeCCBIFile == i ? 0 : 1;
+	}
+}
+
+/*************************************************************************
+Implementation of CCBIGenerator
+*************************************************************************/
+CCBIGenerator::CCBIGenerator(const CCBIGeneratorOptions &options, CCBITree &tree)
+: mOptions(options)
+, mTree(tree)
+, mRandom(options.seed)
+, mFirstClassName(0)
+, mFirstPropertyName(0)
+, mFirstSequenceName(0)
+, mFirstCallbackName(0)
+, mFirstSoundName(0)
+, mFirstFiller(0)
+{
+}
+
+const std::string& CCBIGenerator::getError() const
+{
+	return mError;
+}
+
+bool CCBIGenerator::fail(const char *pMessage)
+{
+	mError = pMessage;
+	return false;
+}
+
+unsigned int CCBIGenerator::nextRandom()
+{
+	/*xorshift32, it must not start from 0*/
+	if (0 == mRandom)
+	{
+		mRandom = 0x9e3779b9u;
+	}
+	mRandom ^= mRandom << 13;
+	mRandom ^= mRandom >> 17;
+	mRandom ^= mRandom << 5;
+	return mRandom;
+}
+
+int CCBIGenerator::randomInt(int count)
+{
+	return (int)(nextRandom() % (unsigned int)count);
+}
+
+float CCBIGenerator::randomFloat()
+{
+	/*about as often as each encoding shows up in published files*/
+	int r = randomInt(100);
+	if (r < 20)
+	{
+		return 0;
+	}
+	if (r < 30)
+	{
+		return 1;
+	}
+	if (r < 35)
+	{
+		return -1;
+	}
+	if (r < 40)
+	{
+		return 0.5f;
+	}
+	if (r < 70)
+	{
+		return (float)(randomInt(2001) - 1000);
+	}
+	return (float)(randomInt(200001) - 100000) / 64.0f;
+}
+
+int CCBIGenerator::randomFiller()
+{
+	int count = (int)mStrings.size() - mFirstFiller;
+	return 0 == count ? randomInt((int)mStrings.size()) : mFirstFiller + randomInt(count);
+}
+
+int CCBIGenerator::intern(const char *pString)
+{
+	CCBIString string;
+	string.offset = (unsigned int)mStringBytes.size();
+	string.length = (unsigned int)strlen(pString);
+	mStringBytes.insert(mStringBytes.end(), pString, pString + string.length);
+	mStrings.push_back(string);
+	return (int)mStrings.size() - 1;
+}
+
+void CCBIGenerator::makeStrings()
+{
+	char name[64];
+	mStringBytes.clear();
+	mStrings.clear();
+
+	mFirstClassName = (int)mStrings.size();
+	for (int i = 0; i < kNumClassNames; i++)
+	{
+		intern(kClassNames[i]);
+	}
+
+	mFirstPropertyName = (int)mStrings.size();
+	for (int i = 0; i < kCCBIPropTypeMAX; i++)
+	{
+		intern(kPropertyNames[i]);
+	}
+
+	mFirstSequenceName = (int)mStrings.size();
+	for (int i = 0; i < mOptions.numSequences; i++)
+	{
+		sprintf(name, "Sequence %d", i);
+		intern(name);
+	}
+
+	mFirstCallbackName = (int)mStrings.size();
+	for (int i = 0; i < kNumCallbackNames; i++)
+	{
+		sprintf(name, "onCallback%d", i);
+		intern(name);
+	}
+
+	mFirstSoundName = (int)mStrings.size();
+	for (int i = 0; i < kNumSoundNames; i++)
+	{
+		sprintf(name, "sounds/effect%d.mp3", i);
+		intern(name);
+	}
+
+	mFirstFiller = (int)mStrings.size();
+	for (int i = mFirstFiller; i < mOptions.numStrings; i++)
+	{
+		sprintf(name, "res/gen/s%06d.png", i);
+		intern(name);
+	}
+
+	/*the bytes go to the tree's arena, like the ones of a published tree*/
+	char *pBytes = (char*)mTree.getArena().alloc(mStringBytes.empty() ? 1 : mStringBytes.size(), 1);
+	if (!mStringBytes.empty())
+	{
+		memcpy(pBytes, &mStringBytes[0], mStringBytes.size());
+	}
+	mTree.stringBase = pBytes;
+	mTree.strings.reserve((int)mStrings.size());
+	for (size_t i = 0; i < mStrings.size(); i++)
+	{
+		mTree.strings.push_back(mStrings[i]);
+	}
+}
+
+bool CCBIGenerator::makeShape(std::vector<int> &parents)
+{
+	int numNodes = mOptions.numNodes;
+
+	/*hand out the nodes level by level, the children of a node are contiguous*/
+	vector<int> levelParents(1, -1);
+	vector<int> depths(1, 1);
+	vector<int> firstChildren;
+	vector<int> numChildren;
+	levelParents.reserve(numNodes);
+	depths.reserve(numNodes);
+	firstChildren.reserve(numNodes);
+	numChildren.reserve(numNodes);
+
+	for (int i = 0; i < (int)levelParents.size(); i++)
+	{
+		int count = 0;
+		if (depths[i] < mOptions.maxDepth)
+		{
+			count = numNodes - (int)levelParents.size();
+			count = count < mOptions.fanOut ? count : mOptions.fanOut;
+		}
+
+		firstChildren.push_back((int)levelParents.size());
+		numChildren.push_back(count);
+		for (int c = 0; c < count; c++)
+		{
+			levelParents.push_back(i);
+			depths.push_back(depths[i] + 1);
+		}
+	}
+
+	if ((int)levelParents.size() < numNodes)
+	{
+		return fail("the depth and fan out leave no room for that many nodes");
+	}
+
+	/*then number them in pre-order*/
+	vector<int> preOrder(numNodes);
+	vector<int> stack(1, 0);
+	parents.resize(numNodes);
+	int next = 0;
+	while (!stack.empty())
+	{
+		int i = stack.back();
+		stack.pop_back();
+
+		preOrder[i] = next;
+		parents[next] = -1 == levelParents[i] ? -1 : preOrder[levelParents[i]];
+		next++;
+
+		for (int c = numChildren[i] - 1; c >= 0; c--)
+		{
+			stack.push_back(firstChildren[i] + c);
+		}
+	}
+
+	return true;
+}
+
+void CCBIGenerator::makeSequences()
+{
+	int numSequences = mOptions.numSequences;
+	mTree.sequences.reserve(numSequences);
+
+	for (int i = 0; i < numSequences; i++)
+	{
+		CCBISequence sequence;
+		sequence.duration = (float)(1 + randomInt(10));
+		sequence.nameIndex = mFirstSequenceName + i;
+		sequence.sequenceId = i;
+		sequence.chainedSequenceId = i + 1 < numSequences && 0 == randomInt(2) ? i + 1 : -1;
+
+		sequence.firstCallbackKeyframe = mTree.callbackKeyframes.size();
+		sequence.numCallbackKeyframes = mOptions.callbacksPerSequence;
+		for (int k = 0; k < sequence.numCallbackKeyframes; k++)
+		{
+			CCBICallbackKeyframe keyframe;
+			keyframe.time = sequence.duration * (k + 1) / (sequence.numCallbackKeyframes + 1);
+			keyframe.nameIndex = mFirstCallbackName + randomInt(kNumCallbackNames);
+			keyframe.callbackType = 1 + randomInt(2);
+			mTree.callbackKeyframes.push_back(keyframe);
+		}
+
+		sequence.firstSoundKeyframe = mTree.soundKeyframes.size();
+		sequence.numSoundKeyframes = mOptions.soundsPerSequence;
+		for (int k = 0; k < sequence.numSoundKeyframes; k++)
+		{
+			CCBISoundKeyframe keyframe;
+			keyframe.time = sequence.duration * k / sequence.numSoundKeyframes;
+			keyframe.fileIndex = mFirstSoundName + randomInt(kNumSoundNames);
+			keyframe.pitch = 1;
+			keyframe.pan = 0;
+			keyframe.gain = 0.5f;
+			mTree.soundKeyframes.push_back(keyframe);
+		}
+
+		mTree.sequences.push_back(sequence);
+	}
+
+	mTree.autoPlaySequenceId = 0 == numSequences ? -1 : 0;
+}
+
+void CCBIGenerator::pushValues(const char *pFields, int numFields)
+{
+	for (int i = 0; i < numFields; i++)
+	{
+		CCBIValue value;
+		switch (pFields[i])
+		{
+		case kCCBIFieldFloat:
+			value.f = randomFloat();
+			break;
+		case kCCBIFieldUnsigned:
+			value.i = randomInt(4);
+			break;
+		case kCCBIFieldSigned:
+			value.i = randomInt(201) - 100;
+			break;
+		case kCCBIFieldByte:
+			value.i = randomInt(256);
+			break;
+		case kCCBIFieldBool:
+			value.i = randomInt(2);
+			break;
+		default:
+			value.i = randomFiller();
+			break;
+		}
+		mTree.values.push_back(value);
+	}
+}
+
+void CCBIGenerator::makeProperty(int type, CCBIProperty &property)
+{
+	property.type = type;
+	property.nameIndex = mFirstPropertyName + type;
+	property.platform = 0 == randomInt(10) ? 1 + randomInt(2) : kCCBIPlatformAll;
+	property.firstValue = mTree.values.size();
+	pushValues(kCCBIPropertyCodecs[type].fields, kCCBIPropertyCodecs[type].numFields);
+	property.numValues = mTree.values.size() - property.firstValue;
+}
+
+void CCBIGenerator::makeAnimatedProperties(CCBINode &node)
+{
+	node.numAnimatedSequences = 0;
+	node.firstAnimatedProperty = mTree.animatedProperties.size();
+	node.numAnimatedProperties = 0;
+	node.firstEmptySequence = mTree.emptySequenceIds.size();
+	node.numEmptySequences = 0;
+
+	if (mAnimatedTypes.empty() || randomInt(100) >= mOptions.animatedPercent)
+	{
+		return;
+	}
+
+	/*the writer keeps the properties of a sequence together*/
+	for (int s = 0; s < mTree.sequences.size(); s++)
+	{
+		const CCBISequence &sequence = mTree.sequences[s];
+		int numTypes = (int)mAnimatedTypes.size();
+		int first = randomInt(numTypes);
+		int count = mOptions.animatedPropertiesPerSequence < numTypes ? mOptions.animatedPropertiesPerSequence : numTypes;
+		if (0 == count)
+		{
+			continue;
+		}
+
+		node.numAnimatedSequences++;
+		for (int p = 0; p < count; p++)
+		{
+			CCBIAnimatedProperty animatedProp;
+			animatedProp.sequenceId = sequence.sequenceId;
+			animatedProp.type = mAnimatedTypes[(first + p) % numTypes];
+			animatedProp.nameIndex = mFirstPropertyName + animatedProp.type;
+			animatedProp.firstKeyframe = mTree.keyframes.size();
+			animatedProp.numKeyframes = mOptions.keyframesPerProperty;
+
+			for (int k = 0; k < animatedProp.numKeyframes; k++)
+			{
+				CCBIKeyframe keyframe;
+				keyframe.time = animatedProp.numKeyframes < 2 ? 0 : sequence.duration * k / (animatedProp.numKeyframes - 1);
+				keyframe.easingType = randomInt(kCCBIKeyframeEasingBackInOut + 1);
+				keyframe.easingOpt = CCBIReader::hasEasingOpt(keyframe.easingType) ? randomFloat() : 0;
+				keyframe.firstValue = mTree.values.size();
+
+				const CCBIPropertyCodec &codec = kCCBIPropertyCodecs[animatedProp.type];
+				pushValues(codec.fields, codec.numKeyframeFields);
+				keyframe.numValues = mTree.values.size() - keyframe.firstValue;
+				mTree.keyframes.push_back(keyframe);
+			}
+
+			mTree.animatedProperties.push_back(animatedProp);
+			node.numAnimatedProperties++;
+		}
+	}
+}
+
+void CCBIGenerator::makeNode(int index, int parent)
+{
+	CCBINode node;
+	node.parent = parent;
+	node.subtreeEnd = index + 1;
+	node.numChildren = 0;
+
+	node.classNameIndex = mFirstClassName + (0 == index ? 0 : randomInt(kNumClassNames));
+	node.jsControlledNameIndex = mTree.header.jsControlled ? randomFiller() : -1;
+	node.memberVarAssignmentType = 0 == randomInt(4) ? kCCBITargetTypeDocumentRoot + randomInt(2) : kCCBITargetTypeNone;
+	node.memberVarAssignmentNameIndex = kCCBITargetTypeNone == node.memberVarAssignmentType ? -1 : randomFiller();
+
+	makeAnimatedProperties(node);
+
+	node.firstProperty = mTree.properties.size();
+	node.numProperties = mTypes.empty() ? 0 : mOptions.propertiesPerNode;
+	node.numExtraProperties = 0;
+	for (int p = 0; p < node.numProperties; p++)
+	{
+		CCBIProperty property;
+		makeProperty(mTypes[randomInt((int)mTypes.size())], property);
+		mTree.properties.push_back(property);
+	}
+
+	mTree.nodes[index] = node;
+}
+
+bool CCBIGenerator::generate()
+{
+	if (mOptions.numNodes < 1 || mOptions.maxDepth < 1 || mOptions.fanOut < 0)
+	{
+		return fail("a graph needs a root node");
+	}
+	if (mOptions.numSequences < 0 || mOptions.propertiesPerNode < 0 || mOptions.keyframesPerProperty < 0
+		|| mOptions.callbacksPerSequence < 0 || mOptions.soundsPerSequence < 0 || mOptions.animatedPropertiesPerSequence < 0)
+	{
+		return fail("counts can not be negative");
+	}
+
+	mTypes.clear();
+	mAnimatedTypes.clear();
+	for (int i = 0; i < kCCBIPropTypeMAX; i++)
+	{
+		mTypes.insert(mTypes.end(), mOptions.typeWeights[i] > 0 ? mOptions.typeWeights[i] : 0, i);
+		if (CCBIMainPropTypeName::getAnimatedPropTypeValue(i) >= 0 && mOptions.typeWeights[i] > 0)
+		{
+			mAnimatedTypes.push_back(i);
+		}
+	}
+	if (mTypes.empty() && 0 != mOptions.propertiesPerNode)
+	{
+		return fail("every property type has a weight of 0");
+	}
+
+	vector<int> parents;
+	if (!makeShape(parents))
+	{
+		return false;
+	}
+
+	mTree.clear();
+	mTree.header.version = kCCBIVersion;
+	mTree.header.jsControlled = mOptions.jsControlled;
+
+	makeStrings();
+	makeSequences();
+
+	int numNodes = mOptions.numNodes;
+	mTree.nodes.append(numNodes);
+	mTree.properties.reserve(numNodes * mOptions.propertiesPerNode);
+	mTree.values.reserve(numNodes * mOptions.propertiesPerNode * 2);
+	for (int i = 0; i < numNodes; i++)
+	{
+		makeNode(i, parents[i]);
+	}
+
+	/*a subtree is contiguous in pre-order, so it ends where its last node's ends*/
+	for (int i = numNodes - 1; i > 0; i--)
+	{
+		CCBINode &parent = mTree.nodes[parents[i]];
+		parent.numChildren++;
+		if (mTree.nodes[i].subtreeEnd > parent.subtreeEnd)
+		{
+			parent.subtreeEnd = mTree.nodes[i].subtreeEnd;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,111 @@
+#ifndef _CCBII_CCBIGenerator_H_
+#define _CCBII_CCBIGenerator_H_
+
+#include <string>
+#include <vector>
+
+#include "CBIReader.h"
+#include "CBITree.h"
+
+/**
+* @brief Shape and content of a generated ccbi, see CCBIGenerator
+*/
+struct CCBIGeneratorOptions
+{
+	/*nodes of the graph, the root included*/
+	int numNodes;
+	/*levels of the graph, 1 is the root alone*/
+	int maxDepth;
+	/*children of every node but the last ones of the deepest levels*/
+	int fanOut;
+
+	int propertiesPerNode;
+	/*relative frequency of each kCCBIPropType* among the properties*/
+	int typeWeights[kCCBIPropTypeMAX];
+
+	/*entries of the string cache, at least the names the file needs*/
+	int numStrings;
+
+	int numSequences;
+	int callbacksPerSequence;
+	int soundsPerSequence;
+	/*percent of the nodes with animated properties in every sequence*/
+	int animatedPercent;
+	int animatedPropertiesPerSequence;
+	int keyframesPerProperty;
+
+	bool jsControlled;
+	unsigned int seed;
+
+	CCBIGeneratorOptions();
+};
+
+/**
+* @brief Build a random but valid ccbi tree, to test the converter at scale
+*
+* The nodes are handed out level by level, fanOut children each while the
+* depth allows, so numNodes, maxDepth and fanOut give anything from a full
+* tree to a single chain; the graph is then laid out in pre-order. Every
+* value is drawn with the encodings CCBIReader decodes, and the same seed
+* gives the same tree.
+*
+* Encode the tree with CCBIWriter::writeTree().
+*/
+class CCBIGenerator
+{
+private:
+	const CCBIGeneratorOptions &mOptions;
+	CCBITree &mTree;
+	std::string mError;
+	unsigned int mRandom;
+
+	std::vector<char> mStringBytes;
+	std::vector<CCBIString> mStrings;
+	int mFirstClassName;
+	int mFirstPropertyName;
+	int mFirstSequenceName;
+	int mFirstCallbackName;
+	int mFirstSoundName;
+	/*strings only values and member names use, after the names*/
+	int mFirstFiller;
+
+	/*the types properties are drawn from, one entry per unit of weight*/
+	std::vector<int> mTypes;
+	std::vector<int> mAnimatedTypes;
+
+public:
+	CCBIGenerator(const CCBIGeneratorOptions &options, CCBITree &tree);
+
+	/**
+	* @brief Fill the tree
+	* @return false if the options can not make a tree, see getError()
+	*/
+	bool generate();
+
+	const std::string& getError() const;
+
+private:
+	bool fail(const char *pMessage);
+
+	unsigned int nextRandom();
+	/*uniform in [0, count)*/
+	int randomInt(int count);
+	/*a float of a random kCCBIFloat* encoding*/
+	float randomFloat();
+	int randomFiller();
+
+	int intern(const char *pString);
+	void makeStrings();
+
+	/*parent of every node in pre-order, -1 for the root*/
+	bool makeShape(std::vector<int> &parents);
+
+	void makeSequences();
+	void makeNode(int index, int parent);
+	void makeAnimatedProperties(CCBINode &node);
+	void makeProperty(int type, CCBIProperty &property);
+	/*push a random value for each of the first numFields kCCBIField* letters*/
+	void pushValues(const char *pFields, int numFields);
+};
+
+#endif
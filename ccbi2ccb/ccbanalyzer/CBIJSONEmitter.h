@@ -0,0 +1,81 @@
+#ifndef _CCBII_CCBIJSONEmitter_H_
+#define _CCBII_CCBIJSONEmitter_H_
+
+#include "CBITree.h"
+#include "CBIPlistWriter.h"
+#include "CBIJSONWriter.h"
+#include "CBIJSONStringTable.h"
+
+/**
+* @brief Write a decoded CCBITree as json
+*
+* Builds the same document as CCBIBinaryPlistEmitter, with dicts as
+* objects: the header, sequences and nodeGraph, each node with its
+* properties, animatedProperties and children. Where the xml writes a key
+* without a value, the key is left out.
+*
+* The string cache is escaped and quoted once, and the reals have the
+* shortest round-trip text of CCBIRealFormat like the xml ones.
+*/
+class CCBIJSONEmitter
+{
+private:
+	const CCBITree &mTree;
+	CCBIJSONWriter mWriter;
+	CCBIJSONStringTable mStrings;
+
+public:
+	/*a compact json is about a third of the size of the xml plist*/
+	static const size_t kOutputSizeRatio = 16;
+
+	CCBIJSONEmitter(const CCBITree &tree, CCBIPlistWriter &writer);
+
+	/**
+	* @brief Write the whole document
+	*/
+	void emit();
+
+	/**
+	* @brief Write the document around a node graph written by the caller,
+	* like CCBIXMLEmitter::emitStart() and emitEnd()
+	*/
+	void emitStart();
+	void emitEnd();
+
+	/**
+	* @brief Write a document of selected parts instead of the ccb, like
+	* CCBIXMLEmitter::emitSelectionStart()
+	*/
+	void emitSelectionStart();
+	void writeSelectedNodesStart();
+	void writeSelectedNodesEnd();
+
+	/*everything of a node up to and including the children array start*/
+	void writeNodeStart(int index);
+	void writeNodeEnd(int index);
+
+	void writeHeader();
+	void writeSequences();
+	void writeNodeGraph();
+
+	/**
+	* @brief Write the nodes of the subtree [first, end) in pre-order
+	*/
+	void writeNodes(int first, int end);
+
+private:
+	void writeChannel(const char *pName, int type);
+	void writeAnimatedProperties(const CCBINode &node);
+	void writeKeyframe(const CCBIAnimatedProperty &animatedProp, const CCBIKeyframe &keyframe);
+	void writeProperty(const CCBIProperty &property);
+
+	void writeCachedString(int index);
+	void writeCachedKey(int index);
+
+	void writeResolutions();
+
+	CCBIJSONEmitter(const CCBIJSONEmitter&);
+	CCBIJSONEmitter& operator=(const CCBIJSONEmitter&);
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "CBIJSONStringTable.h"
+#include "CBIUTF8.h"
+
+#include <string.h>
+
+using namespace std;
+
+static const char kHexDigits[] = "0123456789abcdef";
+
+/*************************************************************************
+Implementation of CCBIJSONStringTable
+*************************************************************************/
+CCBIJSONStringTable::CCBIJSONStringTable()
+{
+}
+
+void CCBIJSONStringTable::build(const CCBITree &tree)
+{
+	int count = tree.strings.size();
+
+	size_t total = 0;
+	for (int i = 0; i < count; i++)
+	{
+		total += tree.strings[i].length + 2;
+	}
+
+	mBytes.clear();
+	mBytes.reserve(total);
+	mOffsets.resize(count + 1);
+
+	CCBIVectorOutput output(mBytes);
+	for (int i = 0; i < count; i++)
+	{
+		CCBIStringView string = tree.getString(i);
+
+		mOffsets[i] = mBytes.size();
+		mBytes.push_back('"');
+		escape(string.pChars, string.length, output);
+		mBytes.push_back('"');
+	}
+	mOffsets[count] = mBytes.size();
+}
+
+const char* CCBIJSONStringTable::getFragment(int index, size_t &length) const
+{
+	length = mOffsets[index + 1] - mOffsets[index];
+	return &mBytes[0] + mOffsets[index];
+}
+
+int CCBIJSONStringTable::escapeChar(unsigned char c, char *pText)
+{
+	pText[0] = '\\';
+	switch (c)
+	{
+	case '"':
+	case '\\':
+		pText[1] = (char)c;
+		return 2;
+	case '\n':
+		pText[1] = 'n';
+		return 2;
+	case '\r':
+		pText[1] = 'r';
+		return 2;
+	case '\t':
+		pText[1] = 't';
+		return 2;
+	case '\b':
+		pText[1] = 'b';
+		return 2;
+	case '\f':
+		pText[1] = 'f';
+		return 2;
+	default:
+		memcpy(pText + 1, "u00", 3);
+		pText[4] = kHexDigits[c >> 4];
+		pText[5] = kHexDigits[c & 0xf];
+		return kMaxEscapeLength;
+	}
+}
+
+int CCBIJSONStringTable::escapeSpecial(const char *pString, size_t length, size_t &pos, char *pText)
+{
+	unsigned char c = (unsigned char)pString[pos];
+	if (c < 0x80)
+	{
+		pos++;
+		return escapeChar(c, pText);
+	}
+
+	/*a valid sequence is copied, anything else becomes U+FFFD like in a bplist*/
+	size_t start = pos;
+	if (kCCBIReplacementChar == CCBIUTF8::decode((const unsigned char*)pString, length, pos))
+	{
+		memcpy(pText, "\xef\xbf\xbd", 3);
+		return 3;
+	}
+	memcpy(pText, pString + start, pos - start);
+	return (int)(pos - start);
+}
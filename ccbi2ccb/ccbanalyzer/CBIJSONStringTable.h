@@ -0,0 +1,63 @@
+#ifndef _CCBII_CCBIJSONStringTable_H_
+#define _CCBII_CCBIJSONStringTable_H_
+
+#include <stddef.h>
+#include <vector>
+
+#include "CBITree.h"
+#include "CBIEscapeScanner.h"
+
+/**
+* @brief The string cache of a tree, escaped and quoted as json once
+*
+* Every entry is turned into its final "\"...\"" bytes up front, so each
+* use is a plain copy however often the entry is written. '"' and '\\'
+* are escaped with a backslash, the control characters as \n, \r, \t, \b,
+* \f or \u00XX. Valid UTF-8 is copied as it is, every broken sequence
+* becomes U+FFFD.
+*/
+class CCBIJSONStringTable
+{
+private:
+	std::vector<char> mBytes;
+	/*start of entry i's fragment, plus one entry for the end*/
+	std::vector<size_t> mOffsets;
+
+public:
+	/*the longest escape of one byte, \u00XX, longer than any UTF-8 sequence*/
+	static const int kMaxEscapeLength = 6;
+
+	CCBIJSONStringTable();
+
+	void build(const CCBITree &tree);
+
+	/**
+	* @brief The quoted fragment of entry index
+	*/
+	const char* getFragment(int index, size_t &length) const;
+
+	/**
+	* @brief Write pString escaped for a json string to out, without the quotes
+	* @param out anything with a write(const char *pBytes, size_t length)
+	*/
+	template <typename Output>
+	static void escape(const char *pString, size_t length, Output &out)
+	{
+		CCBIEscapeScanner<'"', '\\'>::escape<CCBIJSONStringTable>(pString, length, out);
+	}
+
+	/**
+	* @brief Write the escape of the special byte c into pText
+	* @return its length, at most kMaxEscapeLength
+	*/
+	static int escapeChar(unsigned char c, char *pText);
+
+	/**
+	* @brief Write the escape of the special byte at pos, or the UTF-8 sequence
+	* it starts, into pText and move pos past it
+	* @return its length, at most kMaxEscapeLength
+	*/
+	static int escapeSpecial(const char *pString, size_t length, size_t &pos, char *pText);
+};
+
+#endif
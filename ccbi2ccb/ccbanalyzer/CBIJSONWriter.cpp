@@ -0,0 +1,123 @@
+#include "CBIJSONWriter.h"
+#include "CBIJSONStringTable.h"
+#include "CBIRealFormat.h"
+
+#include <float.h>
+#include <string.h>
+
+/*************************************************************************
+Implementation of CCBIJSONWriter
+*************************************************************************/
+CCBIJSONWriter::CCBIJSONWriter(CCBIPlistWriter &out)
+: mOut(out)
+, mNeedComma(false)
+{
+}
+
+void CCBIJSONWriter::writeKey(const char *pKey, size_t length)
+{
+	separate();
+	mOut.writeChar('"');
+	mOut.write(pKey, length);
+	mOut.writeLiteral("\":");
+	mNeedComma = false;
+}
+
+void CCBIJSONWriter::writeFragment(const char *pFragment, size_t length)
+{
+	separate();
+	mOut.write(pFragment, length);
+	mNeedComma = true;
+}
+
+void CCBIJSONWriter::writeFragmentKey(const char *pFragment, size_t length)
+{
+	separate();
+	mOut.write(pFragment, length);
+	mOut.writeChar(':');
+	mNeedComma = false;
+}
+
+void CCBIJSONWriter::writeString(const char *pString)
+{
+	writeString(pString, strlen(pString));
+}
+
+void CCBIJSONWriter::writeString(const char *pString, size_t length)
+{
+	separate();
+	mOut.writeChar('"');
+
+	CCBIJSONStringTable::escape(pString, length, mOut);
+
+	mOut.writeChar('"');
+	mNeedComma = true;
+}
+
+void CCBIJSONWriter::writeInteger(int value)
+{
+	separate();
+	mOut.writeIntegerText(value);
+	mNeedComma = true;
+}
+
+void CCBIJSONWriter::writeReal(float value)
+{
+	separate();
+	if (value != value || value > FLT_MAX || value < -FLT_MAX)
+	{
+		mOut.writeLiteral("null");
+	}
+	else
+	{
+		char text[CCBIRealFormat::kMaxLength];
+		mOut.write(text, CCBIRealFormat::format(value, text));
+	}
+	mNeedComma = true;
+}
+
+void CCBIJSONWriter::writeBool(bool value)
+{
+	separate();
+	if (value)
+	{
+		mOut.writeLiteral("true");
+	}
+	else
+	{
+		mOut.writeLiteral("false");
+	}
+	mNeedComma = true;
+}
+
+void CCBIJSONWriter::startArray()
+{
+	separate();
+	mOut.writeChar('[');
+	mNeedComma = false;
+}
+
+void CCBIJSONWriter::endArray()
+{
+	mOut.writeChar(']');
+	mNeedComma = true;
+}
+
+void CCBIJSONWriter::startObject()
+{
+	separate();
+	mOut.writeChar('{');
+	mNeedComma = false;
+}
+
+void CCBIJSONWriter::endObject()
+{
+	mOut.writeChar('}');
+	mNeedComma = true;
+}
+
+void CCBIJSONWriter::endDocument()
+{
+	mOut.writeChar('\n');
+	mNeedComma = false;
+}
@@ -0,0 +1,72 @@
+#ifndef _CCBII_CCBIJSONWriter_H_
+#define _CCBII_CCBIJSONWriter_H_
+
+#include <stddef.h>
+
+#include "CBIPlistWriter.h"
+
+/**
+* @brief Writer for a compact json document
+*
+* Values are written in document order like with CCBIBinaryPlistWriter:
+* a value written while a container is open goes into that container, and
+* in an object keys and values alternate. The commas between them are put
+* in by the writer.
+*
+* The text goes straight into a CCBIPlistWriter buffer, which writes it
+* out or drains it; there is no whitespace but the final newline.
+*/
+class CCBIJSONWriter
+{
+private:
+	CCBIPlistWriter &mOut;
+	/*the open container holds a value already, the next one needs a comma*/
+	bool mNeedComma;
+
+public:
+	explicit CCBIJSONWriter(CCBIPlistWriter &out);
+
+	/*keys are literals, written as they are*/
+	template <size_t N>
+	void writeKey(const char (&key)[N])
+	{
+		writeKey(key, N - 1);
+	}
+	void writeKey(const char *pKey, size_t length);
+
+	/**
+	* @brief Write a string that is already escaped and quoted, e.g. by
+	* CCBIJSONStringTable, as a value or, with writeFragmentKey(), a key
+	*/
+	void writeFragment(const char *pFragment, size_t length);
+	void writeFragmentKey(const char *pFragment, size_t length);
+
+	void writeString(const char *pString);
+	void writeString(const char *pString, size_t length);
+	void writeInteger(int value);
+	/*shortest round-trip text; json has no nan or infinity, they become null*/
+	void writeReal(float value);
+	void writeBool(bool value);
+
+	void startArray();
+	void endArray();
+	void startObject();
+	void endObject();
+
+	/*end the document with its newline*/
+	void endDocument();
+
+private:
+	void separate()
+	{
+		if (mNeedComma)
+		{
+			mOut.writeChar(',');
+		}
+	}
+
+	CCBIJSONWriter(const CCBIJSONWriter&);
+	CCBIJSONWriter& operator=(const CCBIJSONWriter&);
+};
+
+#endif
@@ -0,0 +1,156 @@
+#include "CBIMappedFile.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/*************************************************************************
+Implementation of CCBIMappedFile
+*************************************************************************/
+CCBIMappedFile::CCBIMappedFile()
+: mBytes(NULL)
+, mLength(0)
+{
+}
+
+CCBIMappedFile::~CCBIMappedFile()
+{
+	close();
+}
+
+#ifdef _WIN32
+
+bool CCBIMappedFile::open(const char *pPath)
+{
+	close();
+
+	HANDLE file = CreateFileA(pPath, GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (INVALID_HANDLE_VALUE == file)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	/*an empty file can not be mapped, it is simply an open file without bytes*/
+	if (0 == size.QuadPart)
+	{
+		CloseHandle(file);
+		return true;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (NULL == mapping)
+	{
+		return false;
+	}
+
+	/*the view keeps the mapping alive, so the handle is not needed any more*/
+	void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (NULL == view)
+	{
+		return false;
+	}
+
+	mBytes = (const unsigned char*)view;
+	mLength = (size_t)size.QuadPart;
+
+	return true;
+}
+
+void CCBIMappedFile::close()
+{
+	if (NULL != mBytes)
+	{
+		UnmapViewOfFile((LPCVOID)mBytes);
+	}
+
+	mBytes = NULL;
+	mLength = 0;
+}
+
+#else
+
+bool CCBIMappedFile::open(const char *pPath)
+{
+	close();
+
+	int fd = ::open(pPath, O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat st;
+	if (0 != fstat(fd, &st))
+	{
+		::close(fd);
+		return false;
+	}
+
+	/*an empty file can not be mapped, it is simply an open file without bytes*/
+	if (0 == st.st_size)
+	{
+		::close(fd);
+		return true;
+	}
+
+	/*the mapping stays valid after the descriptor is closed*/
+	void *view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (MAP_FAILED == view)
+	{
+		return false;
+	}
+
+	madvise(view, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+	mBytes = (const unsigned char*)view;
+	mLength = (size_t)st.st_size;
+
+	return true;
+}
+
+void CCBIMappedFile::close()
+{
+	if (NULL != mBytes)
+	{
+		munmap((void*)mBytes, mLength);
+	}
+
+	mBytes = NULL;
+	mLength = 0;
+}
+
+#endif
+
+bool CCBIMappedFile::isOpen() const
+{
+	return NULL != mBytes;
+}
+
+const unsigned char* CCBIMappedFile::getBytes() const
+{
+	return mBytes;
+}
+
+size_t CCBIMappedFile::getLength() const
+{
+	return mLength;
+}
@@ -0,0 +1,34 @@
+#ifndef _CCBII_CCBIMappedFile_H_
+#define _CCBII_CCBIMappedFile_H_
+
+#include <stddef.h>
+
+/**
+* @brief Read-only memory mapping of a ccbi file
+*
+* The mapping is owned by the object and released on destruction, so the
+* decoder can read straight from the page cache without copying the file.
+*/
+class CCBIMappedFile
+{
+private:
+	const unsigned char *mBytes;
+	size_t mLength;
+
+public:
+	CCBIMappedFile();
+	~CCBIMappedFile();
+
+	bool open(const char *pPath);
+	void close();
+
+	bool isOpen() const;
+	const unsigned char* getBytes() const;
+	size_t getLength() const;
+
+private:
+	CCBIMappedFile(const CCBIMappedFile&);
+	CCBIMappedFile& operator=(const CCBIMappedFile&);
+};
+
+#endif
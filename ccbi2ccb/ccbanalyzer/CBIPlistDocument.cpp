@@ -0,0 +1,298 @@
+#include "CBIPlistDocument.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+/*************************************************************************
+Implementation of CCBIPlistDocument
+*************************************************************************/
+CCBIPlistDocument::CCBIPlistDocument()
+{
+	clear();
+}
+
+void CCBIPlistDocument::clear()
+{
+	mValues.clear();
+	mText.clear();
+	mOpen.clear();
+	mHasKey = false;
+	mKeyOffset = 0;
+	mKeyLength = 0;
+}
+
+bool CCBIPlistDocument::parse(const char *pText, size_t length, CCBIPlistParser &parser)
+{
+	clear();
+
+	/*a ccb is roughly one value per 30 bytes of xml*/
+	mValues.reserve(length / 30 + 16);
+	mText.reserve(length / 4 + 16);
+
+	return parser.parse(pText, length, *this);
+}
+
+int CCBIPlistDocument::getRoot() const
+{
+	return mValues.empty() ? -1 : 0;
+}
+
+int CCBIPlistDocument::getType(int value) const
+{
+	return mValues[value].type;
+}
+
+int CCBIPlistDocument::getChildCount(int value) const
+{
+	return mValues[value].numChildren;
+}
+
+int CCBIPlistDocument::getFirstChild(int value) const
+{
+	return mValues[value].firstChild;
+}
+
+int CCBIPlistDocument::getNext(int value) const
+{
+	return mValues[value].next;
+}
+
+int CCBIPlistDocument::getChild(int value, int index) const
+{
+	if (value < 0 || kTypeArray != mValues[value].type)
+	{
+		return -1;
+	}
+
+	int child = mValues[value].firstChild;
+	for (int i = 0; i < index && -1 != child; i++)
+	{
+		child = mValues[child].next;
+	}
+	return child;
+}
+
+int CCBIPlistDocument::find(int dict, const char *pKey) const
+{
+	if (dict < 0 || kTypeDict != mValues[dict].type)
+	{
+		return -1;
+	}
+
+	size_t length = strlen(pKey);
+	for (int child = mValues[dict].firstChild; -1 != child; child = mValues[child].next)
+	{
+		const Value &entry = mValues[child];
+		if (entry.keyLength == length && 0 == memcmp(&mText[0] + entry.keyOffset, pKey, length))
+		{
+			return child;
+		}
+	}
+	return -1;
+}
+
+const char* CCBIPlistDocument::getKey(int value, size_t &length) const
+{
+	length = mValues[value].keyLength;
+	return mText.empty() ? "" : &mText[0] + mValues[value].keyOffset;
+}
+
+const char* CCBIPlistDocument::getString(int value, size_t &length) const
+{
+	if (value < 0 || kTypeString != mValues[value].type)
+	{
+		length = 0;
+		return NULL;
+	}
+
+	length = mValues[value].textLength;
+	return mText.empty() ? "" : &mText[0] + mValues[value].textOffset;
+}
+
+bool CCBIPlistDocument::getInteger(int value, long long &integer) const
+{
+	if (value < 0)
+	{
+		return false;
+	}
+
+	const Value &entry = mValues[value];
+	switch (entry.type)
+	{
+	case kTypeInteger:
+	case kTypeBool:
+		integer = entry.integer;
+		return true;
+	case kTypeReal:
+		integer = (long long)entry.real;
+		return true;
+	case kTypeString:
+	{
+		/*the channel types come out of the ccb writer as keys*/
+		string text(&mText[0] + entry.textOffset, entry.textLength);
+		char *pEnd = NULL;
+		integer = strtoll(text.c_str(), &pEnd, 10);
+		return !text.empty() && '\0' == *pEnd;
+	}
+	default:
+		return false;
+	}
+}
+
+bool CCBIPlistDocument::getReal(int value, double &real) const
+{
+	if (value < 0)
+	{
+		return false;
+	}
+
+	const Value &entry = mValues[value];
+	switch (entry.type)
+	{
+	case kTypeReal:
+		real = entry.real;
+		return true;
+	case kTypeInteger:
+	case kTypeBool:
+		real = (double)entry.integer;
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool CCBIPlistDocument::getBool(int value, bool &flag) const
+{
+	if (value < 0)
+	{
+		return false;
+	}
+
+	const Value &entry = mValues[value];
+	switch (entry.type)
+	{
+	case kTypeBool:
+	case kTypeInteger:
+		flag = 0 != entry.integer;
+		return true;
+	default:
+		return false;
+	}
+}
+
+int CCBIPlistDocument::addValue(int type)
+{
+	Value value;
+	value.type = type;
+	value.firstChild = -1;
+	value.lastChild = -1;
+	value.numChildren = 0;
+	value.next = -1;
+	value.textOffset = 0;
+	value.textLength = 0;
+	value.keyOffset = 0;
+	value.keyLength = 0;
+	value.integer = 0;
+	value.real = 0;
+
+	int index = (int)mValues.size();
+
+	/*link into the open container*/
+	if (!mOpen.empty())
+	{
+		Value &parent = mValues[mOpen.back()];
+		if (kTypeDict == parent.type)
+		{
+			value.keyOffset = mKeyOffset;
+			value.keyLength = mKeyLength;
+			mHasKey = false;
+		}
+
+		if (-1 == parent.lastChild)
+		{
+			parent.firstChild = index;
+		}
+		else
+		{
+			mValues[parent.lastChild].next = index;
+		}
+		parent.lastChild = index;
+		parent.numChildren++;
+	}
+
+	mValues.push_back(value);
+	return index;
+}
+
+size_t CCBIPlistDocument::addText(const char *pText, size_t length)
+{
+	size_t offset = mText.size();
+	mText.insert(mText.end(), pText, pText + length);
+	return offset;
+}
+
+void CCBIPlistDocument::onDictStart()
+{
+	mOpen.push_back(addValue(kTypeDict));
+}
+
+void CCBIPlistDocument::onDictEnd()
+{
+	mOpen.pop_back();
+	mHasKey = false;
+}
+
+void CCBIPlistDocument::onArrayStart()
+{
+	mOpen.push_back(addValue(kTypeArray));
+}
+
+void CCBIPlistDocument::onArrayEnd()
+{
+	mOpen.pop_back();
+	mHasKey = false;
+}
+
+void CCBIPlistDocument::onKey(const char *pKey, size_t length)
+{
+	bool inDict = !mOpen.empty() && kTypeDict == mValues[mOpen.back()].type;
+	if (!inDict || mHasKey)
+	{
+		onString(pKey, length);
+		return;
+	}
+
+	mKeyOffset = addText(pKey, length);
+	mKeyLength = length;
+	mHasKey = true;
+}
+
+void CCBIPlistDocument::onString(const char *pString, size_t length)
+{
+	/*the text first, addValue() may move the value array*/
+	size_t offset = addText(pString, length);
+
+	int index = addValue(kTypeString);
+	mValues[index].textOffset = offset;
+	mValues[index].textLength = length;
+}
+
+void CCBIPlistDocument::onInteger(long long value)
+{
+	int index = addValue(kTypeInteger);
+	mValues[index].integer = value;
+}
+
+void CCBIPlistDocument::onReal(double value)
+{
+	int index = addValue(kTypeReal);
+	mValues[index].real = value;
+}
+
+void CCBIPlistDocument::onBool(bool value)
+{
+	int index = addValue(kTypeBool);
+	mValues[index].integer = value ? 1 : 0;
+}
@@ -0,0 +1,113 @@
+#ifndef _CCBII_CCBIPlistDocument_H_
+#define _CCBII_CCBIPlistDocument_H_
+
+#include <stddef.h>
+#include <vector>
+
+#include "CBIPlistParser.h"
+
+/**
+* @brief A parsed property list as flat arrays linked by index
+*
+* Built from the CCBIPlistParser events. Values are numbered in document
+* order, value 0 is the root; the children of a container are linked with
+* next, and in a dict every child carries its key.
+*
+* A key that comes where a value is expected is taken as a string value,
+* so the "<key>type</key><key>10</key>" the ccb writer produces for the
+* channels still reads as type = "10".
+*/
+class CCBIPlistDocument : public CCBIPlistHandler
+{
+public:
+	enum
+	{
+		kTypeDict,
+		kTypeArray,
+		kTypeString,
+		kTypeInteger,
+		kTypeReal,
+		kTypeBool
+	};
+
+private:
+	struct Value
+	{
+		int type;
+		int firstChild;
+		int lastChild;
+		int numChildren;
+		int next;
+		/*text of a string, key of a dict entry: ranges of mText*/
+		size_t textOffset;
+		size_t textLength;
+		size_t keyOffset;
+		size_t keyLength;
+		long long integer;
+		double real;
+	};
+
+	std::vector<Value> mValues;
+	std::vector<char> mText;
+
+	std::vector<int> mOpen;
+	bool mHasKey;
+	size_t mKeyOffset;
+	size_t mKeyLength;
+
+public:
+	CCBIPlistDocument();
+
+	void clear();
+
+	/**
+	* @brief Parse pText into this document
+	*/
+	bool parse(const char *pText, size_t length, CCBIPlistParser &parser);
+
+	/**
+	* @return the root value, -1 if the document is empty
+	*/
+	int getRoot() const;
+
+	int getType(int value) const;
+	int getChildCount(int value) const;
+	int getFirstChild(int value) const;
+	int getNext(int value) const;
+
+	/**
+	* @return the i-th child of an array, -1 if out of range
+	*/
+	int getChild(int value, int index) const;
+
+	/**
+	* @return the value of key in dict, -1 if dict is not a dict or lacks it
+	*/
+	int find(int dict, const char *pKey) const;
+
+	/*the key a dict child was stored under*/
+	const char* getKey(int value, size_t &length) const;
+
+	/* Conversions, lenient between ints, reals and bools. */
+	const char* getString(int value, size_t &length) const;
+	bool getInteger(int value, long long &integer) const;
+	bool getReal(int value, double &real) const;
+	bool getBool(int value, bool &flag) const;
+
+	/* Parse events. */
+	virtual void onDictStart();
+	virtual void onDictEnd();
+	virtual void onArrayStart();
+	virtual void onArrayEnd();
+	virtual void onKey(const char *pKey, size_t length);
+	virtual void onString(const char *pString, size_t length);
+	virtual void onInteger(long long value);
+	virtual void onReal(double value);
+	virtual void onBool(bool value);
+
+private:
+	int addValue(int type);
+	size_t addText(const char *pText, size_t length);
+};
+
+#endif
@@ -0,0 +1,521 @@
+#include "CBIPlistParser.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+static bool isSpace(char c)
+{
+	return ' ' == c || '\t' == c || '\n' == c || '\r' == c;
+}
+
+static bool isNameChar(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+		|| '_' == c || '-' == c || ':' == c || '.' == c;
+}
+
+static void appendUTF8(string &out, unsigned int c)
+{
+	if (c < 0x80)
+	{
+		out += (char)c;
+	}
+	else if (c < 0x800)
+	{
+		out += (char)(0xc0 | (c >> 6));
+		out += (char)(0x80 | (c & 0x3f));
+	}
+	else if (c < 0x10000)
+	{
+		out += (char)(0xe0 | (c >> 12));
+		out += (char)(0x80 | ((c >> 6) & 0x3f));
+		out += (char)(0x80 | (c & 0x3f));
+	}
+	else
+	{
+		out += (char)(0xf0 | (c >> 18));
+		out += (char)(0x80 | ((c >> 12) & 0x3f));
+		out += (char)(0x80 | ((c >> 6) & 0x3f));
+		out += (char)(0x80 | (c & 0x3f));
+	}
+}
+
+/*************************************************************************
+Implementation of CCBIPlistParser
+*************************************************************************/
+CCBIPlistParser::CCBIPlistParser()
+: mText(NULL)
+, mLength(0)
+, mPos(0)
+, mErrorOffset(0)
+{
+}
+
+const std::string& CCBIPlistParser::getError() const
+{
+	return mError;
+}
+
+size_t CCBIPlistParser::getErrorOffset() const
+{
+	return mErrorOffset;
+}
+
+bool CCBIPlistParser::fail(const char *pMessage)
+{
+	if (mError.empty())
+	{
+		mError = pMessage;
+		mErrorOffset = mPos;
+	}
+	return false;
+}
+
+bool CCBIPlistParser::startsWith(const char *pPrefix) const
+{
+	size_t length = strlen(pPrefix);
+	return mPos + length <= mLength && 0 == memcmp(mText + mPos, pPrefix, length);
+}
+
+bool CCBIPlistParser::skipPast(const char *pTerminator)
+{
+	size_t length = strlen(pTerminator);
+	while (mPos + length <= mLength)
+	{
+		if (0 == memcmp(mText + mPos, pTerminator, length))
+		{
+			mPos += length;
+			return true;
+		}
+		mPos++;
+	}
+	return fail("unterminated markup");
+}
+
+void CCBIPlistParser::skipWhitespace()
+{
+	while (mPos < mLength && isSpace(mText[mPos]))
+	{
+		mPos++;
+	}
+}
+
+bool CCBIPlistParser::readName(std::string &name)
+{
+	size_t start = mPos;
+	while (mPos < mLength && isNameChar(mText[mPos]))
+	{
+		mPos++;
+	}
+	if (start == mPos)
+	{
+		return fail("expected an element name");
+	}
+
+	name.assign(mText + start, mPos - start);
+	return true;
+}
+
+bool CCBIPlistParser::parse(const char *pText, size_t length, CCBIPlistHandler &handler)
+{
+	mText = pText;
+	mLength = length;
+	mPos = 0;
+	mError.clear();
+	mErrorOffset = 0;
+	mOpen.clear();
+
+	/*a UTF-8 byte order mark is allowed in front*/
+	if (startsWith("\xef\xbb\xbf"))
+	{
+		mPos += 3;
+	}
+
+	bool sawRoot = false;
+	for (;;)
+	{
+		skipWhitespace();
+		if (mPos >= mLength)
+		{
+			break;
+		}
+		if ('<' != mText[mPos])
+		{
+			return fail("text outside of an element");
+		}
+
+		if (startsWith("<?"))
+		{
+			if (!skipPast("?>"))
+			{
+				return false;
+			}
+		}
+		else if (startsWith("<!--"))
+		{
+			if (!skipPast("-->"))
+			{
+				return false;
+			}
+		}
+		else if (startsWith("<!"))
+		{
+			/*<!DOCTYPE ...>, possibly with an internal subset in brackets*/
+			int depth = 0;
+			while (mPos < mLength && !('>' == mText[mPos] && 0 == depth))
+			{
+				if ('[' == mText[mPos])
+				{
+					depth++;
+				}
+				else if (']' == mText[mPos])
+				{
+					depth--;
+				}
+				mPos++;
+			}
+			if (mPos >= mLength)
+			{
+				return fail("unterminated declaration");
+			}
+			mPos++;
+		}
+		else
+		{
+			if (!readElement(handler))
+			{
+				return false;
+			}
+			sawRoot = true;
+		}
+	}
+
+	if (!mOpen.empty())
+	{
+		return fail("unexpected end of the document");
+	}
+	if (!sawRoot)
+	{
+		return fail("no plist element");
+	}
+
+	return true;
+}
+
+bool CCBIPlistParser::readEndTag(const std::string &name)
+{
+	/*at "</", the name must be the one given*/
+	mPos += 2;
+
+	string endName;
+	if (!readName(endName))
+	{
+		return false;
+	}
+	if (endName != name)
+	{
+		return fail("closing tag does not match");
+	}
+
+	skipWhitespace();
+	if (mPos >= mLength || '>' != mText[mPos])
+	{
+		return fail("malformed closing tag");
+	}
+	mPos++;
+
+	return true;
+}
+
+bool CCBIPlistParser::readElement(CCBIPlistHandler &handler)
+{
+	if (startsWith("</"))
+	{
+		/*closing tag of a container*/
+		if (mOpen.empty())
+		{
+			return fail("closing tag without an open element");
+		}
+
+		string name = mOpen.back();
+		if (!readEndTag(name))
+		{
+			return false;
+		}
+		mOpen.pop_back();
+
+		if ("dict" == name)
+		{
+			handler.onDictEnd();
+		}
+		else if ("array" == name)
+		{
+			handler.onArrayEnd();
+		}
+		return true;
+	}
+
+	mPos++;
+	string name;
+	if (!readName(name))
+	{
+		return false;
+	}
+
+	/*attributes are only used by <plist version="1.0">, skip them*/
+	bool empty = false;
+	while (mPos < mLength && '>' != mText[mPos])
+	{
+		if ('"' == mText[mPos] || '\'' == mText[mPos])
+		{
+			char quote = mText[mPos++];
+			while (mPos < mLength && quote != mText[mPos])
+			{
+				mPos++;
+			}
+		}
+		else if ('/' == mText[mPos])
+		{
+			empty = true;
+		}
+		mPos++;
+	}
+	if (mPos >= mLength)
+	{
+		return fail("unterminated tag");
+	}
+	mPos++;
+
+	if ("plist" == name || "dict" == name || "array" == name)
+	{
+		if ("plist" != name && mOpen.empty())
+		{
+			return fail("value outside of the plist element");
+		}
+
+		if ("dict" == name)
+		{
+			handler.onDictStart();
+		}
+		else if ("array" == name)
+		{
+			handler.onArrayStart();
+		}
+
+		if (!empty)
+		{
+			mOpen.push_back(name);
+		}
+		else if ("dict" == name)
+		{
+			handler.onDictEnd();
+		}
+		else if ("array" == name)
+		{
+			handler.onArrayEnd();
+		}
+		return true;
+	}
+
+	if (mOpen.empty())
+	{
+		return fail("value outside of the plist element");
+	}
+
+	const char *pText = "";
+	size_t length = 0;
+	if (!empty && !readText(name, pText, length))
+	{
+		return false;
+	}
+
+	if ("key" == name)
+	{
+		handler.onKey(pText, length);
+	}
+	else if ("string" == name || "date" == name)
+	{
+		handler.onString(pText, length);
+	}
+	else if ("integer" == name || "real" == name)
+	{
+		/*strtoll/strtod need a terminated copy*/
+		char number[64];
+		if (length >= sizeof(number))
+		{
+			return fail("number too long");
+		}
+		memcpy(number, pText, length);
+		number[length] = '\0';
+
+		char *pEnd = NULL;
+		long long integer = 0;
+		double real = 0;
+		if ("integer" == name)
+		{
+			integer = strtoll(number, &pEnd, 10);
+		}
+		else
+		{
+			real = strtod(number, &pEnd);
+		}
+		while (isSpace(*pEnd))
+		{
+			pEnd++;
+		}
+		if (pEnd == number || '\0' != *pEnd)
+		{
+			return fail("malformed number");
+		}
+
+		if ("integer" == name)
+		{
+			handler.onInteger(integer);
+		}
+		else
+		{
+			handler.onReal(real);
+		}
+	}
+	else if ("true" == name || "false" == name)
+	{
+		handler.onBool("true" == name);
+	}
+	else
+	{
+		return fail("unsupported element");
+	}
+
+	return true;
+}
+
+bool CCBIPlistParser::readText(const std::string &name, const char *&pText, size_t &length)
+{
+	size_t start = mPos;
+	bool decoded = false;
+
+	for (;;)
+	{
+		size_t run = mPos;
+		while (mPos < mLength && '<' != mText[mPos] && '&' != mText[mPos])
+		{
+			mPos++;
+		}
+		if (mPos >= mLength)
+		{
+			return fail("unterminated element");
+		}
+
+		/*only text with entities or CDATA is copied*/
+		if (!decoded && ('&' == mText[mPos] || startsWith("<![CDATA[")))
+		{
+			mScratch.clear();
+			decoded = true;
+		}
+		if (decoded)
+		{
+			mScratch.append(mText + run, mPos - run);
+		}
+
+		if ('&' == mText[mPos])
+		{
+			if (!decodeEntity(mScratch))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		if (startsWith("<![CDATA["))
+		{
+			mPos += 9;
+			size_t cdata = mPos;
+			if (!skipPast("]]>"))
+			{
+				return false;
+			}
+			mScratch.append(mText + cdata, mPos - 3 - cdata);
+			continue;
+		}
+
+		size_t end = mPos;
+		if (!startsWith("</"))
+		{
+			return fail("unexpected markup in a value");
+		}
+		if (!readEndTag(name))
+		{
+			return false;
+		}
+
+		if (decoded)
+		{
+			pText = mScratch.data();
+			length = mScratch.size();
+		}
+		else
+		{
+			pText = mText + start;
+			length = end - start;
+		}
+		return true;
+	}
+}
+
+bool CCBIPlistParser::decodeEntity(std::string &out)
+{
+	/*at '&'*/
+	size_t semicolon = mPos + 1;
+	while (semicolon < mLength && semicolon - mPos < 12 && ';' != mText[semicolon])
+	{
+		semicolon++;
+	}
+	if (semicolon >= mLength || ';' != mText[semicolon])
+	{
+		return fail("unterminated entity");
+	}
+
+	string entity(mText + mPos + 1, semicolon - mPos - 1);
+	if ("lt" == entity)
+	{
+		out += '<';
+	}
+	else if ("gt" == entity)
+	{
+		out += '>';
+	}
+	else if ("amp" == entity)
+	{
+		out += '&';
+	}
+	else if ("quot" == entity)
+	{
+		out += '"';
+	}
+	else if ("apos" == entity)
+	{
+		out += '\'';
+	}
+	else if (entity.size() > 1 && '#' == entity[0])
+	{
+		bool hex = 'x' == entity[1] || 'X' == entity[1];
+		const char *pDigits = entity.c_str() + (hex ? 2 : 1);
+		char *pEnd = NULL;
+		unsigned long c = strtoul(pDigits, &pEnd, hex ? 16 : 10);
+		if (pEnd == pDigits || '\0' != *pEnd || c > 0x10ffff)
+		{
+			return fail("bad character reference");
+		}
+		appendUTF8(out, (unsigned int)c);
+	}
+	else
+	{
+		return fail("unknown entity");
+	}
+
+	mPos = semicolon + 1;
+	return true;
+}
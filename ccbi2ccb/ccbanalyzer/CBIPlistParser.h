@@ -0,0 +1,78 @@
+#ifndef _CCBII_CCBIPlistParser_H_
+#define _CCBII_CCBIPlistParser_H_
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/**
+* @brief Receiver of the events of CCBIPlistParser
+*
+* Text is passed as pointer and length, valid only during the call. It
+* points straight into the input unless it held entities or CDATA.
+*/
+class CCBIPlistHandler
+{
+public:
+	virtual ~CCBIPlistHandler() {}
+
+	virtual void onDictStart() = 0;
+	virtual void onDictEnd() = 0;
+	virtual void onArrayStart() = 0;
+	virtual void onArrayEnd() = 0;
+
+	virtual void onKey(const char *pKey, size_t length) = 0;
+	/*<string>, and <date> which is passed as its text*/
+	virtual void onString(const char *pString, size_t length) = 0;
+	virtual void onInteger(long long value) = 0;
+	virtual void onReal(double value) = 0;
+	virtual void onBool(bool value) = 0;
+};
+
+/**
+* @brief SAX style parser of xml property lists, like the ccb files
+*
+* One forward pass over the text, no document is built: each element is
+* reported to the handler as soon as it is complete.
+*/
+class CCBIPlistParser
+{
+private:
+	const char *mText;
+	size_t mLength;
+	size_t mPos;
+
+	std::string mError;
+	size_t mErrorOffset;
+
+	/*element names of the open <plist>, <dict> and <array>*/
+	std::vector<std::string> mOpen;
+	/*text that had to be decoded*/
+	std::string mScratch;
+
+public:
+	CCBIPlistParser();
+
+	/**
+	* @return false on malformed input, see getError() and getErrorOffset()
+	*/
+	bool parse(const char *pText, size_t length, CCBIPlistHandler &handler);
+
+	const std::string& getError() const;
+	size_t getErrorOffset() const;
+
+private:
+	bool fail(const char *pMessage);
+
+	bool startsWith(const char *pPrefix) const;
+	bool skipPast(const char *pTerminator);
+	void skipWhitespace();
+
+	bool readName(std::string &name);
+	bool readElement(CCBIPlistHandler &handler);
+	bool readEndTag(const std::string &name);
+	bool readText(const std::string &name, const char *&pText, size_t &length);
+	bool decodeEntity(std::string &out);
+};
+
+#endif
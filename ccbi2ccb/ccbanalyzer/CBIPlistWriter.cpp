@@ -0,0 +1,214 @@
+#include "CBIPlistWriter.h"
+#include "ccbimapping.h"
+#include "CBIRealFormat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <fstream>
+#include <new>
+
+using namespace std;
+
+/*************************************************************************
+Implementation of CCBIPlistWriter
+*************************************************************************/
+CCBIPlistWriter::CCBIPlistWriter()
+: mBuffer(NULL)
+, mSize(0)
+, mCapacity(0)
+{
+	reserve(kDefaultCapacity);
+}
+
+CCBIPlistWriter::~CCBIPlistWriter()
+{
+	free(mBuffer);
+	mBuffer = NULL;
+}
+
+void CCBIPlistWriter::reserve(size_t capacity)
+{
+	if (capacity <= mCapacity)
+	{
+		return;
+	}
+
+	char *buffer = (char*)realloc(mBuffer, capacity);
+	if (NULL == buffer)
+	{
+		/*keep the old buffer, grow() will retry with the exact size*/
+		return;
+	}
+
+	mBuffer = buffer;
+	mCapacity = capacity;
+}
+
+void CCBIPlistWriter::clear()
+{
+	mSize = 0;
+}
+
+const char* CCBIPlistWriter::getBytes() const
+{
+	return mBuffer;
+}
+
+size_t CCBIPlistWriter::getSize() const
+{
+	return mSize;
+}
+
+bool CCBIPlistWriter::flushTo(const char *pOutFile, bool binary) const
+{
+	/*text mode by default, so the line ends match what the stream based writer produced*/
+	ofstream out(pOutFile, binary ? ios::out | ios::binary : ios::out);
+	if (!out.is_open())
+	{
+		return false;
+	}
+
+	out.write(mBuffer, mSize);
+	out.close();
+
+	return !out.fail();
+}
+
+bool CCBIPlistWriter::drainTo(FILE *pFile)
+{
+	bool ok = mSize == fwrite(mBuffer, 1, mSize, pFile);
+	mSize = 0;
+
+	return ok;
+}
+
+void CCBIPlistWriter::grow(size_t length)
+{
+	size_t capacity = mCapacity * 2;
+	if (capacity < mSize + length)
+	{
+		capacity = mSize + length;
+	}
+
+	reserve(capacity);
+	if (mSize + length > mCapacity)
+	{
+		reserve(mSize + length);
+		if (mSize + length > mCapacity)
+		{
+			throw bad_alloc();
+		}
+	}
+}
+
+void CCBIPlistWriter::writeIntegerText(int value)
+{
+	char digits[16];
+	int count = 0;
+
+	/*work on the unsigned magnitude so INT_MIN does not overflow*/
+	unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+	do
+	{
+		digits[count++] = (char)('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (0 != magnitude);
+
+	if (value < 0)
+	{
+		digits[count++] = '-';
+	}
+
+	if (mSize + count > mCapacity)
+	{
+		grow(count);
+	}
+	while (count > 0)
+	{
+		mBuffer[mSize++] = digits[--count];
+	}
+}
+
+void CCBIPlistWriter::writeKey(const char *pKey)
+{
+	writeKey(pKey, strlen(pKey));
+}
+
+void CCBIPlistWriter::writeKey(const std::string &key)
+{
+	writeKey(key.data(), key.size());
+}
+
+void CCBIPlistWriter::writeKey(const char *pKey, size_t length)
+{
+	writeLiteral(XML_START_TAG(CCBI_XML_TAG_KEY));
+	write(pKey, length);
+	writeLiteralLine(XML_END_TAG(CCBI_XML_TAG_KEY));
+}
+
+void CCBIPlistWriter::writeString(const char *pString)
+{
+	writeString(pString, strlen(pString));
+}
+
+void CCBIPlistWriter::writeString(const std::string &string)
+{
+	writeString(string.data(), string.size());
+}
+
+void CCBIPlistWriter::writeString(const char *pString, size_t length)
+{
+	writeLiteral(XML_START_TAG(CCBI_XML_TAG_STRING));
+	write(pString, length);
+	writeLiteralLine(XML_END_TAG(CCBI_XML_TAG_STRING));
+}
+
+void CCBIPlistWriter::writeInteger(int value)
+{
+	writeLiteral(XML_START_TAG(CCBI_XML_TAG_INTEGER));
+	writeIntegerText(value);
+	writeLiteralLine(XML_END_TAG(CCBI_XML_TAG_INTEGER));
+}
+
+void CCBIPlistWriter::writeReal(float value)
+{
+	char text[CCBIRealFormat::kMaxLength];
+	int length = CCBIRealFormat::format(value, text);
+
+	writeLiteral(XML_START_TAG(CCBI_XML_TAG_REAL));
+	write(text, length);
+	writeLiteralLine(XML_END_TAG(CCBI_XML_TAG_REAL));
+}
+
+void CCBIPlistWriter::writeBool(bool value)
+{
+	if (value)
+	{
+		writeLiteralLine(CCBI_XML_TAG_TRUE);
+	}
+	else
+	{
+		writeLiteralLine(CCBI_XML_TAG_FALSE);
+	}
+}
+
+void CCBIPlistWriter::writeArrayStartTag()
+{
+	writeLiteralLine(XML_START_TAG(CCBI_XML_TAG_ARRAY));
+}
+
+void CCBIPlistWriter::writeArrayEndTag()
+{
+	writeLiteralLine(XML_END_TAG(CCBI_XML_TAG_ARRAY));
+}
+
+void CCBIPlistWriter::writeDictStartTag()
+{
+	writeLiteralLine(XML_START_TAG(CCBI_XML_TAG_DICT));
+}
+
+void CCBIPlistWriter::writeDictEndTag()
+{
+	writeLiteralLine(XML_END_TAG(CCBI_XML_TAG_DICT));
+}
@@ -0,0 +1,108 @@
+#ifndef _CCBII_CCBIPlistWriter_H_
+#define _CCBII_CCBIPlistWriter_H_
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+/**
+* @brief Buffered writer for the ccb xml plist
+*
+* The whole document is built in one contiguous buffer and handed to the
+* file system with a single write, instead of flushing a stream per line.
+* Tag strings are passed as literals so their length is known at compile
+* time, e.g. writeLiteralLine(XML_START_TAG(CCBI_XML_TAG_DICT)).
+*/
+class CCBIPlistWriter
+{
+private:
+	char *mBuffer;
+	size_t mSize;
+	size_t mCapacity;
+
+public:
+	static const size_t kDefaultCapacity = 64 * 1024;
+
+	CCBIPlistWriter();
+	~CCBIPlistWriter();
+
+	void reserve(size_t capacity);
+	void clear();
+
+	const char* getBytes() const;
+	size_t getSize() const;
+
+	/**
+	* @brief Write the buffer to pOutFile in one go
+	* @param binary write the bytes as they are, for content that is not text
+	*/
+	bool flushTo(const char *pOutFile, bool binary = false) const;
+
+	/**
+	* @brief Write what is buffered so far to pFile and empty the buffer
+	*
+	* For documents written piece by piece, which never need to be held
+	* whole; the capacity is kept for the next piece.
+	*/
+	bool drainTo(FILE *pFile);
+
+	void write(const char *pBytes, size_t length)
+	{
+		if (mSize + length > mCapacity)
+		{
+			grow(length);
+		}
+		memcpy(mBuffer + mSize, pBytes, length);
+		mSize += length;
+	}
+
+	void writeChar(char c)
+	{
+		if (mSize + 1 > mCapacity)
+		{
+			grow(1);
+		}
+		mBuffer[mSize++] = c;
+	}
+
+	template <size_t N>
+	void writeLiteral(const char (&literal)[N])
+	{
+		write(literal, N - 1);
+	}
+
+	template <size_t N>
+	void writeLiteralLine(const char (&literal)[N])
+	{
+		write(literal, N - 1);
+		writeChar('\n');
+	}
+
+	/*<key>...</key>, <string>...</string>, <integer>...</integer>, <real>...</real>*/
+	void writeKey(const char *pKey);
+	void writeKey(const std::string &key);
+	void writeKey(const char *pKey, size_t length);
+	void writeString(const char *pString);
+	void writeString(const std::string &string);
+	void writeString(const char *pString, size_t length);
+	void writeInteger(int value);
+	void writeReal(float value);
+	void writeBool(bool value);
+
+	/*the decimal digits of value alone, without a tag*/
+	void writeIntegerText(int value);
+
+	void writeArrayStartTag();
+	void writeArrayEndTag();
+	void writeDictStartTag();
+	void writeDictEndTag();
+
+private:
+	void grow(size_t length);
+
+	CCBIPlistWriter(const CCBIPlistWriter&);
+	CCBIPlistWriter& operator=(const CCBIPlistWriter&);
+};
+
+#endif
@@ -0,0 +1,18 @@
+#include "CBIPropertyCodec.h"
+
+/*the list must follow the kCCBIPropType* enum, which is checked here*/
+#define CCBI_CODEC_INDEX(name, keyframeFields, ...) kCCBICodecIndex##name,
+enum { CCBI_PROPERTY_CODECS(CCBI_CODEC_INDEX) kCCBICodecCount };
+
+#define CCBI_CODEC_ORDER(name, keyframeFields, ...) \
+	static_assert((int)kCCBICodecIndex##name == (int)kCCBIPropType##name, "CCBI_PROPERTY_CODECS is out of kCCBIPropType order");
+CCBI_PROPERTY_CODECS(CCBI_CODEC_ORDER)
+static_assert((int)kCCBICodecCount == (int)kCCBIPropTypeMAX, "CCBI_PROPERTY_CODECS misses a kCCBIPropType");
+
+#define CCBI_CODEC_ENTRY(name, keyframeFields, ...) \
+	{ kCCBIPropType##name, { __VA_ARGS__, '\0' }, CCBIFieldCount<__VA_ARGS__>::value, keyframeFields },
+
+const CCBIPropertyCodec kCCBIPropertyCodecs[kCCBIPropTypeMAX] =
+{
+	CCBI_PROPERTY_CODECS(CCBI_CODEC_ENTRY)
+};
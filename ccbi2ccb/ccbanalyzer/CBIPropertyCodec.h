@@ -0,0 +1,90 @@
+#ifndef _CCBII_CCBIPropertyCodec_H_
+#define _CCBII_CCBIPropertyCodec_H_
+
+#include "CBIReader.h"
+
+/*the encoding of one field of a property or keyframe value*/
+enum {
+	kCCBIFieldFloat = 'f',
+	kCCBIFieldUnsigned = 'u',
+	kCCBIFieldSigned = 's',
+	kCCBIFieldByte = 'b',
+	kCCBIFieldBool = 'c',
+	kCCBIFieldString = 'S'
+};
+
+/*
+* The value of every kCCBIPropType*, in enum order: the name of the type,
+* how many leading fields a keyframe of it has (0 if it is never animated)
+* and its fields in file order, one kCCBIField* letter each.
+*
+* This list is the only place the layouts are written down; the codec
+* table and the decode kernels of CCBIReader are both expanded from it.
+*/
+#define CCBI_PROPERTY_CODECS(CODEC) \
+	CODEC(Position, 2, 'f', 'f', 'u') \
+	CODEC(Size, 0, 'f', 'f', 'u') \
+	CODEC(Point, 0, 'f', 'f') \
+	CODEC(PointLock, 0, 'f', 'f') \
+	CODEC(ScaleLock, 2, 'f', 'f', 'u') \
+	CODEC(Degrees, 1, 'f') \
+	CODEC(Integer, 0, 's') \
+	CODEC(Float, 0, 'f') \
+	CODEC(FloatVar, 0, 'f', 'f') \
+	CODEC(Check, 1, 'c') \
+	CODEC(SpriteFrame, 2, 'S', 'S') \
+	CODEC(Texture, 0, 'S') \
+	CODEC(Byte, 1, 'b') \
+	CODEC(Color3, 3, 'b', 'b', 'b') \
+	CODEC(Color4FVar, 0, 'f', 'f', 'f', 'f', 'f', 'f', 'f', 'f') \
+	CODEC(Flip, 0, 'c', 'c') \
+	CODEC(Blendmode, 0, 'u', 'u') \
+	CODEC(FntFile, 0, 'S') \
+	CODEC(Text, 0, 'S') \
+	CODEC(FontTTF, 0, 'S') \
+	CODEC(IntegerLabeled, 0, 's') \
+	CODEC(Block, 0, 'S', 'u') \
+	CODEC(Animation, 0, 'S', 'S') \
+	CODEC(CCBIFile, 0, 'S') \
+	CODEC(String, 0, 'S') \
+	CODEC(BlockCCControl, 0, 'S', 'u', 'u') \
+	CODEC(FloatScale, 0, 'f', 'u') \
+	CODEC(FloatXY, 2, 'f', 'f')
+
+/*the longest value, Color4FVar: red, green, blue, alpha and their variances*/
+#define kCCBIMaxValueFields 8
+
+/**
+* @brief How the value of a property type is stored
+*
+* A keyframe stores the first numKeyframeFields fields of the value of its
+* animated property, the Position and ScaleLock units are not animated.
+*/
+struct CCBIPropertyCodec
+{
+	int type;
+	/*kCCBIField* letters, null terminated*/
+	char fields[kCCBIMaxValueFields + 1];
+	int numFields;
+	int numKeyframeFields;
+};
+
+/*indexed by kCCBIPropType*, see CCBI_PROPERTY_CODECS*/
+extern const CCBIPropertyCodec kCCBIPropertyCodecs[kCCBIPropTypeMAX];
+
+/**
+* @return the codec of a property type, NULL if the type is unknown
+*/
+inline const CCBIPropertyCodec* getCCBIPropertyCodec(int type)
+{
+	return type >= 0 && type < kCCBIPropTypeMAX ? &kCCBIPropertyCodecs[type] : NULL;
+}
+
+/*the number of fields of a CCBI_PROPERTY_CODECS entry*/
+template <char... Fields>
+struct CCBIFieldCount
+{
+	enum { value = sizeof...(Fields) };
+};
+
+#endif
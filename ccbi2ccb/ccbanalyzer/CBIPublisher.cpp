@@ -0,0 +1,862 @@
+#include "CBIPublisher.h"
+#include "CBIReader.h"
+#include "ccbimapping.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+using namespace std;
+
+/*ccb keyframe type of an animated property -> kCCBIPropType*/
+static int getPropTypeOfKeyframeType(int keyframeType)
+{
+	for (int i = 0; i < kCCBIPropTypeMAX; i++)
+	{
+		if (CCBIMainPropTypeName::getAnimatedPropTypeValue(i) == keyframeType)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*orders string indices by uses, most used first, then by first use*/
+struct CCBIStringUseLess
+{
+	const vector<int> *pUses;
+
+	bool operator()(int a, int b) const
+	{
+		if ((*pUses)[a] != (*pUses)[b])
+		{
+			return (*pUses)[a] > (*pUses)[b];
+		}
+		return a < b;
+	}
+};
+
+/*************************************************************************
+Implementation of CCBIPublisher
+*************************************************************************/
+CCBIPublisher::CCBIPublisher(const CCBIPlistDocument &document, CCBITree &tree)
+: mDocument(document)
+, mTree(tree)
+, mMaxDepth(kCCBIDefaultMaxDepth)
+{
+}
+
+void CCBIPublisher::setMaxDepth(int maxDepth)
+{
+	mMaxDepth = maxDepth;
+}
+
+const std::string& CCBIPublisher::getError() const
+{
+	return mError;
+}
+
+bool CCBIPublisher::fail(const char *pMessage)
+{
+	if (mError.empty())
+	{
+		mError = pMessage;
+		if (!mContext.empty())
+		{
+			mError += " (" + mContext + ")";
+		}
+	}
+	return false;
+}
+
+bool CCBIPublisher::build()
+{
+	mTree.clear();
+	mError.clear();
+	mStringBytes.clear();
+	mStrings.clear();
+	mStringUses.clear();
+	mStringIndices.clear();
+	mStringValues.clear();
+	mContext.clear();
+
+	int root = mDocument.getRoot();
+	if (-1 == root || CCBIPlistDocument::kTypeDict != mDocument.getType(root))
+	{
+		return fail("the document is not a dict");
+	}
+
+	mTree.header.version = kCCBIVersion;
+	mTree.header.jsControlled = false;
+	mDocument.getBool(mDocument.find(root, "jsControlled"), mTree.header.jsControlled);
+
+	if (!readSequences(root))
+	{
+		return false;
+	}
+
+	int nodeGraph = mDocument.find(root, CCBI_NODEGRAPH_KEY_NODEGRAPH_MAIN);
+	if (-1 == nodeGraph || CCBIPlistDocument::kTypeDict != mDocument.getType(nodeGraph))
+	{
+		return fail("no node graph");
+	}
+	if (!readNodeGraph(nodeGraph))
+	{
+		return false;
+	}
+
+	sortStrings();
+	return true;
+}
+
+int CCBIPublisher::intern(const char *pString, size_t length)
+{
+	string key(pString, length);
+	unordered_map<string, int>::iterator it = mStringIndices.find(key);
+	if (it != mStringIndices.end())
+	{
+		mStringUses[it->second]++;
+		return it->second;
+	}
+
+	CCBIString string;
+	string.offset = (unsigned int)mStringBytes.size();
+	string.length = (unsigned int)length;
+	mStringBytes.insert(mStringBytes.end(), pString, pString + length);
+
+	int index = (int)mStrings.size();
+	mStrings.push_back(string);
+	mStringUses.push_back(1);
+	mStringIndices[key] = index;
+
+	return index;
+}
+
+bool CCBIPublisher::readStringIndex(int value, int &index)
+{
+	size_t length;
+	const char *pString = mDocument.getString(value, length);
+	if (NULL == pString)
+	{
+		return false;
+	}
+
+	index = intern(pString, length);
+	return true;
+}
+
+int CCBIPublisher::getElement(int value, int index) const
+{
+	if (-1 == value)
+	{
+		return -1;
+	}
+	if (CCBIPlistDocument::kTypeArray == mDocument.getType(value))
+	{
+		return mDocument.getChild(value, index);
+	}
+	return 0 == index ? value : -1;
+}
+
+bool CCBIPublisher::readSequences(int root)
+{
+	int sequences = mDocument.find(root, CCBI_SEQUENCE_KEY_MAIN);
+
+	mTree.autoPlaySequenceId = -1;
+	if (-1 == sequences)
+	{
+		return true;
+	}
+
+	for (int dict = mDocument.getFirstChild(sequences); -1 != dict; dict = mDocument.getNext(dict))
+	{
+		CCBISequence sequence;
+		double real = 0;
+		long long integer = 0;
+
+		mContext = "sequence";
+		if (!mDocument.getReal(mDocument.find(dict, CCBI_SEQUENCE_KEY_DURATION_LEN), real))
+		{
+			return fail("sequence without a length");
+		}
+		sequence.duration = (float)real;
+
+		if (!readStringIndex(mDocument.find(dict, CCBI_SEQUENCE_KEY_MAIN_NAME), sequence.nameIndex))
+		{
+			return fail("sequence without a name");
+		}
+
+		if (!mDocument.getInteger(mDocument.find(dict, CCBI_SEQUENCE_KEY_SEQUENCE_ID), integer))
+		{
+			return fail("sequence without an id");
+		}
+		sequence.sequenceId = (int)integer;
+
+		sequence.chainedSequenceId = -1;
+		if (mDocument.getInteger(mDocument.find(dict, CCBI_SEQUENCE_KEY_CHAINEDSEQ_ID), integer))
+		{
+			sequence.chainedSequenceId = (int)integer;
+		}
+
+		bool autoPlay = false;
+		if (mDocument.getBool(mDocument.find(dict, CCBI_SEQUENCE_KEY_AUTOPLAY_KEY), autoPlay)
+			&& autoPlay && -1 == mTree.autoPlaySequenceId)
+		{
+			mTree.autoPlaySequenceId = sequence.sequenceId;
+		}
+
+		/*callback keyframes: value is [selector, target type]*/
+		int channel = mDocument.find(dict, CCBI_SEQUENCE_CALLBACKCHANNEL_KEY_NAME);
+		int keyframes = mDocument.find(channel, CCBI_SEQUENCE_KEY_KEY_FRAMES);
+		sequence.firstCallbackKeyframe = mTree.callbackKeyframes.size();
+		for (int k = -1 == keyframes ? -1 : mDocument.getFirstChild(keyframes); -1 != k; k = mDocument.getNext(k))
+		{
+			int value = mDocument.find(k, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_VALUE);
+
+			CCBICallbackKeyframe keyframe;
+			if (!mDocument.getReal(mDocument.find(k, CCBI_SEQUENCE_CALLBACKCHANNEL_KEY_TIME), real)
+				|| !readStringIndex(getElement(value, 0), keyframe.nameIndex)
+				|| !mDocument.getInteger(getElement(value, 1), integer))
+			{
+				return fail("bad callback keyframe");
+			}
+			keyframe.time = (float)real;
+			keyframe.callbackType = (int)integer;
+			mTree.callbackKeyframes.push_back(keyframe);
+		}
+		sequence.numCallbackKeyframes = mTree.callbackKeyframes.size() - sequence.firstCallbackKeyframe;
+
+		/*sound keyframes: value is [file, pitch, pan, gain]*/
+		channel = mDocument.find(dict, CCBI_SEQUENCE_SOUNDCHANNEL_KEY_NAME);
+		keyframes = mDocument.find(channel, CCBI_SEQUENCE_KEY_KEY_FRAMES);
+		sequence.firstSoundKeyframe = mTree.soundKeyframes.size();
+		for (int k = -1 == keyframes ? -1 : mDocument.getFirstChild(keyframes); -1 != k; k = mDocument.getNext(k))
+		{
+			int value = mDocument.find(k, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_VALUE);
+
+			CCBISoundKeyframe keyframe;
+			double pitch, pan, gain;
+			if (!mDocument.getReal(mDocument.find(k, CCBI_SEQUENCE_SOUNDCHANNEL_KEY_TIME), real)
+				|| !readStringIndex(getElement(value, 0), keyframe.fileIndex)
+				|| !mDocument.getReal(getElement(value, 1), pitch)
+				|| !mDocument.getReal(getElement(value, 2), pan)
+				|| !mDocument.getReal(getElement(value, 3), gain))
+			{
+				return fail("bad sound keyframe");
+			}
+			keyframe.time = (float)real;
+			keyframe.pitch = (float)pitch;
+			keyframe.pan = (float)pan;
+			keyframe.gain = (float)gain;
+			mTree.soundKeyframes.push_back(keyframe);
+		}
+		sequence.numSoundKeyframes = mTree.soundKeyframes.size() - sequence.firstSoundKeyframe;
+
+		mTree.sequences.push_back(sequence);
+	}
+
+	mContext.clear();
+	return true;
+}
+
+bool CCBIPublisher::readNodeGraph(int root)
+{
+	/*a node on the path to the one being read, and its next child to read*/
+	struct NodeFrame
+	{
+		int index;
+		int nextChild;
+	};
+	std::vector<NodeFrame> frames;
+
+	int dict = root;
+	for (;;)
+	{
+		/* The new node is one level below the open frames. */
+		if ((int)frames.size() >= mMaxDepth)
+		{
+			mContext = "node";
+			char message[64];
+			sprintf(message, "the node graph is deeper than %d levels", mMaxDepth);
+			return fail(message);
+		}
+
+		int index, children;
+		if (!readNode(dict, frames.empty() ? -1 : frames.back().index, index, children))
+		{
+			return false;
+		}
+		NodeFrame frame = { index, -1 == children ? -1 : mDocument.getFirstChild(children) };
+		frames.push_back(frame);
+
+		/* Close the subtrees this node completes, then go on with the next child. */
+		while (!frames.empty() && -1 == frames.back().nextChild)
+		{
+			mTree.nodes[frames.back().index].subtreeEnd = mTree.nodes.size();
+			frames.pop_back();
+		}
+		if (frames.empty())
+		{
+			return true;
+		}
+
+		dict = frames.back().nextChild;
+		frames.back().nextChild = mDocument.getNext(dict);
+		if (CCBIPlistDocument::kTypeDict != mDocument.getType(dict))
+		{
+			mContext = "node";
+			return fail("child is not a node");
+		}
+	}
+}
+
+bool CCBIPublisher::readNode(int dict, int parent, int &index, int &children)
+{
+	/* Reserve the slot first so the graph stays in pre-order. */
+	index = mTree.nodes.append(1);
+
+	CCBINode node;
+	node.parent = parent;
+
+	/*a custom class replaces the base class in the ccbi*/
+	mContext = "node";
+	size_t length;
+	const char *pCustomClass = mDocument.getString(mDocument.find(dict, "customClass"), length);
+	if (NULL != pCustomClass && 0 != length)
+	{
+		node.classNameIndex = intern(pCustomClass, length);
+	}
+	else if (!readStringIndex(mDocument.find(dict, CCBI_NODEGRAPH_KEY_BASE_CLASS), node.classNameIndex))
+	{
+		return fail("node without a base class");
+	}
+
+	node.jsControlledNameIndex = -1;
+	if (mTree.header.jsControlled)
+	{
+		int controller = mDocument.find(dict, CCBI_NODEGRAPH_KEY_JSCONTROLLER);
+		if (!readStringIndex(controller, node.jsControlledNameIndex))
+		{
+			node.jsControlledNameIndex = intern("", 0);
+		}
+	}
+
+	long long integer = kCCBITargetTypeNone;
+	mDocument.getInteger(mDocument.find(dict, CCBI_NODEGRAPH_KEY_MEMBERVARASSIGNMENTTYPE), integer);
+	node.memberVarAssignmentType = (int)integer;
+
+	node.memberVarAssignmentNameIndex = -1;
+	if (node.memberVarAssignmentType != kCCBITargetTypeNone)
+	{
+		int name = mDocument.find(dict, CCBI_NODEGRAPH_KEY_MEMBERVARASSIGNMENTNAME);
+		if (!readStringIndex(name, node.memberVarAssignmentNameIndex))
+		{
+			node.memberVarAssignmentNameIndex = intern("", 0);
+		}
+	}
+
+	int properties = mDocument.find(dict, CCBI_NODEGRAPH_PROPERTIES_KEY_PROPERTIES);
+	if (!readAnimatedProperties(dict, properties, node))
+	{
+		return false;
+	}
+
+	/*the regular properties, then the custom ones as extra properties*/
+	node.firstProperty = mTree.properties.size();
+	for (int p = -1 == properties ? -1 : mDocument.getFirstChild(properties); -1 != p; p = mDocument.getNext(p))
+	{
+		CCBIProperty property;
+		if (!readProperty(p, property))
+		{
+			return false;
+		}
+		mTree.properties.push_back(property);
+	}
+	int numRegular = mTree.properties.size() - node.firstProperty;
+
+	int custom = mDocument.find(dict, "customProperties");
+	for (int p = -1 == custom ? -1 : mDocument.getFirstChild(custom); -1 != p; p = mDocument.getNext(p))
+	{
+		CCBIProperty property;
+		if (!readCustomProperty(p, property))
+		{
+			return false;
+		}
+		mTree.properties.push_back(property);
+	}
+	node.numProperties = mTree.properties.size() - node.firstProperty;
+	node.numExtraProperties = node.numProperties - numRegular;
+
+	children = mDocument.find(dict, CCBI_NODEGRAPH_KEY_CHILDREN);
+	node.numChildren = -1 == children ? 0 : mDocument.getChildCount(children);
+	mTree.nodes[index] = node;
+	return true;
+}
+
+bool CCBIPublisher::readAnimatedProperties(int dict, int properties, CCBINode &node)
+{
+	int animated = mDocument.find(dict, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_MAIN);
+
+	node.numAnimatedSequences = 0;
+	node.firstAnimatedProperty = mTree.animatedProperties.size();
+	node.firstEmptySequence = mTree.emptySequenceIds.size();
+
+	/*keyed by sequence id, then by property name*/
+	for (int sequence = -1 == animated ? -1 : mDocument.getFirstChild(animated); -1 != sequence; sequence = mDocument.getNext(sequence))
+	{
+		size_t keyLength;
+		const char *pKey = mDocument.getKey(sequence, keyLength);
+		int sequenceId = atoi(string(pKey, keyLength).c_str());
+
+		/*a sequence without properties is kept too, the runtime still sees it*/
+		node.numAnimatedSequences++;
+		if (0 == mDocument.getChildCount(sequence))
+		{
+			mTree.emptySequenceIds.push_back(sequenceId);
+			continue;
+		}
+
+		for (int prop = mDocument.getFirstChild(sequence); -1 != prop; prop = mDocument.getNext(prop))
+		{
+			CCBIAnimatedProperty animatedProp;
+			animatedProp.sequenceId = sequenceId;
+
+			size_t nameLength;
+			const char *pName = mDocument.getKey(prop, nameLength);
+			mContext.assign(pName, nameLength);
+			animatedProp.nameIndex = intern(pName, nameLength);
+
+			/*the ccbi wants the property type, taken from the property of the same name*/
+			animatedProp.type = -1;
+			for (int p = -1 == properties ? -1 : mDocument.getFirstChild(properties); -1 != p; p = mDocument.getNext(p))
+			{
+				size_t propNameLength, typeLength;
+				const char *pPropName = mDocument.getString(mDocument.find(p, CCBI_NODEGRAPH_PROPERTIES_KEY_NAME), propNameLength);
+				const char *pType = mDocument.getString(mDocument.find(p, CCBI_NODEGRAPH_PROPERTIES_KEY_TYPE), typeLength);
+				if (NULL != pPropName && NULL != pType && propNameLength == nameLength
+					&& 0 == memcmp(pPropName, pName, nameLength))
+				{
+					animatedProp.type = CCBIMainPropTypeName::getPropType(string(pType, typeLength).c_str());
+					break;
+				}
+			}
+			if (-1 == animatedProp.type)
+			{
+				long long keyframeType = -1;
+				mDocument.getInteger(mDocument.find(prop, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_TYPE), keyframeType);
+				animatedProp.type = getPropTypeOfKeyframeType((int)keyframeType);
+			}
+			if (-1 == animatedProp.type)
+			{
+				return fail("unknown animated property type");
+			}
+
+			int keyframes = mDocument.find(prop, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_KEYFRAMES);
+			animatedProp.firstKeyframe = mTree.keyframes.size();
+			for (int k = -1 == keyframes ? -1 : mDocument.getFirstChild(keyframes); -1 != k; k = mDocument.getNext(k))
+			{
+				CCBIKeyframe keyframe;
+				if (!readKeyframe(k, animatedProp.type, keyframe))
+				{
+					return false;
+				}
+				mTree.keyframes.push_back(keyframe);
+			}
+			animatedProp.numKeyframes = mTree.keyframes.size() - animatedProp.firstKeyframe;
+
+			mTree.animatedProperties.push_back(animatedProp);
+		}
+	}
+
+	node.numAnimatedProperties = mTree.animatedProperties.size() - node.firstAnimatedProperty;
+	node.numEmptySequences = mTree.emptySequenceIds.size() - node.firstEmptySequence;
+	return true;
+}
+
+bool CCBIPublisher::readKeyframe(int dict, int type, CCBIKeyframe &keyframe)
+{
+	double real = 0;
+	if (!mDocument.getReal(mDocument.find(dict, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_TIME), real))
+	{
+		return fail("keyframe without a time");
+	}
+	keyframe.time = (float)real;
+
+	int easing = mDocument.find(dict, "easing");
+	long long easingType = kCCBIKeyframeEasingLinear;
+	mDocument.getInteger(mDocument.find(easing, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_TYPE), easingType);
+	keyframe.easingType = (int)easingType;
+
+	/*CocosBuilder writes "opt", the ccb writer "Opt"*/
+	keyframe.easingOpt = 0;
+	if (CCBIReader::hasEasingOpt(keyframe.easingType))
+	{
+		int opt = mDocument.find(easing, "opt");
+		if (-1 == opt)
+		{
+			opt = mDocument.find(easing, "Opt");
+		}
+		if (mDocument.getReal(opt, real))
+		{
+			keyframe.easingOpt = (float)real;
+		}
+	}
+
+	int value = mDocument.find(dict, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_VALUE);
+	keyframe.firstValue = mTree.values.size();
+
+	bool ok = true;
+	if (type == kCCBIPropTypeCheck)
+	{
+		ok = pushBool(value);
+	}
+	else if (type == kCCBIPropTypeByte)
+	{
+		ok = pushInteger(value);
+	}
+	else if (type == kCCBIPropTypeColor3)
+	{
+		ok = pushInteger(getElement(value, 0)) && pushInteger(getElement(value, 1)) && pushInteger(getElement(value, 2));
+	}
+	else if (type == kCCBIPropTypeDegrees)
+	{
+		ok = pushReal(value);
+	}
+	else if (type == kCCBIPropTypeScaleLock || type == kCCBIPropTypePosition
+		|| type == kCCBIPropTypeFloatXY)
+	{
+		ok = pushReal(getElement(value, 0)) && pushReal(getElement(value, 1));
+	}
+	else if (type == kCCBIPropTypeSpriteFrame)
+	{
+		/*the ccb lists the sprite file before the sheet*/
+		ok = pushString(getElement(value, 1)) && pushString(getElement(value, 0));
+	}
+
+	if (!ok)
+	{
+		return fail("bad keyframe value");
+	}
+
+	keyframe.numValues = mTree.values.size() - keyframe.firstValue;
+	return true;
+}
+
+bool CCBIPublisher::readProperty(int dict, CCBIProperty &property)
+{
+	size_t length;
+	const char *pName = mDocument.getString(mDocument.find(dict, CCBI_NODEGRAPH_PROPERTIES_KEY_NAME), length);
+	if (NULL == pName)
+	{
+		return fail("property without a name");
+	}
+	mContext.assign(pName, length);
+	property.nameIndex = intern(pName, length);
+
+	const char *pType = mDocument.getString(mDocument.find(dict, CCBI_NODEGRAPH_PROPERTIES_KEY_TYPE), length);
+	property.type = NULL == pType ? -1 : CCBIMainPropTypeName::getPropType(string(pType, length).c_str());
+	if (-1 == property.type)
+	{
+		return fail("unknown property type");
+	}
+
+	property.platform = kCCBIPlatformAll;
+	const char *pPlatform = mDocument.getString(mDocument.find(dict, "platform"), length);
+	if (NULL != pPlatform)
+	{
+		string platform(pPlatform, length);
+		if ("iOS" == platform)
+		{
+			property.platform = kCCBIPlatformIOS;
+		}
+		else if ("Mac" == platform)
+		{
+			property.platform = kCCBIPlatformMac;
+		}
+	}
+
+	property.firstValue = mTree.values.size();
+	if (!readPropertyValue(property.type, mDocument.find(dict, CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE)))
+	{
+		return fail("bad property value");
+	}
+	property.numValues = mTree.values.size() - property.firstValue;
+
+	return true;
+}
+
+bool CCBIPublisher::readCustomProperty(int dict, CCBIProperty &property)
+{
+	/*CocosBuilder keeps custom properties as text with a type of 0 int, 1 float, 2 bool, 3 string*/
+	enum
+	{
+		kCustomInteger,
+		kCustomFloat,
+		kCustomBool,
+		kCustomString
+	};
+
+	size_t length;
+	const char *pName = mDocument.getString(mDocument.find(dict, CCBI_NODEGRAPH_PROPERTIES_KEY_NAME), length);
+	if (NULL == pName)
+	{
+		return fail("custom property without a name");
+	}
+	mContext.assign(pName, length);
+	property.nameIndex = intern(pName, length);
+	property.platform = kCCBIPlatformAll;
+
+	long long customType = kCustomString;
+	mDocument.getInteger(mDocument.find(dict, CCBI_NODEGRAPH_PROPERTIES_KEY_TYPE), customType);
+
+	int value = mDocument.find(dict, CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE);
+	const char *pText = mDocument.getString(value, length);
+	string text = NULL == pText ? string() : string(pText, length);
+
+	property.firstValue = mTree.values.size();
+	CCBIValue field;
+	switch (customType)
+	{
+	case kCustomInteger:
+		property.type = kCCBIPropTypeInteger;
+		field.i = atoi(text.c_str());
+		mTree.values.push_back(field);
+		break;
+	case kCustomFloat:
+		property.type = kCCBIPropTypeFloat;
+		field.f = (float)atof(text.c_str());
+		mTree.values.push_back(field);
+		break;
+	case kCustomBool:
+		property.type = kCCBIPropTypeCheck;
+		field.i = (0 != atoi(text.c_str()) || "true" == text) ? 1 : 0;
+		mTree.values.push_back(field);
+		break;
+	default:
+		property.type = kCCBIPropTypeString;
+		field.i = intern(text.data(), text.size());
+		mStringValues.push_back(mTree.values.push_back(field));
+		break;
+	}
+	property.numValues = mTree.values.size() - property.firstValue;
+
+	return true;
+}
+
+bool CCBIPublisher::readPropertyValue(int type, int value)
+{
+	switch (type)
+	{
+	case kCCBIPropTypePosition:
+	case kCCBIPropTypeSize:
+		return pushReal(getElement(value, 0)) && pushReal(getElement(value, 1)) && pushInteger(getElement(value, 2));
+	case kCCBIPropTypeScaleLock:
+	{
+		/*[x, y, locked, type], the lock is not part of the ccbi*/
+		if (!pushReal(getElement(value, 0)) || !pushReal(getElement(value, 1)))
+		{
+			return false;
+		}
+		int scaleType = getElement(value, 3);
+		if (-1 == scaleType)
+		{
+			CCBIValue field;
+			field.i = kCCBIScaleTypeAbsolute;
+			mTree.values.push_back(field);
+			return true;
+		}
+		return pushInteger(scaleType);
+	}
+	case kCCBIPropTypePoint:
+	case kCCBIPropTypePointLock:
+	case kCCBIPropTypeFloatXY:
+	case kCCBIPropTypeFloatVar:
+		return pushReal(getElement(value, 0)) && pushReal(getElement(value, 1));
+	case kCCBIPropTypeFloat:
+	case kCCBIPropTypeDegrees:
+		return pushReal(value);
+	case kCCBIPropTypeFloatScale:
+		return pushReal(getElement(value, 0)) && pushInteger(getElement(value, 1));
+	case kCCBIPropTypeInteger:
+	case kCCBIPropTypeIntegerLabeled:
+	case kCCBIPropTypeByte:
+		return pushInteger(value);
+	case kCCBIPropTypeCheck:
+		return pushBool(value);
+	case kCCBIPropTypeSpriteFrame:
+	case kCCBIPropTypeAnimation:
+		return pushString(getElement(value, 0)) && pushString(getElement(value, 1));
+	case kCCBIPropTypeTexture:
+	case kCCBIPropTypeFntFile:
+	case kCCBIPropTypeFontTTF:
+	case kCCBIPropTypeString:
+	case kCCBIPropTypeText:
+	case kCCBIPropTypeCCBIFile:
+		/*some CocosBuilder versions wrap text as [text, localized]*/
+		return pushString(getElement(value, 0));
+	case kCCBIPropTypeColor3:
+		return pushInteger(getElement(value, 0)) && pushInteger(getElement(value, 1)) && pushInteger(getElement(value, 2));
+	case kCCBIPropTypeColor4FVar:
+	{
+		/*8 reals, or [[r, g, b, a], [variance r, g, b, a]]*/
+		if (2 == mDocument.getChildCount(value) && CCBIPlistDocument::kTypeArray == mDocument.getType(getElement(value, 0)))
+		{
+			for (int c = 0; c < 8; c++)
+			{
+				if (!pushReal(getElement(getElement(value, c / 4), c % 4)))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		for (int c = 0; c < 8; c++)
+		{
+			if (!pushReal(getElement(value, c)))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	case kCCBIPropTypeFlip:
+		return pushBool(getElement(value, 0)) && pushBool(getElement(value, 1));
+	case kCCBIPropTypeBlendmode:
+		return pushInteger(getElement(value, 0)) && pushInteger(getElement(value, 1));
+	case kCCBIPropTypeBlock:
+		return pushString(getElement(value, 0)) && pushInteger(getElement(value, 1));
+	case kCCBIPropTypeBlockCCControl:
+		return pushString(getElement(value, 0)) && pushInteger(getElement(value, 1)) && pushInteger(getElement(value, 2));
+	default:
+		return false;
+	}
+}
+
+bool CCBIPublisher::pushReal(int value)
+{
+	double real;
+	if (!mDocument.getReal(value, real))
+	{
+		return false;
+	}
+
+	CCBIValue field;
+	field.f = (float)real;
+	mTree.values.push_back(field);
+	return true;
+}
+
+bool CCBIPublisher::pushInteger(int value)
+{
+	long long integer;
+	if (!mDocument.getInteger(value, integer))
+	{
+		return false;
+	}
+
+	CCBIValue field;
+	field.i = (int)integer;
+	mTree.values.push_back(field);
+	return true;
+}
+
+bool CCBIPublisher::pushBool(int value)
+{
+	bool flag;
+	if (!mDocument.getBool(value, flag))
+	{
+		return false;
+	}
+
+	CCBIValue field;
+	field.i = flag ? 1 : 0;
+	mTree.values.push_back(field);
+	return true;
+}
+
+bool CCBIPublisher::pushString(int value)
+{
+	CCBIValue field;
+	if (!readStringIndex(value, field.i))
+	{
+		return false;
+	}
+
+	mStringValues.push_back(mTree.values.push_back(field));
+	return true;
+}
+
+void CCBIPublisher::sortStrings()
+{
+	int count = (int)mStrings.size();
+
+	vector<int> order(count);
+	for (int i = 0; i < count; i++)
+	{
+		order[i] = i;
+	}
+	CCBIStringUseLess less;
+	less.pUses = &mStringUses;
+	sort(order.begin(), order.end(), less);
+
+	vector<int> remap(count);
+	for (int i = 0; i < count; i++)
+	{
+		remap[order[i]] = i;
+	}
+
+	/*the bytes move into the tree's arena, so the tree stands alone*/
+	char *pBytes = (char*)mTree.getArena().alloc(mStringBytes.empty() ? 1 : mStringBytes.size(), 1);
+	if (!mStringBytes.empty())
+	{
+		memcpy(pBytes, &mStringBytes[0], mStringBytes.size());
+	}
+	mTree.stringBase = pBytes;
+	mTree.strings.reserve(count);
+	for (int i = 0; i < count; i++)
+	{
+		mTree.strings.push_back(mStrings[order[i]]);
+	}
+
+	/*every field holding a string index*/
+	for (int i = 0; i < mTree.sequences.size(); i++)
+	{
+		mTree.sequences[i].nameIndex = remap[mTree.sequences[i].nameIndex];
+	}
+	for (int i = 0; i < mTree.callbackKeyframes.size(); i++)
+	{
+		mTree.callbackKeyframes[i].nameIndex = remap[mTree.callbackKeyframes[i].nameIndex];
+	}
+	for (int i = 0; i < mTree.soundKeyframes.size(); i++)
+	{
+		mTree.soundKeyframes[i].fileIndex = remap[mTree.soundKeyframes[i].fileIndex];
+	}
+	for (int i = 0; i < mTree.nodes.size(); i++)
+	{
+		CCBINode &node = mTree.nodes[i];
+		node.classNameIndex = remap[node.classNameIndex];
+		if (-1 != node.jsControlledNameIndex)
+		{
+			node.jsControlledNameIndex = remap[node.jsControlledNameIndex];
+		}
+		if (-1 != node.memberVarAssignmentNameIndex)
+		{
+			node.memberVarAssignmentNameIndex = remap[node.memberVarAssignmentNameIndex];
+		}
+	}
+	for (int i = 0; i < mTree.animatedProperties.size(); i++)
+	{
+		mTree.animatedProperties[i].nameIndex = remap[mTree.animatedProperties[i].nameIndex];
+	}
+	for (int i = 0; i < mTree.properties.size(); i++)
+	{
+		mTree.properties[i].nameIndex = remap[mTree.properties[i].nameIndex];
+	}
+	for (size_t i = 0; i < mStringValues.size(); i++)
+	{
+		CCBIValue &field = mTree.values[mStringValues[i]];
+		field.i = remap[field.i];
+	}
+}
@@ -0,0 +1,86 @@
+#ifndef _CCBII_CCBIPublisher_H_
+#define _CCBII_CCBIPublisher_H_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "CBITree.h"
+#include "CBIPlistDocument.h"
+
+/**
+* @brief Turn a parsed ccb document into the CCBITree of its ccbi
+*
+* The reverse of CCBIXMLEmitter, it also reads the parts of a CocosBuilder
+* ccb the emitter does not write: callback and sound keyframes, the
+* platform of a property and the custom properties of a node.
+*
+* Like the CocosBuilder publisher, the string cache is ordered by how often
+* each string is used, so the most common strings get the shortest codes.
+*/
+class CCBIPublisher
+{
+private:
+	const CCBIPlistDocument &mDocument;
+	CCBITree &mTree;
+	std::string mError;
+	int mMaxDepth;
+
+	/*strings in order of first use, and their uses*/
+	std::vector<char> mStringBytes;
+	std::vector<CCBIString> mStrings;
+	std::vector<int> mStringUses;
+	std::unordered_map<std::string, int> mStringIndices;
+	/*entries of mTree.values holding a string index*/
+	std::vector<int> mStringValues;
+
+	/*name of the property being read, for the error message*/
+	std::string mContext;
+
+public:
+	CCBIPublisher(const CCBIPlistDocument &document, CCBITree &tree);
+
+	/**
+	* @brief Fill the tree from the document
+	* @return false if the document is not a ccb, see getError()
+	*/
+	bool build();
+
+	/**
+	* @brief Levels of node graph to accept, the root being level 1, like
+	* CCBIReader::setMaxDepth(); a deeper graph fails the build
+	*/
+	void setMaxDepth(int maxDepth);
+
+	const std::string& getError() const;
+
+private:
+	bool fail(const char *pMessage);
+
+	int intern(const char *pString, size_t length);
+	bool readStringIndex(int value, int &index);
+
+	bool readSequences(int root);
+	/*the node graph is walked with an explicit stack, a deep one must not exhaust the call stack*/
+	bool readNodeGraph(int root);
+	/*everything of a node but its children, which are left in the children array*/
+	bool readNode(int dict, int parent, int &index, int &children);
+	bool readAnimatedProperties(int dict, int properties, CCBINode &node);
+	bool readKeyframe(int dict, int type, CCBIKeyframe &keyframe);
+	bool readProperty(int dict, CCBIProperty &property);
+	bool readCustomProperty(int dict, CCBIProperty &property);
+	bool readPropertyValue(int type, int value);
+
+	/*append one field to the tree's value array*/
+	bool pushReal(int value);
+	bool pushInteger(int value);
+	bool pushBool(int value);
+	bool pushString(int value);
+
+	/*element i of an array value, or the value itself for i == 0*/
+	int getElement(int value, int index) const;
+
+	void sortStrings();
+};
+
+#endif
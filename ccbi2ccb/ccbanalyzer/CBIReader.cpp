@@ -1,28 +1,156 @@
 #include "ccbimapping.h"
 #include "CBIReader.h"
+#include "CBIBitReader.h"
+#include "CBIPropertyCodec.h"
 #include "../util/include/ssMacro.h"
 #include "../util/log/ssLog.h"
 
 #include <algorithm>
+#include <vector>
 
 #include <ctype.h>
 
 #include <fstream>
 
+#include <stdio.h>
+#include <string.h>
+
 using namespace std;
 
+/*initial size of the window over a stream, it grows for longer strings*/
+static const size_t kStreamWindowSize = 64 * 1024;
+
+/*
+* The longest encoding of every record. A record starting at least this far
+* from the end of the input is decoded without checking it.
+*/
+static const size_t kMaxFloatBytes = 1 + kCCBIMaxIntBytes;
+static const size_t kMaxNodeHeadBytes = 5 * kCCBIMaxIntBytes;
+static const size_t kMaxPropertyBytes = 2 * kCCBIMaxIntBytes + 1 + kCCBIMaxValueFields * kMaxFloatBytes;
+static const size_t kMaxKeyframeBytes = 2 * kMaxFloatBytes + kCCBIMaxIntBytes + kCCBIMaxValueFields * kMaxFloatBytes;
+static const size_t kMaxSequenceBytes = kMaxFloatBytes + 3 * kCCBIMaxIntBytes;
+static const size_t kMaxCallbackKeyframeBytes = kMaxFloatBytes + 2 * kCCBIMaxIntBytes;
+static const size_t kMaxSoundKeyframeBytes = 4 * kMaxFloatBytes + kCCBIMaxIntBytes;
+
 /*************************************************************************
 Implementation of CCBIReader
 *************************************************************************/
-CCBIReader::CCBIReader(const char *pCCBIFile, const char *pOutCCBFile)
+CCBIReader::CCBIReader(const char *pCCBIFile, bool useMappedInput)
+: mBytes(NULL)
+, mCursor(NULL)
+, mEnd(NULL)
+, mCurrentBit(0)
+, mOwnedBytes(NULL)
+, mStream(NULL)
+, mWindowCapacity(0)
+, mStreamOffset(0)
+, mTruncated(false)
+, mNodeGraphStarted(false)
+, mMaxDepth(kCCBIDefaultMaxDepth)
+, mTooDeep(false)
+, mpSection("the header")
+, mpNode(NULL)
+, mPropertyNameIndex(-1)
+, mFailed(false)
+, mErrorOffset(0)
+, jsControlled(false)
+{
+	if (useMappedInput)
+	{
+		/*decode from the mapping directly, no copy of the file content*/
+		if (mMappedFile.open(pCCBIFile))
+		{
+			mBytes = mMappedFile.getBytes();
+			mCursor = mBytes;
+			mEnd = mBytes + mMappedFile.getLength();
+		}
+		else
+		{
+			SSLog("WARNING! Can not map %s, fall back to buffered reading", pCCBIFile);
+			loadBuffered(pCCBIFile);
+		}
+	}
+	else
+	{
+		loadBuffered(pCCBIFile);
+	}
+}
+
+CCBIReader::CCBIReader(FILE *pStream)
+: mBytes(NULL)
+, mCursor(NULL)
+, mEnd(NULL)
+, mCurrentBit(0)
+, mOwnedBytes(NULL)
+, mStream(pStream)
+, mWindowCapacity(kStreamWindowSize)
+, mStreamOffset(0)
+, mTruncated(false)
+, mNodeGraphStarted(false)
+, mMaxDepth(kCCBIDefaultMaxDepth)
+, mTooDeep(false)
+, mpSection("the header")
+, mpNode(NULL)
+, mPropertyNameIndex(-1)
+, mFailed(false)
+, mErrorOffset(0)
+, jsControlled(false)
+{
+	mOwnedBytes = new unsigned char[mWindowCapacity];
+	mBytes = mOwnedBytes;
+	mCursor = mBytes;
+	mEnd = mBytes;
+	refill(0);
+}
+
+CCBIReader::CCBIReader(const unsigned char *pBytes, size_t length)
+: mBytes(pBytes)
+, mCursor(pBytes)
+, mEnd(NULL == pBytes ? NULL : pBytes + length)
+, mCurrentBit(0)
+, mOwnedBytes(NULL)
+, mStream(NULL)
+, mWindowCapacity(0)
+, mStreamOffset(0)
+, mTruncated(false)
+, mNodeGraphStarted(false)
+, mMaxDepth(kCCBIDefaultMaxDepth)
+, mTooDeep(false)
+, mpSection("the header")
+, mpNode(NULL)
+, mPropertyNameIndex(-1)
+, mFailed(false)
+, mErrorOffset(0)
+, jsControlled(false)
+{
+}
+
+CCBIReader::~CCBIReader() {
+	// Release the decoded tree.
+	this->mTree.clear();
+
+	delete[] mOwnedBytes;
+	mOwnedBytes = NULL;
+	mBytes = NULL;
+}
+
+bool CCBIReader::loadBuffered(const char *pCCBIFile)
 {
 	int readbytes = 0;
 
 	ifstream fccbi(pCCBIFile, (ios::in | ios::binary));
+	if (!fccbi.is_open())
+	{
+		return false;
+	}
 
 	/*caculate the length of ccbi file*/
 	fccbi.seekg(0, ios::end);
-	int len = fccbi.tellg();
+	int len = (int)fccbi.tellg();
+	if (len <= 0)
+	{
+		return false;
+	}
 
 	/*apply the memory buff to store the file content*/
 	char *filebuff = new char[len];
@@ -32,84 +160,338 @@ CCBIReader::CCBIReader(const char *pCCBIFile, const char *pOutCCBFile)
 	while ((!fccbi.eof())
 		&& (readbytes < len))
 	{
-		fccbi.read(filebuff, (len - readbytes));
+		fccbi.read(filebuff + readbytes, (len - readbytes));
+		readbytes += (int)fccbi.gcount();
+
 		if (fccbi.fail())
-		{			
-			return;
+		{
+			delete[] filebuff;
+			return false;
+		}
+	}
+
+	mOwnedBytes = (unsigned char*)filebuff;
+	mBytes = mOwnedBytes;
+	mCursor = mBytes;
+	mEnd = mBytes + len;
+
+	return true;
+}
+
+bool CCBIReader::refill(size_t count)
+{
+	size_t unread = (size_t)(mEnd - mCursor);
+	size_t consumed = (size_t)(mCursor - mBytes);
+
+	if (count > mWindowCapacity)
+	{
+		/*a string longer than the window*/
+		while (mWindowCapacity < count)
+		{
+			mWindowCapacity *= 2;
 		}
+		unsigned char *window = new unsigned char[mWindowCapacity];
+		memcpy(window, mCursor, unread);
+		delete[] mOwnedBytes;
+		mOwnedBytes = window;
+	}
+	else
+	{
+		memmove(mOwnedBytes, mCursor, unread);
+	}
 
-		readbytes += fccbi.gcount();
+	mStreamOffset += consumed;
+	mBytes = mOwnedBytes;
+	mCursor = mBytes;
+
+	size_t length = unread;
+	while (length < mWindowCapacity)
+	{
+		size_t numRead = fread(mOwnedBytes + length, 1, mWindowCapacity - length, mStream);
+		if (0 == numRead)
+		{
+			break;
+		}
+		length += numRead;
 	}
+	mEnd = mBytes + length;
 
-	mBytes = (unsigned char*)filebuff;
-	mCurrentByte = 0;
-	mCurrentBit = 0;
+	return length >= count;
+}
 
-	/*open the local file to be ready to write into the converted data*/
-	outccb.open(pOutCCBFile, std::ios::out);
+bool CCBIReader::isTruncated() const
+{
+	return mTruncated;
 }
 
-CCBIReader::~CCBIReader() {
-	// Clear string cache.
-	this->mStringCache.clear();
+bool CCBIReader::isTooDeep() const
+{
+	return mTooDeep;
+}
+
+bool CCBIReader::hasFailed() const
+{
+	return mFailed;
+}
+
+const std::string& CCBIReader::getError() const
+{
+	return mError;
+}
+
+unsigned long long CCBIReader::getErrorOffset() const
+{
+	return mErrorOffset;
+}
+
+const std::string& CCBIReader::getErrorNodePath() const
+{
+	return mErrorNodePath;
+}
+
+const std::string& CCBIReader::getErrorProperty() const
+{
+	return mErrorProperty;
+}
+
+std::string CCBIReader::describeError() const
+{
+	char offset[32];
+	sprintf(offset, "offset %llu", mErrorOffset);
+
+	std::string text = offset;
+	if (!mErrorNodePath.empty())
+	{
+		text += ", node " + mErrorNodePath;
+	}
+	if (!mErrorProperty.empty())
+	{
+		text += ", property '" + mErrorProperty + "'";
+	}
+	return text + ": " + mError;
+}
+
+unsigned long long CCBIReader::getOffset(const unsigned char *pAt) const
+{
+	return mStreamOffset + (size_t)(pAt - mBytes);
+}
+
+bool CCBIReader::fail(unsigned long long offset, const char *pMessage)
+{
+	if (!mFailed)
+	{
+		mFailed = true;
+		mError = pMessage;
+		mErrorOffset = offset;
+		mErrorNodePath = getNodePath();
+		if (mPropertyNameIndex >= 0)
+		{
+			CCBIStringView name = mTree.getString(mPropertyNameIndex);
+			mErrorProperty.assign(name.pChars, name.length);
+		}
+	}
+	return false;
+}
+
+bool CCBIReader::failTruncated()
+{
+	mTruncated = true;
+	return fail(getOffset(mCursor), (std::string("the input ends inside ") + mpSection).c_str());
+}
+
+std::string CCBIReader::getNodeName(const CCBINode &node) const
+{
+	std::string name = "?";
+	if (node.classNameIndex >= 0)
+	{
+		CCBIStringView className = mTree.getString(node.classNameIndex);
+		name.assign(className.pChars, className.length);
+	}
+	if (node.memberVarAssignmentNameIndex >= 0)
+	{
+		CCBIStringView member = mTree.getString(node.memberVarAssignmentNameIndex);
+		name += "(" + std::string(member.pChars, member.length) + ")";
+	}
+	return name;
+}
+
+std::string CCBIReader::getNodePath() const
+{
+	/*the open frames are the ancestors of the node being read*/
+	std::string path;
+	for (size_t i = 0; i <= mFrames.size(); i++)
+	{
+		const CCBINode *pNode = i < mFrames.size() ? &mTree.nodes[mFrames[i].index] : mpNode;
+		if (NULL == pNode)
+		{
+			break;
+		}
+
+		if (i > 0)
+		{
+			const NodeFrame &parent = mFrames[i - 1];
+			char child[16];
+			sprintf(child, "[%d]", mTree.nodes[parent.index].numChildren - parent.pendingChildren - 1);
+			path += "/" + getNodeName(*pNode) + child;
+		}
+		else
+		{
+			path = getNodeName(*pNode);
+		}
+	}
+	return path;
+}
+
+void CCBIReader::setMaxDepth(int maxDepth)
+{
+	mMaxDepth = maxDepth;
+}
+
+int CCBIReader::getMaxDepth() const
+{
+	return mMaxDepth;
+}
+
+void CCBIReader::setCCBIRootPath(const char* pCCBIRootPath)
+{
+	mCCBIRootPath = pCCBIRootPath;
+}
+
+const std::string& CCBIReader::getCCBIRootPath() const
+{
+	return mCCBIRootPath;
+}
+
+void CCBIReader::getCCBIFileReferences(std::vector<std::string> &files) const
+{
+	std::set<int> seen;
+	for (int i = 0; i < mTree.properties.size(); i++)
+	{
+		const CCBIProperty &property = mTree.properties[i];
+		if (kCCBIPropTypeCCBIFile != property.type || !seen.insert(mTree.values[property.firstValue].i).second)
+		{
+			continue;
+		}
+
+		CCBIStringView name = mTree.getString(mTree.values[property.firstValue].i);
+		if (0 == name.length)
+		{
+			continue;
+		}
+
+		std::string path = mCCBIRootPath + std::string(name.pChars, name.length);
+		files.push_back(deletePathExtension(path.c_str()) + ".ccbi");
+	}
+}
+
+const unsigned char* CCBIReader::getBytes() const
+{
+	return mBytes;
+}
+
+size_t CCBIReader::getLength() const
+{
+	return (size_t)(mEnd - mBytes);
+}
+
+unsigned long long CCBIReader::getPosition() const
+{
+	/*a byte being read bit by bit counts as consumed*/
+	return getOffset(mCursor) + (0 != mCurrentBit ? 1 : 0);
+}
+
+const CCBITree& CCBIReader::getTree() const
+{
+	return mTree;
 }
 
 bool CCBIReader::readStringCache() {
-	int numStrings = this->readInt(false);
+	mpSection = "the string cache";
 
-	for (int i = 0; i < numStrings; i++) {
-		this->mStringCache.push_back(this->readUTF8());
+	need(kCCBIMaxIntBytes);
+	int numStrings = this->nextInt(false);
+
+	/*the entries only point into the input, nothing is copied; a stream
+	window moves on, so there they are copied out of it*/
+	this->mTree.stringBase = (const char*)this->mBytes;
+	/*every entry takes its two length bytes, a larger count is not reserved*/
+	if (NULL == mStream && numStrings > 0 && (size_t)numStrings <= (size_t)(mEnd - mCursor) / 2) {
+		this->mTree.strings.reserve(numStrings);
 	}
+	for (int i = 0; i < numStrings && !mFailed; i++) {
+		CCBIStringView view = this->readUTF8View();
 
-	return true;
+		CCBIString string;
+		string.length = (unsigned int)view.length;
+		if (NULL == mStream) {
+			string.offset = (unsigned int)(view.pChars - this->mTree.stringBase);
+		}
+		else {
+			string.offset = (unsigned int)mStringBytes.size();
+			mStringBytes.insert(mStringBytes.end(), view.pChars, view.pChars + view.length);
+		}
+		this->mTree.strings.push_back(string);
+	}
+
+	if (NULL != mStream) {
+		this->mTree.stringBase = mStringBytes.empty() ? NULL : &mStringBytes[0];
+	}
+
+	return !mFailed;
 }
 
 bool CCBIReader::readHeader()
 {
 	/* If no bytes loaded, don't crash about it. */
 	if (this->mBytes == NULL) {
-		return false;
+		return fail(0, "no input");
 	}
+	mpSection = "the header";
 
 	/* Read magic bytes */
-	int magicBytes = *((int*)(this->mBytes + this->mCurrentByte));
-	this->mCurrentByte += 4;
+	if (!this->need(4)) {
+		return failTruncated();
+	}
+	int magicBytes = *((const int*)this->mCursor);
 
 	if ((SS_SWAP_INT32_LITTLE_TO_HOST(magicBytes) != 'CCBI')
 		&& (SS_SWAP_INT32_LITTLE_TO_HOST(magicBytes) != 'ccbi')) {
-		return false;
+		return fail(getOffset(mCursor), "not a ccbi file");
 	}
+	this->mCursor += 4;
 
 	/* Read version. */
+	unsigned long long offset = getOffset(mCursor);
 	int version = this->readInt(false);
-	if (version != kCCBIVersion) {
-		SSLog("WARNING! Incompatible CCBIi file version (file: %d reader: %d)", version, kCCBIVersion);
+	if (mFailed) {
 		return false;
 	}
-
-	writeXMLHeadDefault();
-
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "jsControlled");
+	if (version != kCCBIVersion) {
+		char message[64];
+		sprintf(message, "version %d, only version %d is supported", version, kCCBIVersion);
+		return fail(offset, message);
+	}
 
 	// Read JS check
 	jsControlled = this->readBool();
 
-	if (true == jsControlled)
-	{
-		outccb << CCBI_XML_TAG_TRUE << endl;
-	}
-	else
-	{
-		outccb << CCBI_XML_TAG_FALSE << endl;
-	}
+	this->mTree.header.version = version;
+	this->mTree.header.jsControlled = jsControlled;
 
-	return true;
+	return !mFailed;
+}
+
+template <bool Checked>
+unsigned char CCBIReader::nextByte() {
+	if (Checked && !this->need(1)) {
+		failTruncated();
+		return 0;
+	}
+	return *this->mCursor++;
 }
 
 unsigned char CCBIReader::readByte() {
-	unsigned char byte = this->mBytes[this->mCurrentByte];
-	this->mCurrentByte++;
-	return byte;
+	return this->nextByte<true>();
 }
 
 bool CCBIReader::readBool() {
@@ -118,27 +500,46 @@ bool CCBIReader::readBool() {
 
 std::string CCBIReader::readUTF8()
 {
-	std::string ret;
+	CCBIStringView view = this->readUTF8View();
+	return std::string(view.pChars, view.length);
+}
 
-	int b0 = this->readByte();
-	int b1 = this->readByte();
+CCBIStringView CCBIReader::readUTF8View()
+{
+	CCBIStringView view;
+	view.pChars = "";
+	view.length = 0;
+
+	/* A string is a record of its own: its length, then its bytes. */
+	if (!this->need(2)) {
+		failTruncated();
+		return view;
+	}
+	size_t numBytes = (size_t)(mCursor[0] << 8 | mCursor[1]);
+	mCursor += 2;
 
-	int numBytes = b0 << 8 | b1;
+	if (!this->need(numBytes)) {
+		failTruncated();
+		return view;
+	}
 
-	char* pStr = (char*)malloc(numBytes + 1);
-	memcpy(pStr, mBytes + mCurrentByte, numBytes);
-	pStr[numBytes] = '\0';
-	ret = pStr;
-	free(pStr);
+	view.pChars = (const char*)mCursor;
+	view.length = numBytes;
 
-	mCurrentByte += numBytes;
+	mCursor += numBytes;
 
-	return ret;
+	return view;
 }
 
 bool CCBIReader::getBit() {
+	/* Past the end every bit reads as one, which ends a run of zero bits. */
+	if (!this->need(1)) {
+		failTruncated();
+		return true;
+	}
+
 	bool bit;
-	unsigned char byte = *(this->mBytes + this->mCurrentByte);
+	unsigned char byte = *this->mCursor;
 	if (byte & (1 << this->mCurrentBit)) {
 		bit = true;
 	}
@@ -150,7 +551,7 @@ bool CCBIReader::getBit() {
 
 	if (this->mCurrentBit >= 8) {
 		this->mCurrentBit = 0;
-		this->mCurrentByte++;
+		this->mCursor++;
 	}
 
 	return bit;
@@ -159,16 +560,64 @@ bool CCBIReader::getBit() {
 void CCBIReader::alignBits() {
 	if (this->mCurrentBit) {
 		this->mCurrentBit = 0;
-		this->mCurrentByte++;
+		this->mCursor++;
+	}
+}
+
+int CCBIReader::nextInt(bool pSigned) {
+	size_t pos = 0;
+	unsigned long long current = CCBIBitReader::readGamma(this->mCursor, (size_t)(this->mEnd - this->mCursor), pos);
+	if (0 == current) {
+		/*only a code running past the end, or starting with 64 or more zero bits, decodes to 0*/
+		size_t available = (size_t)(this->mEnd - this->mCursor);
+		bool tooLong = available >= 8;
+		for (size_t i = 0; i < 8 && tooLong; i++) {
+			tooLong = 0 == this->mCursor[i];
+		}
+		if (tooLong) {
+			fail(getOffset(this->mCursor), "an int of more than 64 bits");
+		}
+		else {
+			failTruncated();
+		}
+		return 0;
+	}
+	this->mCursor += pos;
+
+	return pSigned ? CCBIBitReader::toSigned(current) : CCBIBitReader::toUnsigned(current);
+}
+
+int CCBIReader::nextStringIndex() {
+	unsigned long long offset = getOffset(this->mCursor);
+	int index = this->nextInt(false);
+	if ((unsigned int)index >= (unsigned int)this->mTree.strings.size()) {
+		if (!mFailed) {
+			char message[64];
+			sprintf(message, "string %d is not in the string cache", index);
+			fail(offset, message);
+		}
+		return -1;
 	}
+	return index;
 }
 
 int CCBIReader::readInt(bool pSigned) {
+	/* Every int starts byte aligned, decode it from a 64 bit window. */
+	if (0 == this->mCurrentBit) {
+		/*the decoder stops at the end, a stream window only has to hold the int*/
+		this->need(kCCBIMaxIntBytes);
+		return this->nextInt(pSigned);
+	}
+
 	// Read encoded int
 	int numBits = 0;
 	while (!this->getBit()) {
 		numBits++;
 	}
+	if (numBits > 31) {
+		fail(getOffset(this->mCursor), "an int of more than 32 bits");
+		return 0;
+	}
 
 	long long current = 0;
 	for (int a = numBits - 1; a >= 0; a--) {
@@ -197,9 +646,9 @@ int CCBIReader::readInt(bool pSigned) {
 	return num;
 }
 
-
-float CCBIReader::readFloat() {
-	unsigned char type = this->readByte();
+template <bool Checked>
+float CCBIReader::nextFloat() {
+	unsigned char type = this->nextByte<Checked>();
 
 	switch (type) {
 	case kCCBIFloat0:
@@ -211,14 +660,18 @@ float CCBIReader::readFloat() {
 	case kCCBIFloat05:
 		return 0.5f;
 	case kCCBIFloatInteger:
-		return (float)this->readInt(true);
+		return (float)this->nextInt(true);
 	default:
 	{
 		/* using a memcpy since the compiler isn't
 		* doing the float ptr math correctly on device.
 		* TODO still applies in C++ ? */
-		unsigned char* pF = (this->mBytes + this->mCurrentByte);
 		float f = 0;
+		if (Checked && !this->need(sizeof(float))) {
+			failTruncated();
+			return f;
+		}
+		const unsigned char* pF = this->mCursor;
 
 		// N.B - in order to avoid an unaligned memory access crash on 'memcpy()' the the (void*) casts of the source and
 		// destination pointers are EXTREMELY important for the ARM compiler.
@@ -233,333 +686,444 @@ float CCBIReader::readFloat() {
 		// http://infocenter.arm.com/help/index.jsp?topic=/com.arm.doc.faqs/ka3934.html
 		memcpy((void*)&f, (const void*)pF, sizeof(float));
 
-		this->mCurrentByte += sizeof(float);
+		this->mCursor += sizeof(float);
 		return f;
 	}
 	}
 }
 
-std::string CCBIReader::readCachedString() {
-	int n = this->readInt(false);
-	return this->mStringCache[n];
+float CCBIReader::readFloat() {
+	return this->nextFloat<true>();
 }
 
-void CCBIReader::readNodeGraph() {
-	writeXMLDictStartTag();
+CCBIStringView CCBIReader::readCachedString() {
+	int index = this->readCachedStringIndex();
+	if (index < 0) {
+		CCBIStringView view = { "", 0 };
+		return view;
+	}
+	return this->mTree.getString(index);
+}
 
-	/* Read class name. */
-	std::string className = this->readCachedString();
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_KEY_BASE_CLASS) << endl;
-	outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << className.c_str() << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
+int CCBIReader::readCachedStringIndex() {
+	this->need(kCCBIMaxIntBytes);
+	return this->nextStringIndex();
+}
 
-	std::string jsControlledName;
+bool CCBIReader::readNodeGraph() {
+	mpSection = "the node graph";
+	mFrames.clear();
+	int parent = -1;
+
+	for (;;) {
+		/* The new node is one level below the open frames. */
+		if ((int)mFrames.size() >= mMaxDepth) {
+			char message[64];
+			sprintf(message, "the node graph is deeper than %d levels", mMaxDepth);
+			mTooDeep = true;
+			return fail(getOffset(mCursor), message);
+		}
 
-	if (jsControlled) {
-		jsControlledName = this->readCachedString();
-		//outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_KEY_JSCONTROLLER) << endl;
-		//outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << jsControlledName.c_str() << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-	}
+		CCBINode node;
+		node.parent = parent;
+		if (!readNodeFields(node)) {
+			return false;
+		}
+		node.subtreeEnd = this->mTree.nodes.size() + 1;
+		int index = this->mTree.nodes.push_back(node);
 
-	writeXMLNodegraphDefault();
+		if (node.numChildren > 0) {
+			NodeFrame frame = { index, node.numChildren };
+			mFrames.push_back(frame);
+		}
 
-	// Read assignment type and name
-	int memberVarAssignmentType = this->readInt(false);
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_KEY_MEMBERVARASSIGNMENTTYPE) << endl;
-	outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << memberVarAssignmentType << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
+		/* Close the subtrees this node completes, then go on with the next child. */
+		while (!mFrames.empty() && 0 == mFrames.back().pendingChildren) {
+			this->mTree.nodes[mFrames.back().index].subtreeEnd = this->mTree.nodes.size();
+			mFrames.pop_back();
+		}
+		if (mFrames.empty()) {
+			return true;
+		}
 
-	std::string memberVarAssignmentName;
-	if (memberVarAssignmentType != kCCBITargetTypeNone) {
-		memberVarAssignmentName = this->readCachedString();
+		mFrames.back().pendingChildren--;
+		parent = mFrames.back().index;
+	}
+}
 
-		outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_KEY_MEMBERVARASSIGNMENTNAME) << endl;
-		outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << memberVarAssignmentName.c_str() << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
+int CCBIReader::readNodeEvent(int &index) {
+	mpSection = "the node graph";
+	int depth = 0;
+	if (mNodeGraphStarted) {
+		if (mFrames.empty()) {
+			return kCCBINodeGraphEnd;
+		}
+		if (0 == mFrames.back().pendingChildren) {
+			mFrames.pop_back();
+			index = (int)mFrames.size();
+			return kCCBINodeEnd;
+		}
+		mFrames.back().pendingChildren--;
+		depth = (int)mFrames.size();
+	}
+	mNodeGraphStarted = true;
+
+	if (depth >= mMaxDepth) {
+		char message[64];
+		sprintf(message, "the node graph is deeper than %d levels", mMaxDepth);
+		mTooDeep = true;
+		fail(getOffset(mCursor), message);
+		return kCCBINodeGraphError;
 	}
 
-	// Read animated properties
-	int numSequence = readInt(false);
-	if (0 != numSequence)
-	{
-		outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_MAIN) << endl;
-		writeXMLDictStartTag();
-		outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "0") << endl;
-		writeXMLDictStartTag();
+	/* Only the path down to the new node is kept. */
+	this->mTree.nodes.truncate(depth);
+	this->mTree.animatedProperties.truncate(0);
+	this->mTree.emptySequenceIds.truncate(0);
+	this->mTree.keyframes.truncate(0);
+	this->mTree.properties.truncate(0);
+	this->mTree.values.truncate(0);
+
+	CCBINode node;
+	node.parent = depth - 1;
+	node.subtreeEnd = -1;
+	if (!readNodeFields(node)) {
+		return kCCBINodeGraphError;
 	}
-	for (int i = 0; i < numSequence; ++i)
-	{
-		int seqId = readInt(false);
 
-		int numProps = readInt(false);
+	index = this->mTree.nodes.push_back(node);
+	NodeFrame frame = { index, node.numChildren > 0 ? node.numChildren : 0 };
+	mFrames.push_back(frame);
 
-		for (int j = 0; j < numProps; ++j)
-		{
-			std::string animatedProp = this->readCachedString();
-			const char *nameProp = animatedProp.c_str();
-			outccb << XML_START_TAG(CCBI_XML_TAG_KEY) << nameProp << XML_END_TAG(CCBI_XML_TAG_KEY) << endl;
+	return kCCBINodeStart;
+}
+
+bool CCBIReader::skipNodeSubtree() {
+	/* The frame of the node stays open, its children are read and dropped. */
+	size_t depth = mFrames.size();
+	int index;
+	while (mFrames.size() > depth || 0 != mFrames.back().pendingChildren) {
+		if (kCCBINodeGraphError == readNodeEvent(index)) {
+			return false;
+		}
+	}
+	return true;
+}
 
-			int typeProp = readInt(false);
+bool CCBIReader::seekNode(unsigned long long offset) {
+	if (NULL != mStream || mFailed || offset >= (unsigned long long)(mEnd - mBytes)) {
+		return false;
+	}
 
-			int numKeyframes = readInt(false);
+	this->mCursor = this->mBytes + offset;
+	this->mCurrentBit = 0;
+	mFrames.clear();
+	mNodeGraphStarted = false;
+	return true;
+}
 
-			/*convert to the value used for CCB xml file*/
-			int convertType = CCBIMainPropTypeName::getAnimatedPropTypeValue(typeProp);
+bool CCBIReader::readNodeFields(CCBINode &node) {
+	/* Nothing of the node is known yet, for an error on the way. */
+	node.classNameIndex = -1;
+	node.memberVarAssignmentNameIndex = -1;
+	mpNode = &node;
 
-			writeXMLDictStartTag();
-			outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_KEYFRAMES) << endl;
-			writeXMLArrayStartTag();
-			for (int k = 0; k < numKeyframes; ++k)
-			{
-				writeXMLDictStartTag();
-				readKeyframe(typeProp, nameProp);
-				writeXMLDictEndTag();
-			}
-			writeXMLArrayEndTag();
+	/* Read class name. */
+	this->need(kMaxNodeHeadBytes);
+	node.classNameIndex = this->nextStringIndex();
 
-			outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_NAME) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << nameProp << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
+	node.jsControlledNameIndex = -1;
+	if (jsControlled) {
+		node.jsControlledNameIndex = this->nextStringIndex();
+	}
 
-			outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_TYPE) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << convertType << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
+	// Read assignment type and name
+	node.memberVarAssignmentType = this->nextInt(false);
 
-			writeXMLDictEndTag();
-		}
+	if (node.memberVarAssignmentType != kCCBITargetTypeNone) {
+		node.memberVarAssignmentNameIndex = this->nextStringIndex();
 	}
 
-	if (0 != numSequence)
+	// Read animated properties
+	node.numAnimatedSequences = this->nextInt(false);
+	node.firstAnimatedProperty = this->mTree.animatedProperties.size();
+	node.firstEmptySequence = this->mTree.emptySequenceIds.size();
+	for (int i = 0; i < node.numAnimatedSequences && !mFailed; ++i)
 	{
-		writeXMLDictEndTag();
-		writeXMLDictEndTag();
-	}
+		this->need(2 * kCCBIMaxIntBytes);
+		int seqId = this->nextInt(false);
 
-	// Read properties
-	parseProperties();
+		int numProps = this->nextInt(false);
+		if (0 == numProps)
+		{
+			this->mTree.emptySequenceIds.push_back(seqId);
+		}
 
-	/* Read and add children. */
-	int numChildren = this->readInt(false);
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_KEY_CHILDREN) << endl;
-	if (0 != numChildren)
-	{
-		writeXMLArrayStartTag();
-		for (int i = 0; i < numChildren; i++) {
-			readNodeGraph();
+		for (int j = 0; j < numProps && !mFailed; ++j)
+		{
+			this->need(3 * kCCBIMaxIntBytes);
+			CCBIAnimatedProperty animatedProp;
+			animatedProp.sequenceId = seqId;
+			animatedProp.nameIndex = this->nextStringIndex();
+			unsigned long long typeOffset = getOffset(this->mCursor);
+			animatedProp.type = this->nextInt(false);
+			animatedProp.numKeyframes = this->nextInt(false);
+			animatedProp.firstKeyframe = this->mTree.keyframes.size();
+
+			mPropertyNameIndex = animatedProp.nameIndex;
+			if (!mFailed && (animatedProp.type < 0 || animatedProp.type >= kCCBIPropTypeMAX))
+			{
+				/*the emitters look the type up, and its keyframe size is unknown*/
+				char message[64];
+				sprintf(message, "unknown animated property type %d", animatedProp.type);
+				fail(typeOffset, message);
+				break;
+			}
+			for (int k = 0; k < animatedProp.numKeyframes && !mFailed; ++k)
+			{
+				CCBIKeyframe keyframe;
+				readKeyframe(animatedProp.type, keyframe);
+				this->mTree.keyframes.push_back(keyframe);
+			}
+			mPropertyNameIndex = -1;
+
+			this->mTree.animatedProperties.push_back(animatedProp);
 		}
-		writeXMLArrayEndTag();
 	}
-	else
+	node.numAnimatedProperties = this->mTree.animatedProperties.size() - node.firstAnimatedProperty;
+	node.numEmptySequences = this->mTree.emptySequenceIds.size() - node.firstEmptySequence;
+
+	// Read properties
+	if (!mFailed && parseProperties(node)) {
+		this->need(kCCBIMaxIntBytes);
+		node.numChildren = this->nextInt(false);
+	}
+
+	mpNode = NULL;
+	return !mFailed;
+}
+
+template <bool Checked, char Field>
+void CCBIReader::readValue()
+{
+	CCBIValue value;
+
+	/*Field is a constant, only one case is left of the switch*/
+	switch (Field)
 	{
-		outccb << CCBI_XML_TAG_ARRAT_SIMPLE << endl;
+	case kCCBIFieldFloat:
+		value.f = nextFloat<Checked>();
+		break;
+	case kCCBIFieldSigned:
+		value.i = nextInt(true);
+		break;
+	case kCCBIFieldByte:
+		value.i = nextByte<Checked>();
+		break;
+	case kCCBIFieldBool:
+		value.i = 0 != nextByte<Checked>() ? 1 : 0;
+		break;
+	case kCCBIFieldString:
+		value.i = nextStringIndex();
+		break;
+	default:
+		value.i = nextInt(false);
+		break;
 	}
 
-	writeXMLDictEndTag();
+	this->mTree.values.push_back(value);
 }
 
-void CCBIReader::readKeyframe(int type, const char *animatedpropname)
+/*decode the first Count of the fields, unrolled at compile time*/
+template <bool Checked, int Count, char... Fields>
+struct CCBIReadFields
 {
-	float timeKeyframe = readFloat();
+	static void read(CCBIReader &)
+	{
+	}
+};
 
-	int easingType = readInt(false);
+template <bool Checked, int Count, char Field, char... Rest>
+struct CCBIReadFields<Checked, Count, Field, Rest...>
+{
+	static void read(CCBIReader &reader)
+	{
+		if (Count > 0)
+		{
+			reader.readValue<Checked, Field>();
+			CCBIReadFields<Checked, Count - 1, Rest...>::read(reader);
+		}
+	}
+};
 
-	/*convert to the value used for CCB xml file*/
-	int convertType = CCBIMainPropTypeName::getAnimatedPropTypeValue(type);
+typedef void (*CCBIReadValues)(CCBIReader &reader);
 
-	float easingOpt = 0;
+/*one kernel per property type, for its properties and for its keyframes*/
+#define CCBI_READ_PROPERTY(name, keyframeFields, ...) &CCBIReadFields<Checked, kCCBIMaxValueFields, __VA_ARGS__>::read,
+#define CCBI_READ_KEYFRAME(name, keyframeFields, ...) &CCBIReadFields<Checked, keyframeFields, __VA_ARGS__>::read,
 
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "easing") << endl;
-	
-	writeXMLDictStartTag();
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_TYPE) << endl;
-	outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << easingType << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-	if (easingType == kCCBIKeyframeEasingCubicIn
+/*the kernels reading a whole record unchecked, and the ones checking every field*/
+template <bool Checked>
+struct CCBIReadKernels
+{
+	static const CCBIReadValues properties[kCCBIPropTypeMAX];
+	static const CCBIReadValues keyframes[kCCBIPropTypeMAX];
+};
+
+template <bool Checked>
+const CCBIReadValues CCBIReadKernels<Checked>::properties[kCCBIPropTypeMAX] =
+{
+	CCBI_PROPERTY_CODECS(CCBI_READ_PROPERTY)
+};
+
+template <bool Checked>
+const CCBIReadValues CCBIReadKernels<Checked>::keyframes[kCCBIPropTypeMAX] =
+{
+	CCBI_PROPERTY_CODECS(CCBI_READ_KEYFRAME)
+};
+
+bool CCBIReader::hasEasingOpt(int easingType)
+{
+	return easingType == kCCBIKeyframeEasingCubicIn
 		|| easingType == kCCBIKeyframeEasingCubicOut
 		|| easingType == kCCBIKeyframeEasingCubicInOut
-		|| easingType == kCCBIKeyframeEasingElasticIn   
+		|| easingType == kCCBIKeyframeEasingElasticIn
 		|| easingType == kCCBIKeyframeEasingElasticOut
-		|| easingType == kCCBIKeyframeEasingElasticInOut)
-	{
-		easingOpt = readFloat();
-		outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "Opt") << endl;
-		outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << easingOpt << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-	}
-	writeXMLDictEndTag();
-
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_NAME) << endl;
-	outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << animatedpropname << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
+		|| easingType == kCCBIKeyframeEasingElasticInOut;
+}
 
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_TIME) << endl;
-	outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << timeKeyframe << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
+template <bool Checked>
+void CCBIReader::readKeyframeFields(int type, CCBIKeyframe &keyframe)
+{
+	keyframe.time = nextFloat<Checked>();
 
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_TYPE) << endl;
-	outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << convertType << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
+	keyframe.easingType = nextInt(false);
 
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_VALUE) << endl;
-	if (type == kCCBIPropTypeCheck)
+	keyframe.easingOpt = 0;
+	if (hasEasingOpt(keyframe.easingType))
 	{
-		bool b = readBool();
-		if (true == b)
-		{
-			outccb << CCBI_XML_TAG_TRUE << endl;
-		}
-		else
-		{
-			outccb << CCBI_XML_TAG_FALSE << endl;
-		}
+		keyframe.easingOpt = nextFloat<Checked>();
 	}
-	else if (type == kCCBIPropTypeByte)
+
+	keyframe.firstValue = this->mTree.values.size();
+	/*a type that is never animated has no value*/
+	if (type >= 0 && type < kCCBIPropTypeMAX)
 	{
-		int i = readByte();
-		outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << i << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
+		CCBIReadKernels<Checked>::keyframes[type](*this);
 	}
-	else if (type == kCCBIPropTypeColor3)
-	{
-		int r = readByte();
-		int g = readByte();
-		int b = readByte();
+	keyframe.numValues = this->mTree.values.size() - keyframe.firstValue;
+}
 
-		writeXMLArrayStartTag();
-		outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << r << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-		outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << g << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-		outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << b << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-		writeXMLArrayEndTag();
-	}
-	else if (type == kCCBIPropTypeDegrees)
+void CCBIReader::readKeyframe(int type, CCBIKeyframe &keyframe)
+{
+	if (this->need(kMaxKeyframeBytes))
 	{
-		float f = readFloat();
-		outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << f << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
+		readKeyframeFields<false>(type, keyframe);
 	}
-	else if (type == kCCBIPropTypeScaleLock || type == kCCBIPropTypePosition
-		|| type == kCCBIPropTypeFloatXY)
-	{
-		float a = readFloat();
-		float b = readFloat();
-		writeXMLArrayStartTag();
-		outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << a << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-		outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << b << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-		writeXMLArrayEndTag();
-	}
-	else if (type == kCCBIPropTypeSpriteFrame)
+	else
 	{
-		std::string spriteSheet = readCachedString();
-		std::string spriteFile = readCachedString();
-		writeXMLArrayStartTag();
-		outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << spriteFile << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-		outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << spriteSheet << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-		writeXMLArrayEndTag();
+		readKeyframeFields<true>(type, keyframe);
 	}
 }
 
+template <bool Checked>
+void CCBIReader::readCallbackKeyframe(CCBICallbackKeyframe &keyframe) {
+	keyframe.time = nextFloat<Checked>();
+	keyframe.nameIndex = nextStringIndex();
+	keyframe.callbackType = nextInt(false);
+}
 
-bool CCBIReader::readCallbackKeyframes() {
-	int numKeyframes = readInt(false);
-
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_CALLBACKCHANNEL_KEY_NAME) << endl;
-	writeXMLDictStartTag();
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_KEY_KEY_FRAMES) << endl;
+template <bool Checked>
+void CCBIReader::readSoundKeyframe(CCBISoundKeyframe &keyframe) {
+	keyframe.time = nextFloat<Checked>();
+	keyframe.fileIndex = nextStringIndex();
+	keyframe.pitch = nextFloat<Checked>();
+	keyframe.pan = nextFloat<Checked>();
+	keyframe.gain = nextFloat<Checked>();
+}
 
-	if (0 == numKeyframes)
-	{
-		outccb << XML_NULL_TAG(CCBI_XML_TAG_ARRAY) << endl;
-	}
-	else
-	{
-		writeXMLArrayStartTag();
-		for (int i = 0; i < numKeyframes; ++i) {
+bool CCBIReader::readCallbackKeyframes(CCBISequence &sequence) {
+	int numKeyframes = readInt(false);
 
-			float time = readFloat();
-			std::string callbackName = readCachedString();
+	sequence.firstCallbackKeyframe = this->mTree.callbackKeyframes.size();
+	sequence.numCallbackKeyframes = numKeyframes;
 
-			int callbackType = readInt(false);
+	for (int i = 0; i < numKeyframes && !mFailed; ++i) {
+		CCBICallbackKeyframe keyframe;
+		if (this->need(kMaxCallbackKeyframeBytes)) {
+			readCallbackKeyframe<false>(keyframe);
+		}
+		else {
+			readCallbackKeyframe<true>(keyframe);
 		}
-		writeXMLArrayEndTag();
-	}
-
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_CALLBACKCHANNEL_KEY_TYPE) << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "10") << endl;
 
-	writeXMLDictEndTag();
+		this->mTree.callbackKeyframes.push_back(keyframe);
+	}
 
-	return true;
+	return !mFailed;
 }
 
-bool CCBIReader::readSoundKeyframes() {
+bool CCBIReader::readSoundKeyframes(CCBISequence &sequence) {
 	int numKeyframes = readInt(false);
 
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_SOUNDCHANNEL_KEY_NAME) << endl;
-	writeXMLDictStartTag();
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_KEY_KEY_FRAMES) << endl;
+	sequence.firstSoundKeyframe = this->mTree.soundKeyframes.size();
+	sequence.numSoundKeyframes = numKeyframes;
 
-	if (0 == numKeyframes)
-	{
-		outccb << XML_NULL_TAG(CCBI_XML_TAG_ARRAY) << endl;
-	}
-	else
-	{
-		writeXMLArrayStartTag();
-		for (int i = 0; i < numKeyframes; ++i) {
-
-			float time = readFloat();
-			std::string soundFile = readCachedString();
-			float pitch = readFloat();
-			float pan = readFloat();
-			float gain = readFloat();
+	for (int i = 0; i < numKeyframes && !mFailed; ++i) {
+		CCBISoundKeyframe keyframe;
+		if (this->need(kMaxSoundKeyframeBytes)) {
+			readSoundKeyframe<false>(keyframe);
+		}
+		else {
+			readSoundKeyframe<true>(keyframe);
 		}
-		writeXMLArrayEndTag();
-	}
 
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_CALLBACKCHANNEL_KEY_TYPE) << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "9") << endl;
+		this->mTree.soundKeyframes.push_back(keyframe);
+	}
 
-	writeXMLDictEndTag();
+	return !mFailed;
+}
 
-	return true;
+template <bool Checked>
+void CCBIReader::readSequence(CCBISequence &sequence)
+{
+	sequence.duration = nextFloat<Checked>();
+	sequence.nameIndex = nextStringIndex();
+	sequence.sequenceId = nextInt(false);
+	sequence.chainedSequenceId = nextInt(true);
 }
 
 bool CCBIReader::readSequences()
 {
-	/*write sequence header*/
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_KEY_MAIN) << endl;
-	writeXMLArrayStartTag();
-
+	mpSection = "the sequences";
 	int numSeqs = readInt(false);
 
-	for (int i = 0; i < numSeqs; i++)
+	/*a count is only trusted as far as the bytes go, and not at all on a stream*/
+	if (NULL == mStream && numSeqs > 0 && (size_t)numSeqs <= (size_t)(mEnd - mCursor))
+	{
+		this->mTree.sequences.reserve(numSeqs);
+	}
+	for (int i = 0; i < numSeqs && !mFailed; i++)
 	{
-		writeXMLDictStartTag();
-		outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "autoPlay") << endl;
-		outccb << CCBI_XML_TAG_TRUE << endl;
-
-		float duration = readFloat();
-		outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_KEY_DURATION_LEN) << endl;
-		outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << duration << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-		outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "position") << endl;
-		outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << duration << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-
-		outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_KEY_MAIN_NAME) << endl;
-		outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << readCachedString().c_str() << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-
-		
-		
-		outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_KEY_SEQUENCE_ID) << endl;
-		outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << readInt(false) << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-
-		int chainsequenceid = readInt(true);
-		if (-1 != chainsequenceid)
+		CCBISequence sequence;
+		if (this->need(kMaxSequenceBytes))
 		{
-			outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_KEY_CHAINEDSEQ_ID) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << chainsequenceid << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
+			readSequence<false>(sequence);
+		}
+		else
+		{
+			readSequence<true>(sequence);
 		}
 
-		/*other default value setting*/
-		writeXMLSequenceDefault();
-
-		readCallbackKeyframes();
-		readSoundKeyframes();
+		readCallbackKeyframes(sequence);
+		readSoundKeyframes(sequence);
 
-		writeXMLDictEndTag();
+		this->mTree.sequences.push_back(sequence);
 	}
 
-	readInt(true);
+	this->mTree.autoPlaySequenceId = readInt(true);
 
-	writeXMLArrayEndTag();
-	return true;
+	return !mFailed;
 }
 
 std::string CCBIReader::lastPathComponent(const char* pPath) {
@@ -601,527 +1165,52 @@ bool CCBIReader::isJSControlled() {
 	return jsControlled;
 }
 
-void CCBIReader::parseProperties()
-{
-	int numRegularProps = readInt(false);
-	int numExturaProps = readInt(false);
-	int propertyCount = numRegularProps + numExturaProps;
-
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_PROPERTIES) << endl;
-	writeXMLArrayStartTag();
-
-	for (int i = 0; i < propertyCount; i++) {
-		bool isExtraProp = (i >= numRegularProps);
-		int type = readInt(false);
-		std::string propertyName = readCachedString();
-		const char *propertycharsName = propertyName.c_str();
-		const char *propertycharsType = CCBIMainPropTypeName::getPropTypeName(type);
-
-		// Check if the property can be set for this platform
-		bool setProp = false;
-
-		int platform = readByte();
-
-		writeXMLDictStartTag();
-
-		outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_NAME) << endl;
-		outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << propertycharsName << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-
-		outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_TYPE) << endl;
-		outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << propertycharsType << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-
-		outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE) << endl;
-		switch (type)
-		{
-		case kCCBIPropTypePosition:
-		{
-			float x = readFloat();
-			float y = readFloat();
-			int type = readInt(false);
-
-			writeXMLArrayStartTag();
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << x << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << y << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << type << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-			writeXMLArrayEndTag();
-
-			break;
-		}
-		case kCCBIPropTypePoint:
-		{
-			float x = readFloat();
-			float y = readFloat();
-
-			writeXMLArrayStartTag();
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << x << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << y << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			writeXMLArrayEndTag();
-
-			break;
-		}
-		case kCCBIPropTypePointLock:
-		{
-			float x = readFloat();
-			float y = readFloat();
-
-			writeXMLArrayStartTag();
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << x << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << y << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			writeXMLArrayEndTag();
-
-			break;
-		}
-		case kCCBIPropTypeSize: 
-		{
-			float width = readFloat();
-			float height = readFloat();
-			int type = readInt(false);
-
-			writeXMLArrayStartTag();
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << width << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << height << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << type << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-			writeXMLArrayEndTag();
-
-			break;
-		}
-		case kCCBIPropTypeScaleLock:
-		{
-			float x = readFloat();
-			float y = readFloat();
-			int type = readInt(false);
-
-			writeXMLArrayStartTag();
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << x << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << y << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << CCBI_XML_TAG_FALSE << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << type << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-			writeXMLArrayEndTag();
-
-			break;
-		}
-		case kCCBIPropTypeFloat:
-		{
-			float f = readFloat();
-
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << f << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
 
-			break;
-		}
-		case kCCBIPropTypeFloatXY:
-		{
-			float x = readFloat();
-			float y = readFloat();
-
-			writeXMLArrayStartTag();
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << x << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << y << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			writeXMLArrayEndTag();
-
-			break;
-		}
-
-		case kCCBIPropTypeDegrees:
-		{
-			float ret = readFloat();
-
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << ret << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-
-			break;
-		}
-		case kCCBIPropTypeFloatScale:
-		{
-			float f = readFloat();
-			int type = readInt(false);
-
-			writeXMLArrayStartTag();
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << f << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << type << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-			writeXMLArrayEndTag();
-
-			break;
-		}
-		case kCCBIPropTypeInteger:
-		{
-			int i = readInt(true);
-
-			outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << i << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-
-			break;
-		}
-		case kCCBIPropTypeIntegerLabeled:
-		{
-			int i = readInt(true);
-
-			outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << i << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-
-			break;
-		}
-		case kCCBIPropTypeFloatVar:
-		{
-			float f = readFloat();
-			float fVar = readFloat();
-
-			writeXMLArrayStartTag();
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << f << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << fVar << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			writeXMLArrayEndTag();
-
-			break;
-		}
-		case kCCBIPropTypeCheck:
-		{
-			bool ret = readBool();
-
-			if (true == ret)
-			{
-				outccb << CCBI_XML_TAG_TRUE << endl;
-			}
-			else
-			{
-				outccb << CCBI_XML_TAG_FALSE << endl;
-			}
-
-			break;
-		}
-		case kCCBIPropTypeSpriteFrame: 
-		{
-			std::string spritesheet = readCachedString();
-			std::string spritefile = readCachedString();
-
-			writeXMLArrayStartTag();
-			outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << spritesheet << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << spritefile << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-			writeXMLArrayEndTag();
-
-			break;
-		}
-		case kCCBIPropTypeAnimation:
-		{
-			std::string animationfile = readCachedString();
-			std::string animation = readCachedString();
-
-			writeXMLArrayStartTag();
-			outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << animationfile << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << animation << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-			writeXMLArrayEndTag();
-
-			break;
-		}
-		case kCCBIPropTypeTexture:
-		{
-			std::string spritefile = readCachedString();
-
-			outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << spritefile << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-
-			break;
-		}
-		case kCCBIPropTypeByte:
-		{
-			unsigned char ret = readByte();
-
-			if (0xff == ret)
-			{
-				ret = 0;
-			}
-
-			outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << (int)ret << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-
-			break;
-		}
-		case kCCBIPropTypeColor3:
-		{
-			unsigned char red = readByte();
-			unsigned char green = readByte();
-			unsigned char blue = readByte();
-
-			writeXMLArrayStartTag();
-			outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << (int)red << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << (int)green << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << (int)blue << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-			writeXMLArrayEndTag();
-
-			break;
-		}
-		case kCCBIPropTypeColor4FVar:
-		{
-			float red = readFloat();
-			float green = readFloat();
-			float blue = readFloat();
-			float alpha = readFloat();
-			float redVar = readFloat();
-			float greenVar = readFloat();
-			float blueVar = readFloat();
-			float alphaVar = readFloat();
-
-			writeXMLArrayStartTag();
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << red << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << green << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << blue << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << alpha << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << redVar << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << greenVar << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << blueVar << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_REAL) << alphaVar << XML_END_TAG(CCBI_XML_TAG_REAL) << endl;
-			writeXMLArrayEndTag();
-
-			break;
-		}
-		case kCCBIPropTypeFlip: 
-		{
-			bool flipX = readBool();
-			bool flipY = readBool();
-
-			writeXMLArrayStartTag();
-			if (true == flipX)
-			{
-				outccb << CCBI_XML_TAG_TRUE << endl;
-			}
-			else
-			{
-				outccb << CCBI_XML_TAG_FALSE << endl;
-			}
-
-			if (true == flipY)
-			{
-				outccb << CCBI_XML_TAG_TRUE << endl;
-			}
-			else
-			{
-				outccb << CCBI_XML_TAG_FALSE << endl;
-			}
-			writeXMLArrayEndTag();
-
-			break;
-		}
-		case kCCBIPropTypeBlendmode:
-		{
-			int source = readInt(false);
-			int destination = readInt(false);
-
-			writeXMLArrayStartTag();
-			outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << source << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << destination << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-			writeXMLArrayEndTag();
-
-			break;
-		}
-		case kCCBIPropTypeFntFile:
-		{
-			std::string fntfile = readCachedString();
-
-			outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << fntfile << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-
-			break;
-		}
-		case kCCBIPropTypeFontTTF: 
-		{
-			std::string fontTTF = readCachedString();
-
-			outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << fontTTF << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-
-			break;
-		}
-		case kCCBIPropTypeString: 
-		{
-			std::string string = readCachedString();
-
-			outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << string << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-
-			break;
-		}
-		case kCCBIPropTypeText: 
-		{
-			std::string text = readCachedString();
-
-			outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << text << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-
-			break;
-		}
-		case kCCBIPropTypeBlock: 
-		{
-			std::string selectorName = readCachedString();
-			int selectorTarget = readInt(false);
-
-			writeXMLArrayStartTag();
-			outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << selectorName << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << selectorTarget << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-			writeXMLArrayEndTag();
-
-			break;
-		}
-		case kCCBIPropTypeBlockCCControl: 
-		{
-			std::string selectorName = readCachedString();
-			int selectorTarget = readInt(false);
-			int controlEvents = readInt(false);
-
-			writeXMLArrayStartTag();
-			outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << selectorName << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << selectorTarget << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-			outccb << XML_START_TAG(CCBI_XML_TAG_INTEGER) << controlEvents << XML_END_TAG(CCBI_XML_TAG_INTEGER) << endl;
-			writeXMLArrayEndTag();
-
-			break;
-		}
-		case kCCBIPropTypeCCBIFile: 
-		{
-			std::string ccbFileName = readCachedString();
-
-			outccb << XML_START_TAG(CCBI_XML_TAG_STRING) << ccbFileName << XML_END_TAG(CCBI_XML_TAG_STRING) << endl;
-
-			break;
-		}
-		default:
-			ASSERT_FAIL_UNEXPECTED_PROPERTYTYPE(type);
-			break;
-		}
-
-		writeXMLDictEndTag();
-	}
-
-
-
-	writeXMLArrayEndTag();
-}
-
-void CCBIReader::writeXMLDeclaration()
+template <bool Checked>
+bool CCBIReader::readProperty(CCBIProperty &property)
 {
-	outccb << CCBI_XML_DECLARATION << endl;
-}
-
-void CCBIReader::writeXMLRootStartPart()
-{
-	outccb << CCBI_XML_ROOT_START_PART << endl;
-}
-
-void CCBIReader::writeXMLRootEndPart()
-{
-	outccb << CCBI_XML_ROOT_END_PART << endl;
-}
-
-void CCBIReader::writeXMLSequenceHead()
-{
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_KEY_MAIN) << endl;
-}
-
-void CCBIReader::writeXMLArrayStartTag()
-{
-	outccb << XML_START_TAG(CCBI_XML_TAG_ARRAY) << endl;
-}
-
-void CCBIReader::writeXMLArrayEndTag()
-{
-	outccb << XML_END_TAG(CCBI_XML_TAG_ARRAY) << endl;
-}
-
-void CCBIReader::writeXMLDictStartTag()
-{
-	outccb << XML_START_TAG(CCBI_XML_TAG_DICT) << endl;
-}
-
-void CCBIReader::writeXMLDictEndTag()
-{
-	outccb << XML_END_TAG(CCBI_XML_TAG_DICT) << endl;
-}
-
-void CCBIReader::writeXMLNotes()
-{
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "notes") << endl;
-	outccb << XML_NULL_TAG(CCBI_XML_TAG_ARRAY) << endl;
-}
-
-void CCBIReader::writeXMLResolutions()
-{
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "resolutions") << endl;
-	writeXMLArrayStartTag();
-	writeXMLDictStartTag();
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "centeredOrigin") << endl;
-	outccb << CCBI_XML_TAG_FALSE << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "ext") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "iphone") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "height") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_INTEGER, "640") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "name") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "iPhone Landscape") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "scale") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_REAL, "1") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "width") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_INTEGER, "400") << endl;
-	writeXMLDictEndTag();
-	writeXMLArrayEndTag();
-}
-
-void CCBIReader::writeXMLNodegraphHead()
-{
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_KEY_NODEGRAPH_MAIN) << endl;
-}
-
-void CCBIReader::writeXMLHeadDefault()
-{
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "centeredOrigin") << endl;
-	outccb << CCBI_XML_TAG_FALSE << endl;
-
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "currentResolution") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_INTEGER, "0") << endl;
-
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "currentSequenceId") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_INTEGER, "0") << endl;
-
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "fileType") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "CocosBuilder") << endl;
-
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "fileVersion") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_INTEGER, "4") << endl;
+	unsigned long long offset = getOffset(this->mCursor);
+	property.type = nextInt(false);
+	property.nameIndex = nextStringIndex();
+	property.platform = nextByte<Checked>();
+	property.firstValue = this->mTree.values.size();
+	mPropertyNameIndex = property.nameIndex;
+
+	if (property.type < 0 || property.type >= kCCBIPropTypeMAX) {
+		/*the value size is unknown, nothing after it can be read*/
+		char message[64];
+		sprintf(message, "unknown property type %d", property.type);
+		return fail(offset, message);
+	}
+	CCBIReadKernels<Checked>::properties[property.type](*this);
 
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "guides") << endl;
-	outccb << XML_NULL_TAG(CCBI_XML_TAG_ARRAY) << endl;
+	property.numValues = this->mTree.values.size() - property.firstValue;
+	return !mFailed;
 }
 
-void CCBIReader::writeXMLSequenceDefault()
+bool CCBIReader::parseProperties(CCBINode &node)
 {
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "offset") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_REAL, "0.0") << endl;
-
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "resolution") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_REAL, "30") << endl;
+	this->need(2 * kCCBIMaxIntBytes);
+	int numRegularProps = nextInt(false);
+	int numExturaProps = nextInt(false);
+	int propertyCount = numRegularProps + numExturaProps;
 
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "scale") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_REAL, "512") << endl;
-}
+	node.firstProperty = this->mTree.properties.size();
+	node.numProperties = propertyCount;
+	node.numExtraProperties = numExturaProps;
 
-void CCBIReader::writeXMLNodegraphDefault()
-{
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "customClass") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "") << endl;
+	for (int i = 0; i < propertyCount && !mFailed; i++) {
+		CCBIProperty property;
+		bool ok = this->need(kMaxPropertyBytes) ? readProperty<false>(property) : readProperty<true>(property);
+		if (!ok) {
+			break;
+		}
 
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "displayName") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "ccbi2ccbdefault") << endl;
-}
+		this->mTree.properties.push_back(property);
+	}
+	mPropertyNameIndex = -1;
 
-void CCBIReader::writeXMLNodegraphPropDefault()
-{
-	writeXMLDictStartTag();
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_NAME) << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "touchEnabled") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "platform") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "iOS") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_TYPE) << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "Check") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE) << endl;
-	outccb << CCBI_XML_TAG_TRUE << endl;
-	writeXMLDictEndTag();
-
-	writeXMLDictStartTag();
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_NAME) << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "mouseEnabled") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "platform") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "Mac") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_TYPE) << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "Check") << endl;
-	outccb << XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE) << endl;
-	outccb << CCBI_XML_TAG_TRUE << endl;
-	writeXMLDictEndTag();
+	return !mFailed;
 }
 
 const char *CCBIMainPropTypeName::typeName[kCCBIPropTypeMAX + 1] =
@@ -1197,11 +1286,31 @@ CCBIMainPropTypeName::CCBIMainPropTypeName()
 
 const char* CCBIMainPropTypeName::getPropTypeName(int typevalue)
 {
+	if (typevalue < 0 || typevalue >= kCCBIPropTypeMAX)
+	{
+		return typeName[kCCBIPropTypeMAX];
+	}
 	return typeName[typevalue];
 }
 
+int CCBIMainPropTypeName::getPropType(const char *pTypeName)
+{
+	for (int i = 0; i < kCCBIPropTypeMAX; i++)
+	{
+		if (0 == strcmp(typeName[i], pTypeName))
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
 const int CCBIMainPropTypeName::getAnimatedPropTypeValue(int typevalue)
 {
+	if (typevalue < 0 || typevalue >= kCCBIPropTypeMAX)
+	{
+		return -1;
+	}
 	return animatedproptypevalue[typevalue];
 }
 
@@ -6,8 +6,16 @@
 #include <set>
 #include <fstream>
 
+#include <stdio.h>
+
+#include "CBIMappedFile.h"
+#include "CBITree.h"
+
 #define kCCBIVersion 5
 
+/*levels of node graph a reader accepts unless told otherwise*/
+#define kCCBIDefaultMaxDepth 1000000
+
 enum {
 	kCCBIPropTypePosition = 0,
 	kCCBIPropTypeSize,
@@ -55,6 +63,14 @@ enum {
 	kCCBIPlatformMac
 };
 
+/*events of CCBIReader::readNodeEvent*/
+enum {
+	kCCBINodeStart,
+	kCCBINodeEnd,
+	kCCBINodeGraphEnd,
+	kCCBINodeGraphError
+};
+
 enum {
 	kCCBITargetTypeNone = 0,
 	kCCBITargetTypeDocumentRoot = 1,
@@ -110,42 +126,118 @@ enum
 	kCCBIScaleTypeMultiplyResolution
 };
 
-/**
-* @brief  CCBI structure after parsing
-*/
-class CCBITree
-{
-private:
-	/*hearder*/
-
-
-	/*sequence*/
-	/*nodegraph*/
-};
+template <bool Checked, int Count, char... Fields>
+struct CCBIReadFields;
 
 /**
 * @brief Parse CCBII file which is generated by CocosBuilder
+*
+* The read methods decode the file into a CCBITree, see CCBIXMLEmitter for
+* turning it into a ccb.
+*
+* The node graph is walked with an explicit stack of node frames, reused
+* from file to file, so the depth of a graph costs heap instead of call
+* stack; graphs deeper than getMaxDepth() are refused.
+*
+* A reader made on a stream (stdin, a pipe) decodes through a window that
+* is refilled as it is consumed, and readNodeEvent() walks the node graph
+* one node at a time: the tree then only holds the string cache, the
+* sequences and the nodes on the path to the current one, so memory stays
+* flat whatever the size of the input.
+*
+* Any input is safe to decode. Bounds are checked once per record: when
+* the longest encoding of a property, keyframe or sequence is left before
+* the end, it is decoded without further checks, only the last records
+* of the input are read field by field. The first problem stops decoding,
+* see describeError().
 */
 class CCBIReader
 {
 private:
-	unsigned char *mBytes;
-	int mCurrentByte;
+	/*the input, or the window over a stream; the cursor is between them*/
+	const unsigned char *mBytes;
+	const unsigned char *mCursor;
+	const unsigned char *mEnd;
 	int mCurrentBit;
 
-	std::vector<std::string> mStringCache;
-
-	std::ofstream outccb;
+	/*owner of mBytes: either the mapped file or a heap copy of it*/
+	CCBIMappedFile mMappedFile;
+	unsigned char *mOwnedBytes;
+
+	/*stream input: mBytes is a window of mWindowCapacity bytes over it*/
+	FILE *mStream;
+	size_t mWindowCapacity;
+	unsigned long long mStreamOffset;
+	bool mTruncated;
+	/*the string cache, copied out of the window*/
+	std::vector<char> mStringBytes;
+	/*a node on the path to the one being read*/
+	struct NodeFrame
+	{
+		int index;
+		/*children left to read*/
+		int pendingChildren;
+	};
+	std::vector<NodeFrame> mFrames;
+	bool mNodeGraphStarted;
+	int mMaxDepth;
+	bool mTooDeep;
+
+	/*where decoding is, to place an error*/
+	const char *mpSection;
+	const CCBINode *mpNode;
+	int mPropertyNameIndex;
+
+	/*the first problem of the input*/
+	bool mFailed;
+	std::string mError;
+	unsigned long long mErrorOffset;
+	std::string mErrorNodePath;
+	std::string mErrorProperty;
+
+	/*prefix of the sub ccbi files referenced by kCCBIPropTypeCCBIFile*/
+	std::string mCCBIRootPath;
+
+	CCBITree mTree;
 
 public:
 
 	bool jsControlled;
-	CCBIReader(const char *pCCBIFile, const char *pOutCCBFile);
+	/**
+	* @param useMappedInput decode straight from a read-only mapping of the
+	*        file instead of reading it into a heap buffer first
+	*/
+	CCBIReader(const char *pCCBIFile, bool useMappedInput = true);
+	/**
+	* @brief Decode from a stream, which is read forward only and not closed
+	*/
+	explicit CCBIReader(FILE *pStream);
+	/**
+	* @brief Decode bytes already in memory, which must outlive the reader
+	*/
+	CCBIReader(const unsigned char *pBytes, size_t length);
 	virtual ~CCBIReader();
 
+	/**
+	* @brief Levels of node graph to accept, the root being level 1
+	*
+	* A deeper graph stops the walk and isTooDeep() becomes true.
+	*/
+	void setMaxDepth(int maxDepth);
+	int getMaxDepth() const;
+
 	void setCCBIRootPath(const char* pCCBIRootPath);
 	const std::string& getCCBIRootPath() const;
 
+	/**
+	* @brief The ccbi files the decoded node graph includes, once each
+	*
+	* A kCCBIPropTypeCCBIFile value names a ccb relative to the root path;
+	* like the cocos2d-x loader, the root path is prepended and the
+	* extension replaced by .ccbi.
+	*/
+	void getCCBIFileReferences(std::vector<std::string> &files) const;
+
 	// Used in CCNodeLoader::parseProperties()
 	std::set<std::string>* getAnimatedProperties();
 	std::set<std::string>& getLoadedSpriteSheet();
@@ -156,58 +248,150 @@ public:
 	static std::string toLowerCase(const char* pCCString);
 	static bool endsWith(const char* pString, const char* pEnding);
 
+	/* Input access. */
+	const unsigned char* getBytes() const;
+	size_t getLength() const;
+	/*bytes consumed so far, the ones of a stream already refilled over included*/
+	unsigned long long getPosition() const;
+
+	/* Decoded data. */
+	const CCBITree& getTree() const;
+
 	/* Parse methods. */
 	int readInt(bool pSigned);
 	unsigned char readByte();
 	bool readBool();
 	std::string readUTF8();
+	CCBIStringView readUTF8View();
 	float readFloat();
-	std::string readCachedString();
+	/*a view into the input, valid as long as the reader*/
+	CCBIStringView readCachedString();
+	int readCachedStringIndex();
 	bool isJSControlled();
 
 
-	bool readCallbackKeyframes();
-	bool readSoundKeyframes();
+	bool readCallbackKeyframes(CCBISequence &sequence);
+	bool readSoundKeyframes(CCBISequence &sequence);
 
 	bool readSequences();
 
 	bool readHeader();
 	bool readStringCache();
 	//void readStringCacheEntry();
-	void readNodeGraph();
+	bool readNodeGraph();
+
+	/**
+	* @brief Decode the node graph one node at a time, instead of readNodeGraph()
+	*
+	* kCCBINodeStart: node index is in getTree().nodes with its animated
+	* properties and properties, which are dropped at the next call.
+	* kCCBINodeEnd: the subtree of node index is complete.
+	* In this mode index is the depth of the node, and subtreeEnd is not set.
+	* @return one of kCCBINodeStart, kCCBINodeEnd, kCCBINodeGraphEnd, kCCBINodeGraphError
+	*/
+	int readNodeEvent(int &index);
+
+	/**
+	* @brief After the kCCBINodeStart of a node, decode its descendants
+	* without handing them out: the next readNodeEvent() is its kCCBINodeEnd
+	* @return false on an error of the input
+	*/
+	bool skipNodeSubtree();
+
+	/**
+	* @brief Walk the subtree of the node at offset instead of the whole graph
+	*
+	* offset is a getPosition() taken before the kCCBINodeStart of that node,
+	* on the same input; readNodeEvent() then reads the node as the root of
+	* the walk and ends after its subtree. Call it after readSequences().
+	* @return false for a stream, which can not go back, or an offset out of the input
+	*/
+	bool seekNode(unsigned long long offset);
+
+	/*true if the input ended before the file did*/
+	bool isTruncated() const;
+	/*true if the node graph is deeper than getMaxDepth()*/
+	bool isTooDeep() const;
+
+	/* Errors, all set by the first problem of the input. */
+	bool hasFailed() const;
+	const std::string& getError() const;
+	/*offset of the record or field the error is about*/
+	unsigned long long getErrorOffset() const;
+	/*class names from the root down, each child with its index: CCLayer/CCSprite[2]*/
+	const std::string& getErrorNodePath() const;
+	/*the property being read, empty outside of one*/
+	const std::string& getErrorProperty() const;
+	/**
+	* @brief The error with its place, like
+	* "offset 1234, node CCLayer/CCSprite[2], property 'position': the input ends inside the node graph"
+	*/
+	std::string describeError() const;
 
 	bool getBit();
 	void alignBits();
 	
-	void readKeyframe(int type, const char *animatedpropname);
-
-	void parseProperties();
+	void readKeyframe(int type, CCBIKeyframe &keyframe);
+	static bool hasEasingOpt(int easingType);
 
-	/*ccb xml generate function list*/
-	void writeXMLDeclaration();
-	void writeXMLRootStartPart();
-	void writeXMLRootEndPart();
-
-	void writeXMLSequenceHead();
-
-	void writeXMLArrayStartTag();
-	void writeXMLArrayEndTag();
-
-	void writeXMLDictStartTag();
-	void writeXMLDictEndTag();
-
-	void writeXMLNotes();
-	void writeXMLResolutions();
-
-	/*nodegraph*/
-	void writeXMLNodegraphHead();
+	/*false on an unknown property type*/
+	bool parseProperties(CCBINode &node);
 
 private:
-	void writeXMLHeadDefault();
-	void writeXMLSequenceDefault();
-	void writeXMLNodegraphDefault();
-	void writeXMLNodegraphPropDefault();
-
+	bool loadBuffered(const char *pCCBIFile);
+
+	/**
+	* @brief Make count bytes readable at the cursor, refilling a stream window
+	* @return false if the input ends before them; a stream window then
+	*         holds everything left of the stream
+	*/
+	bool need(size_t count)
+	{
+		return (size_t)(mEnd - mCursor) >= count || (NULL != mStream && refill(count));
+	}
+	bool refill(size_t count);
+
+	unsigned long long getOffset(const unsigned char *pAt) const;
+
+	/*record the first error, always false*/
+	bool fail(unsigned long long offset, const char *pMessage);
+	bool failTruncated();
+	std::string getNodePath() const;
+	std::string getNodeName(const CCBINode &node) const;
+
+	/*
+	* The decoding primitives. An int is bounded by the end of the input
+	* by its decoder; bytes and floats only check it when Checked, the
+	* unchecked ones rely on a need() for their whole record.
+	*/
+	int nextInt(bool pSigned);
+	int nextStringIndex();
+	template <bool Checked>
+	unsigned char nextByte();
+	template <bool Checked>
+	float nextFloat();
+
+	template <bool Checked>
+	void readSequence(CCBISequence &sequence);
+	template <bool Checked>
+	void readCallbackKeyframe(CCBICallbackKeyframe &keyframe);
+	template <bool Checked>
+	void readSoundKeyframe(CCBISoundKeyframe &keyframe);
+	template <bool Checked>
+	void readKeyframeFields(int type, CCBIKeyframe &keyframe);
+	template <bool Checked>
+	bool readProperty(CCBIProperty &property);
+
+	/*everything of a node but its children*/
+	bool readNodeFields(CCBINode &node);
+
+	/*decode one kCCBIField* field and append it to the tree's value array*/
+	template <bool Checked, char Field>
+	void readValue();
+
+	/*the decode kernels of CBIPropertyCodec.h, one per property type*/
+	template <bool Checked, int Count, char... Fields>
+	friend struct CCBIReadFields;
 };
 
 
@@ -218,7 +402,11 @@ private:
 	static const int  animatedproptypevalue[kCCBIPropTypeMAX + 1];
 	CCBIMainPropTypeName();
 public:
+	/*"null" for a type out of range*/
 	static const char* getPropTypeName(int typevalue);
+	/*kCCBIPropType* of a type name, -1 if unknown*/
+	static int getPropType(const char *pTypeName);
+	/*-1 for a type which can not be animated or is out of range*/
 	static const int getAnimatedPropTypeValue(int typevalue);
 };
 
@@ -0,0 +1,223 @@
+#include "CBIRealFormat.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*the shortest digits come from std::to_chars where the library has it*/
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+/*exact powers of ten as doubles*/
+static const double kPowersOf10[] =
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+	1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+};
+static const int kMaxFractionDigits = sizeof(kPowersOf10) / sizeof(kPowersOf10[0]) - 1;
+
+/*scaled values must stay below 2^53 so they are exact integers*/
+static const double kMaxScaled = 9007199254740992.0;
+
+/*magnitudes written without an exponent, like %g does for 6 digits*/
+static const double kMinFixed = 1e-4;
+static const double kMaxFixed = 1e9;
+
+/*************************************************************************
+Implementation of CCBIRealFormat
+*************************************************************************/
+int CCBIRealFormat::format(float value, char *pText)
+{
+	/*the values readFloat has a type of their own for*/
+	if (0.0f == value)
+	{
+		/*keep the sign of a full float -0*/
+		unsigned int bits;
+		memcpy(&bits, &value, sizeof(bits));
+		if (0 != (bits >> 31))
+		{
+			memcpy(pText, "-0", 2);
+			return 2;
+		}
+		pText[0] = '0';
+		return 1;
+	}
+	if (1.0f == value)
+	{
+		pText[0] = '1';
+		return 1;
+	}
+	if (-1.0f == value)
+	{
+		memcpy(pText, "-1", 2);
+		return 2;
+	}
+	if (0.5f == value)
+	{
+		memcpy(pText, "0.5", 3);
+		return 3;
+	}
+
+	if (value != value)
+	{
+		memcpy(pText, "nan", 3);
+		return 3;
+	}
+	if (value > FLT_MAX || value < -FLT_MAX)
+	{
+		/*the spelling CFPropertyList reads back*/
+		if (value > 0)
+		{
+			memcpy(pText, "+infinity", 9);
+			return 9;
+		}
+		memcpy(pText, "-infinity", 9);
+		return 9;
+	}
+
+	double magnitude = fabs((double)value);
+	if (magnitude < kMinFixed || magnitude >= kMaxFixed)
+	{
+		return formatScientific(value, pText);
+	}
+
+	/*kCCBIFloatInteger values and other whole numbers*/
+	if ((double)(long long)magnitude == magnitude)
+	{
+		return formatInteger(value < 0 ? -(long long)magnitude : (long long)magnitude, pText);
+	}
+
+	return formatFixed(magnitude, value < 0, pText);
+}
+
+int CCBIRealFormat::formatInteger(long long value, char *pText)
+{
+	char digits[24];
+	int count = 0;
+
+	unsigned long long magnitude = value < 0 ? 0ull - (unsigned long long)value : (unsigned long long)value;
+	do
+	{
+		digits[count++] = (char)('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (0 != magnitude);
+
+	int length = 0;
+	if (value < 0)
+	{
+		pText[length++] = '-';
+	}
+	while (count > 0)
+	{
+		pText[length++] = digits[--count];
+	}
+
+	return length;
+}
+
+int CCBIRealFormat::formatFixed(double magnitude, bool negative, char *pText)
+{
+	float target = (float)magnitude;
+
+	/*
+	* Try 1, 2, 3... fraction digits. For each count the nearest decimal is
+	* scaled / 10^digits; both are exact doubles, so the division is the
+	* correctly rounded double of that decimal, which is what a loader's
+	* strtod gives. The first count that narrows back to the float wins.
+	*/
+	for (int digits = 1; digits <= kMaxFractionDigits; digits++)
+	{
+		double scaled = floor(magnitude * kPowersOf10[digits] + 0.5);
+		if (scaled >= kMaxScaled)
+		{
+			break;
+		}
+		if ((float)(scaled / kPowersOf10[digits]) != target)
+		{
+			continue;
+		}
+
+		unsigned long long number = (unsigned long long)scaled;
+
+		/*the nearest decimal may still end in zeros at a rounding tie*/
+		while (digits > 1 && 0 == number % 10)
+		{
+			number /= 10;
+			digits--;
+		}
+
+		char text[24];
+		int count = 0;
+		for (int i = 0; i < digits; i++)
+		{
+			text[count++] = (char)('0' + number % 10);
+			number /= 10;
+		}
+		text[count++] = '.';
+		do
+		{
+			text[count++] = (char)('0' + number % 10);
+			number /= 10;
+		} while (0 != number);
+
+		int length = 0;
+		if (negative)
+		{
+			pText[length++] = '-';
+		}
+		while (count > 0)
+		{
+			pText[length++] = text[--count];
+		}
+		return length;
+	}
+
+	return formatScientific(negative ? -target : target, pText);
+}
+
+int CCBIRealFormat::formatScientific(float value, char *pText)
+{
+#ifdef __cpp_lib_to_chars
+	/*the same "1.5e-41" spelling as %g, and it never uses the locale*/
+	std::to_chars_result result = std::to_chars(pText, pText + kMaxLength, value, std::chars_format::scientific);
+
+	/*plist loaders read a double and narrow it, check that gives the float too*/
+	double readBack = 0;
+	if (std::errc() == result.ec
+		&& std::errc() == std::from_chars(pText, result.ptr, readBack).ec
+		&& (float)readBack == value)
+	{
+		return (int)(result.ptr - pText);
+	}
+#endif
+
+	/*otherwise the fewest of up to 9 significant digits, which always round-trip a float*/
+	char text[kMaxLength];
+	int length = 0;
+	for (int precision = 1; precision <= 9; precision++)
+	{
+		length = sprintf(text, "%.*g", precision, (double)value);
+		if ((float)strtod(text, NULL) == value)
+		{
+			break;
+		}
+	}
+
+	/*strtod above ran in the same locale, only the output needs a '.'*/
+	for (int i = 0; i < length; i++)
+	{
+		char c = text[i];
+		if ((c < '0' || c > '9') && '-' != c && '+' != c && 'e' != c)
+		{
+			c = '.';
+		}
+		pText[i] = c;
+	}
+
+	return length;
+}
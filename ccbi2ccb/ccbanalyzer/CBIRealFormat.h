@@ -0,0 +1,33 @@
+#ifndef _CCBII_CCBIRealFormat_H_
+#define _CCBII_CCBIRealFormat_H_
+
+/**
+* @brief Shortest round-trip text of a float for <real> elements
+*
+* The text has the fewest significant digits that still read back as the
+* same float, and always uses '.' whatever the C locale is. Reading it back
+* as a double and narrowing to float, as the plist loaders do, gives the
+* original value.
+*/
+class CCBIRealFormat
+{
+private:
+	CCBIRealFormat();
+
+public:
+	/*enough for "-1.17549435e-38" and the like*/
+	static const int kMaxLength = 32;
+
+	/**
+	* @brief Write value into pText (at least kMaxLength chars)
+	* @return the length of the text, which is not null terminated
+	*/
+	static int format(float value, char *pText);
+
+private:
+	static int formatInteger(long long value, char *pText);
+	static int formatFixed(double magnitude, bool negative, char *pText);
+	static int formatScientific(float value, char *pText);
+};
+
+#endif
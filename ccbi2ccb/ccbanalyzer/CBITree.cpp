@@ -0,0 +1,40 @@
+#include "CBITree.h"
+
+/*************************************************************************
+Implementation of CCBITree
+*************************************************************************/
+CCBITree::CCBITree()
+{
+	clear();
+}
+
+CCBITree::~CCBITree()
+{
+	mArena.release();
+}
+
+void CCBITree::clear()
+{
+	mArena.release();
+
+	header.version = 0;
+	header.jsControlled = false;
+	stringBase = NULL;
+	autoPlaySequenceId = -1;
+
+	strings.init(&mArena);
+	sequences.init(&mArena);
+	callbackKeyframes.init(&mArena);
+	soundKeyframes.init(&mArena);
+	nodes.init(&mArena);
+	animatedProperties.init(&mArena);
+	emptySequenceIds.init(&mArena);
+	keyframes.init(&mArena);
+	properties.init(&mArena);
+	values.init(&mArena);
+}
+
+CCBIArena& CCBITree::getArena()
+{
+	return mArena;
+}
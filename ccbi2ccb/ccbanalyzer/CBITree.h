@@ -0,0 +1,184 @@
+#ifndef _CCBII_CCBITree_H_
+#define _CCBII_CCBITree_H_
+
+#include "CBIArena.h"
+
+/**
+* @brief Entry of the string cache: a byte range of the input, relative to
+* CCBITree::stringBase
+*/
+struct CCBIString
+{
+	unsigned int offset;
+	unsigned int length;
+};
+
+/**
+* @brief Non-owning view of a cached string, not null terminated
+*/
+struct CCBIStringView
+{
+	const char *pChars;
+	size_t length;
+};
+
+struct CCBIHeader
+{
+	int version;
+	bool jsControlled;
+};
+
+struct CCBICallbackKeyframe
+{
+	float time;
+	int nameIndex;
+	int callbackType;
+};
+
+struct CCBISoundKeyframe
+{
+	float time;
+	int fileIndex;
+	float pitch;
+	float pan;
+	float gain;
+};
+
+struct CCBISequence
+{
+	float duration;
+	int nameIndex;
+	int sequenceId;
+	int chainedSequenceId;
+
+	int firstCallbackKeyframe;
+	int numCallbackKeyframes;
+	int firstSoundKeyframe;
+	int numSoundKeyframes;
+};
+
+/**
+* @brief One decoded field of a property or keyframe value
+*
+* Which member is set depends on the property type: floats in f, ints,
+* bools, bytes and string cache indices in i.
+*/
+union CCBIValue
+{
+	float f;
+	int i;
+};
+
+struct CCBIProperty
+{
+	int type;
+	int nameIndex;
+	int platform;
+	int firstValue;
+	int numValues;
+};
+
+struct CCBIKeyframe
+{
+	float time;
+	int easingType;
+	float easingOpt;
+	int firstValue;
+	int numValues;
+};
+
+struct CCBIAnimatedProperty
+{
+	int sequenceId;
+	int nameIndex;
+	int type;
+	int firstKeyframe;
+	int numKeyframes;
+};
+
+/**
+* @brief Node of the graph, stored in pre-order
+*
+* The subtree of node n is the index range [n, subtreeEnd), so its first
+* child is n + 1 and the next sibling of a child c is c's subtreeEnd.
+*/
+struct CCBINode
+{
+	int parent;
+	int subtreeEnd;
+	int numChildren;
+
+	int classNameIndex;
+	/*-1 if the file is not js controlled*/
+	int jsControlledNameIndex;
+	int memberVarAssignmentType;
+	/*-1 if memberVarAssignmentType is kCCBITargetTypeNone*/
+	int memberVarAssignmentNameIndex;
+
+	/*every sequence of the node, those without animated properties too*/
+	int numAnimatedSequences;
+	int firstAnimatedProperty;
+	int numAnimatedProperties;
+	/*the ids of the sequences without animated properties, in emptySequenceIds*/
+	int firstEmptySequence;
+	int numEmptySequences;
+
+	int firstProperty;
+	int numProperties;
+	int numExtraProperties;
+};
+
+/**
+* @brief CCBI structure after parsing
+*
+* Everything lives in flat arrays linked by index, allocated from one arena
+* which is released in one shot by clear() or the destructor.
+*/
+class CCBITree
+{
+private:
+	CCBIArena mArena;
+
+public:
+	/*hearder*/
+	CCBIHeader header;
+	/*the strings are views into the input, which must outlive the tree*/
+	const char *stringBase;
+	CCBIArenaArray<CCBIString> strings;
+
+	/*sequence*/
+	CCBIArenaArray<CCBISequence> sequences;
+	CCBIArenaArray<CCBICallbackKeyframe> callbackKeyframes;
+	CCBIArenaArray<CCBISoundKeyframe> soundKeyframes;
+	int autoPlaySequenceId;
+
+	/*nodegraph*/
+	CCBIArenaArray<CCBINode> nodes;
+	CCBIArenaArray<CCBIAnimatedProperty> animatedProperties;
+	CCBIArenaArray<int> emptySequenceIds;
+	CCBIArenaArray<CCBIKeyframe> keyframes;
+	CCBIArenaArray<CCBIProperty> properties;
+	CCBIArenaArray<CCBIValue> values;
+
+	CCBITree();
+	~CCBITree();
+
+	void clear();
+
+	CCBIArena& getArena();
+
+	CCBIStringView getString(int index) const
+	{
+		const CCBIString &string = strings[index];
+		CCBIStringView view;
+		view.pChars = stringBase + string.offset;
+		view.length = string.length;
+		return view;
+	}
+
+private:
+	CCBITree(const CCBITree&);
+	CCBITree& operator=(const CCBITree&);
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef _CCBII_CCBIUTF8_H_
+#define _CCBII_CCBIUTF8_H_
+
+#include <stddef.h>
+
+/*what a broken UTF-8 sequence decodes to*/
+#define kCCBIReplacementChar 0xfffd
+
+/**
+* @brief UTF-8 decoder shared by the writers which have to validate strings
+*/
+class CCBIUTF8
+{
+private:
+	CCBIUTF8();
+
+public:
+	/**
+	* @brief Decode the UTF-8 code point at pos and move pos past it
+	* @return the code point, U+FFFD for a broken, overlong or surrogate sequence
+	*/
+	static unsigned int decode(const unsigned char *pBytes, size_t length, size_t &pos)
+	{
+		unsigned int c = pBytes[pos++];
+		if (c < 0x80)
+		{
+			return c;
+		}
+
+		int extra;
+		unsigned int minimum;
+		if (0xc0 == (c & 0xe0))
+		{
+			extra = 1;
+			minimum = 0x80;
+			c &= 0x1f;
+		}
+		else if (0xe0 == (c & 0xf0))
+		{
+			extra = 2;
+			minimum = 0x800;
+			c &= 0x0f;
+		}
+		else if (0xf0 == (c & 0xf8))
+		{
+			extra = 3;
+			minimum = 0x10000;
+			c &= 0x07;
+		}
+		else
+		{
+			return kCCBIReplacementChar;
+		}
+
+		for (int i = 0; i < extra; i++)
+		{
+			if (pos >= length || 0x80 != (pBytes[pos] & 0xc0))
+			{
+				return kCCBIReplacementChar;
+			}
+			c = (c << 6) | (pBytes[pos++] & 0x3f);
+		}
+
+		if (c < minimum || c > 0x10ffff || (c >= 0xd800 && c <= 0xdfff))
+		{
+			return kCCBIReplacementChar;
+		}
+		return c;
+	}
+};
+
+#endif
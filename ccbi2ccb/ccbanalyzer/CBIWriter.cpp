@@ -0,0 +1,397 @@
+#include "CBIWriter.h"
+#include "CBIReader.h"
+#include "CBIPropertyCodec.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <fstream>
+
+using namespace std;
+
+/*************************************************************************
+Implementation of CCBIWriter
+*************************************************************************/
+CCBIWriter::CCBIWriter()
+{
+}
+
+void CCBIWriter::clear()
+{
+	mBytes.clear();
+	mError.clear();
+}
+
+const unsigned char* CCBIWriter::getBytes() const
+{
+	return mBytes.empty() ? NULL : &mBytes[0];
+}
+
+size_t CCBIWriter::getLength() const
+{
+	return mBytes.size();
+}
+
+const std::string& CCBIWriter::getError() const
+{
+	return mError;
+}
+
+bool CCBIWriter::flushTo(const char *pOutFile) const
+{
+	ofstream out(pOutFile, ios::out | ios::binary);
+	if (!out.is_open())
+	{
+		return false;
+	}
+
+	if (!mBytes.empty())
+	{
+		out.write((const char*)&mBytes[0], mBytes.size());
+	}
+	out.close();
+
+	return !out.fail();
+}
+
+bool CCBIWriter::writeTree(const CCBITree &tree)
+{
+	clear();
+
+	/*a ccbi is usually a few kilobytes per node*/
+	mBytes.reserve(64 + tree.nodes.size() * 256);
+
+	if (!writeHeader(tree) || !writeStringCache(tree))
+	{
+		return false;
+	}
+	writeSequences(tree);
+
+	return writeNodeGraph(tree);
+}
+
+void CCBIWriter::writeGamma(unsigned long long current)
+{
+	/*N zero bits, a one bit, then the N bits below the top one, msb first*/
+	int numBits = 0;
+	while ((current >> (numBits + 1)) != 0)
+	{
+		numBits++;
+	}
+
+	int totalBits = 2 * numBits + 1;
+	size_t start = mBytes.size();
+	mBytes.resize(start + (totalBits + 7) / 8, 0);
+	unsigned char *pCode = &mBytes[start];
+
+	pCode[numBits >> 3] |= (unsigned char)(1 << (numBits & 7));
+	for (int a = numBits - 1, bit = numBits + 1; a >= 0; a--, bit++)
+	{
+		if ((current >> a) & 1)
+		{
+			pCode[bit >> 3] |= (unsigned char)(1 << (bit & 7));
+		}
+	}
+}
+
+void CCBIWriter::writeInt(int value, bool pSigned)
+{
+	unsigned long long current;
+	if (pSigned)
+	{
+		/*positive values odd, the others even, as readInt(true) expects*/
+		long long wide = value;
+		current = wide > 0 ? (unsigned long long)(wide * 2 + 1) : (unsigned long long)(-wide * 2);
+		if (0 == value)
+		{
+			current = 1;
+		}
+	}
+	else
+	{
+		current = (unsigned long long)(unsigned int)value + 1;
+	}
+
+	writeGamma(current);
+}
+
+void CCBIWriter::writeByte(unsigned char byte)
+{
+	mBytes.push_back(byte);
+}
+
+void CCBIWriter::writeBool(bool value)
+{
+	writeByte(value ? 1 : 0);
+}
+
+bool CCBIWriter::writeUTF8(const char *pString, size_t length)
+{
+	if (length > 0xffff)
+	{
+		return false;
+	}
+
+	writeByte((unsigned char)(length >> 8));
+	writeByte((unsigned char)(length & 0xff));
+	mBytes.insert(mBytes.end(), (const unsigned char*)pString, (const unsigned char*)pString + length);
+
+	return true;
+}
+
+void CCBIWriter::writeFloat(float value)
+{
+	/*the same choice as the CocosBuilder publisher*/
+	if (0.0f == value)
+	{
+		writeByte(kCCBIFloat0);
+	}
+	else if (1.0f == value)
+	{
+		writeByte(kCCBIFloat1);
+	}
+	else if (-1.0f == value)
+	{
+		writeByte(kCCBIFloatMinus1);
+	}
+	else if (0.5f == value)
+	{
+		writeByte(kCCBIFloat05);
+	}
+	else if (value > -2147483648.0f && value < 2147483648.0f && (float)(int)value == value)
+	{
+		writeByte(kCCBIFloatInteger);
+		writeInt((int)value, true);
+	}
+	else
+	{
+		/*little endian, whatever the host is*/
+		unsigned int bits;
+		memcpy(&bits, &value, sizeof(bits));
+
+		writeByte(kCCBIFloatFull);
+		writeByte((unsigned char)(bits & 0xff));
+		writeByte((unsigned char)((bits >> 8) & 0xff));
+		writeByte((unsigned char)((bits >> 16) & 0xff));
+		writeByte((unsigned char)(bits >> 24));
+	}
+}
+
+bool CCBIWriter::writeHeader(const CCBITree &tree)
+{
+	/*read back as the little endian int 'ccbi'*/
+	writeByte('i');
+	writeByte('b');
+	writeByte('c');
+	writeByte('c');
+
+	writeInt(kCCBIVersion, false);
+	writeBool(tree.header.jsControlled);
+
+	return true;
+}
+
+bool CCBIWriter::writeStringCache(const CCBITree &tree)
+{
+	writeInt(tree.strings.size(), false);
+
+	for (int i = 0; i < tree.strings.size(); i++)
+	{
+		CCBIStringView string = tree.getString(i);
+		if (!writeUTF8(string.pChars, string.length))
+		{
+			char message[64];
+			sprintf(message, "string %d is longer than 65535 bytes", i);
+			mError = message;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void CCBIWriter::writeSequences(const CCBITree &tree)
+{
+	writeInt(tree.sequences.size(), false);
+
+	for (int i = 0; i < tree.sequences.size(); i++)
+	{
+		const CCBISequence &sequence = tree.sequences[i];
+
+		writeFloat(sequence.duration);
+		writeInt(sequence.nameIndex, false);
+		writeInt(sequence.sequenceId, false);
+		writeInt(sequence.chainedSequenceId, true);
+
+		writeInt(sequence.numCallbackKeyframes, false);
+		for (int k = 0; k < sequence.numCallbackKeyframes; k++)
+		{
+			const CCBICallbackKeyframe &keyframe = tree.callbackKeyframes[sequence.firstCallbackKeyframe + k];
+			writeFloat(keyframe.time);
+			writeInt(keyframe.nameIndex, false);
+			writeInt(keyframe.callbackType, false);
+		}
+
+		writeInt(sequence.numSoundKeyframes, false);
+		for (int k = 0; k < sequence.numSoundKeyframes; k++)
+		{
+			const CCBISoundKeyframe &keyframe = tree.soundKeyframes[sequence.firstSoundKeyframe + k];
+			writeFloat(keyframe.time);
+			writeInt(keyframe.fileIndex, false);
+			writeFloat(keyframe.pitch);
+			writeFloat(keyframe.pan);
+			writeFloat(keyframe.gain);
+		}
+	}
+
+	writeInt(tree.autoPlaySequenceId, true);
+}
+
+bool CCBIWriter::writeNodeGraph(const CCBITree &tree)
+{
+	/*the nodes are in pre-order, which is the order of the file*/
+	for (int i = 0; i < tree.nodes.size(); i++)
+	{
+		const CCBINode &node = tree.nodes[i];
+
+		writeNode(tree, node);
+
+		for (int p = 0; p < node.numProperties; p++)
+		{
+			if (!writeProperty(tree, tree.properties[node.firstProperty + p]))
+			{
+				return false;
+			}
+		}
+
+		writeInt(node.numChildren, false);
+	}
+
+	return true;
+}
+
+void CCBIWriter::writeNode(const CCBITree &tree, const CCBINode &node)
+{
+	writeInt(node.classNameIndex, false);
+	if (tree.header.jsControlled)
+	{
+		writeInt(node.jsControlledNameIndex, false);
+	}
+
+	writeInt(node.memberVarAssignmentType, false);
+	if (node.memberVarAssignmentType != kCCBITargetTypeNone)
+	{
+		writeInt(node.memberVarAssignmentNameIndex, false);
+	}
+
+	/*the animated properties are stored grouped by sequence*/
+	int numSequences = 0;
+	for (int i = 0; i < node.numAnimatedProperties; i++)
+	{
+		const CCBIAnimatedProperty *animatedProps = tree.animatedProperties.data() + node.firstAnimatedProperty;
+		if (0 == i || animatedProps[i].sequenceId != animatedProps[i - 1].sequenceId)
+		{
+			numSequences++;
+		}
+	}
+
+	writeInt(numSequences + node.numEmptySequences, false);
+	for (int i = 0; i < node.numAnimatedProperties;)
+	{
+		const CCBIAnimatedProperty *animatedProps = tree.animatedProperties.data() + node.firstAnimatedProperty;
+
+		int end = i + 1;
+		while (end < node.numAnimatedProperties && animatedProps[end].sequenceId == animatedProps[i].sequenceId)
+		{
+			end++;
+		}
+
+		writeInt(animatedProps[i].sequenceId, false);
+		writeInt(end - i, false);
+		for (; i < end; i++)
+		{
+			const CCBIAnimatedProperty &animatedProp = animatedProps[i];
+			writeInt(animatedProp.nameIndex, false);
+			writeInt(animatedProp.type, false);
+			writeInt(animatedProp.numKeyframes, false);
+			for (int k = 0; k < animatedProp.numKeyframes; k++)
+			{
+				writeKeyframe(tree, animatedProp.type, tree.keyframes[animatedProp.firstKeyframe + k]);
+			}
+		}
+	}
+	for (int i = 0; i < node.numEmptySequences; i++)
+	{
+		writeInt(tree.emptySequenceIds[node.firstEmptySequence + i], false);
+		writeInt(0, false);
+	}
+
+	writeInt(node.numProperties - node.numExtraProperties, false);
+	writeInt(node.numExtraProperties, false);
+}
+
+void CCBIWriter::writeKeyframe(const CCBITree &tree, int type, const CCBIKeyframe &keyframe)
+{
+	const CCBIValue *values = tree.values.data() + keyframe.firstValue;
+
+	writeFloat(keyframe.time);
+	writeInt(keyframe.easingType, false);
+	if (CCBIReader::hasEasingOpt(keyframe.easingType))
+	{
+		writeFloat(keyframe.easingOpt);
+	}
+
+	/*a type that is never animated has no value*/
+	const CCBIPropertyCodec *pCodec = getCCBIPropertyCodec(type);
+	if (NULL != pCodec)
+	{
+		writeValues(pCodec->fields, pCodec->numKeyframeFields, values);
+	}
+}
+
+void CCBIWriter::writeValues(const char *pFields, int numFields, const CCBIValue *values)
+{
+	for (int i = 0; i < numFields; i++)
+	{
+		switch (pFields[i])
+		{
+		case kCCBIFieldFloat:
+			writeFloat(values[i].f);
+			break;
+		case kCCBIFieldSigned:
+			writeInt(values[i].i, true);
+			break;
+		case kCCBIFieldByte:
+			writeByte((unsigned char)values[i].i);
+			break;
+		case kCCBIFieldBool:
+			writeBool(0 != values[i].i);
+			break;
+		default:
+			/*unsigned ints and string cache indices*/
+			writeInt(values[i].i, false);
+			break;
+		}
+	}
+}
+
+bool CCBIWriter::writeProperty(const CCBITree &tree, const CCBIProperty &property)
+{
+	const CCBIValue *values = tree.values.data() + property.firstValue;
+
+	writeInt(property.type, false);
+	writeInt(property.nameIndex, false);
+	writeByte((unsigned char)property.platform);
+
+	const CCBIPropertyCodec *pCodec = getCCBIPropertyCodec(property.type);
+	if (NULL == pCodec)
+	{
+		char message[64];
+		sprintf(message, "unknown property type %d", property.type);
+		mError = message;
+		return false;
+	}
+	writeValues(pCodec->fields, pCodec->numFields, values);
+
+	return true;
+}
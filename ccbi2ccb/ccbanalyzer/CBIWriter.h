@@ -0,0 +1,69 @@
+#ifndef _CCBII_CCBIWriter_H_
+#define _CCBII_CCBIWriter_H_
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "CBITree.h"
+
+/**
+* @brief Encode a CCBITree as a version 5 ccbi file
+*
+* The write methods are the exact inverse of the CCBIReader read methods:
+* Elias-gamma ints, the compact kCCBIFloat* encodings and big endian
+* length prefixed UTF-8, laid out in the order CocosBuilder publishes.
+*/
+class CCBIWriter
+{
+private:
+	std::vector<unsigned char> mBytes;
+	std::string mError;
+
+public:
+	CCBIWriter();
+
+	void clear();
+
+	const unsigned char* getBytes() const;
+	size_t getLength() const;
+
+	/**
+	* @brief Why the last writeTree() failed
+	*/
+	const std::string& getError() const;
+
+	/**
+	* @brief Write the bytes to pOutFile in one go
+	*/
+	bool flushTo(const char *pOutFile) const;
+
+	/**
+	* @brief Encode the whole tree
+	* @return false if the tree can not be stored in a ccbi, see getError()
+	*/
+	bool writeTree(const CCBITree &tree);
+
+	/* Encode methods. */
+	void writeInt(int value, bool pSigned);
+	void writeByte(unsigned char byte);
+	void writeBool(bool value);
+	bool writeUTF8(const char *pString, size_t length);
+	void writeFloat(float value);
+
+	bool writeHeader(const CCBITree &tree);
+	bool writeStringCache(const CCBITree &tree);
+	void writeSequences(const CCBITree &tree);
+	bool writeNodeGraph(const CCBITree &tree);
+
+private:
+	void writeGamma(unsigned long long current);
+
+	void writeNode(const CCBITree &tree, const CCBINode &node);
+	void writeKeyframe(const CCBITree &tree, int type, const CCBIKeyframe &keyframe);
+	bool writeProperty(const CCBITree &tree, const CCBIProperty &property);
+	/*the first numFields of a value, one kCCBIField* letter each*/
+	void writeValues(const char *pFields, int numFields, const CCBIValue *values);
+};
+
+#endif
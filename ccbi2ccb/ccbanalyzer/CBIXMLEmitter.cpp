@@ -0,0 +1,848 @@
+#include "CBIXMLEmitter.h"
+#include "CBIReader.h"
+#include "ccbimapping.h"
+#include "../util/thread/ssWorkerPool.h"
+
+#include <algorithm>
+#include <functional>
+#include <new>
+#include <vector>
+
+using namespace std;
+
+enum
+{
+	kChunkNodes,
+	kChunkNodeStart,
+	kChunkNodeEnd
+};
+
+/*smallest run of nodes handed to a worker*/
+static const int kMinChunkNodes = 64;
+
+/*************************************************************************
+Implementation of CCBIXMLEmitter
+*************************************************************************/
+CCBIXMLEmitter::CCBIXMLEmitter(const CCBITree &tree, CCBIPlistWriter &writer)
+: mTree(tree)
+, mWriter(writer)
+, mStrings(mOwnStrings)
+, mNumThreads(1)
+{
+	mOwnStrings.build(mTree);
+}
+
+CCBIXMLEmitter::CCBIXMLEmitter(const CCBIXMLEmitter &parent, CCBIPlistWriter &writer)
+: mTree(parent.mTree)
+, mWriter(writer)
+, mStrings(parent.mStrings)
+, mNumThreads(1)
+{
+}
+
+void CCBIXMLEmitter::setNumThreads(int numThreads)
+{
+	mNumThreads = numThreads;
+}
+
+void CCBIXMLEmitter::emit()
+{
+	emitStart();
+	writeNodeGraph();
+	emitEnd();
+}
+
+void CCBIXMLEmitter::emitStart()
+{
+	/*xml head*/
+	writeXMLDeclaration();
+	writeXMLRootStartPart();
+	writeXMLDictStartTag();
+
+	writeHeader();
+
+	/*write the default values*/
+	writeXMLNotes();
+	writeXMLResolutions();
+
+	writeSequences();
+
+	writeXMLNodegraphHead();
+}
+
+void CCBIXMLEmitter::emitEnd()
+{
+	/*write the xml tail*/
+	writeXMLDictEndTag();
+	writeXMLRootEndPart();
+}
+
+void CCBIXMLEmitter::emitSelectionStart()
+{
+	writeXMLDeclaration();
+	writeXMLRootStartPart();
+	writeXMLDictStartTag();
+}
+
+void CCBIXMLEmitter::writeSelectedNodesStart()
+{
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "nodes"));
+	writeXMLArrayStartTag();
+}
+
+void CCBIXMLEmitter::writeSelectedNodesEnd()
+{
+	writeXMLArrayEndTag();
+}
+
+void CCBIXMLEmitter::writeHeader()
+{
+	writeXMLHeadDefault();
+
+	mWriter.writeLiteral(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "jsControlled"));
+	mWriter.writeBool(mTree.header.jsControlled);
+}
+
+void CCBIXMLEmitter::writeSequences()
+{
+	/*write sequence header*/
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_KEY_MAIN));
+	writeXMLArrayStartTag();
+
+	for (int i = 0; i < mTree.sequences.size(); i++)
+	{
+		const CCBISequence &sequence = mTree.sequences[i];
+
+		writeXMLDictStartTag();
+		mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "autoPlay"));
+		mWriter.writeLiteralLine(CCBI_XML_TAG_TRUE);
+
+		mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_KEY_DURATION_LEN));
+		mWriter.writeReal(sequence.duration);
+		mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "position"));
+		mWriter.writeReal(sequence.duration);
+
+		mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_KEY_MAIN_NAME));
+		writeCachedString(sequence.nameIndex);
+
+		mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_KEY_SEQUENCE_ID));
+		mWriter.writeInteger(sequence.sequenceId);
+
+		if (-1 != sequence.chainedSequenceId)
+		{
+			mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_KEY_CHAINEDSEQ_ID));
+			mWriter.writeInteger(sequence.chainedSequenceId);
+		}
+
+		/*other default value setting*/
+		writeXMLSequenceDefault();
+
+		writeCallbackKeyframes(sequence);
+		writeSoundKeyframes(sequence);
+
+		writeXMLDictEndTag();
+	}
+
+	writeXMLArrayEndTag();
+}
+
+void CCBIXMLEmitter::writeCallbackKeyframes(const CCBISequence &sequence)
+{
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_CALLBACKCHANNEL_KEY_NAME));
+	writeXMLDictStartTag();
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_KEY_KEY_FRAMES));
+
+	if (0 == sequence.numCallbackKeyframes)
+	{
+		mWriter.writeLiteralLine(XML_NULL_TAG(CCBI_XML_TAG_ARRAY));
+	}
+	else
+	{
+		writeXMLArrayStartTag();
+		writeXMLArrayEndTag();
+	}
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_CALLBACKCHANNEL_KEY_TYPE));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "10"));
+
+	writeXMLDictEndTag();
+}
+
+void CCBIXMLEmitter::writeSoundKeyframes(const CCBISequence &sequence)
+{
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_SOUNDCHANNEL_KEY_NAME));
+	writeXMLDictStartTag();
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_KEY_KEY_FRAMES));
+
+	if (0 == sequence.numSoundKeyframes)
+	{
+		mWriter.writeLiteralLine(XML_NULL_TAG(CCBI_XML_TAG_ARRAY));
+	}
+	else
+	{
+		writeXMLArrayStartTag();
+		writeXMLArrayEndTag();
+	}
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_CALLBACKCHANNEL_KEY_TYPE));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "9"));
+
+	writeXMLDictEndTag();
+}
+
+void CCBIXMLEmitter::writeNodeGraph()
+{
+	if (mTree.nodes.empty())
+	{
+		return;
+	}
+
+	int numThreads = 0 == mNumThreads ? SSWorkerPool::getDefaultThreadCount() : mNumThreads;
+	if (numThreads > 1 && mTree.nodes.size() >= kParallelMinNodes)
+	{
+		writeNodesParallel(numThreads);
+	}
+	else
+	{
+		writeNodes(0, mTree.nodes[0].subtreeEnd);
+	}
+}
+
+void CCBIXMLEmitter::writeNodesParallel(int numThreads)
+{
+	/*a few chunks per thread, so uneven subtrees still spread out*/
+	int chunkNodes = mTree.nodes.size() / (numThreads * 4);
+	if (chunkNodes < kMinChunkNodes)
+	{
+		chunkNodes = kMinChunkNodes;
+	}
+
+	vector<Chunk> chunks;
+	planChunks(0, chunkNodes, chunks);
+
+	vector<CCBIPlistWriter*> writers(chunks.size(), (CCBIPlistWriter*)NULL);
+	/*a worker out of memory only flags its run, the error is raised on this thread*/
+	vector<char> failed(chunks.size(), 0);
+	{
+		SSWorkerPool pool(numThreads);
+		for (size_t i = 0; i < chunks.size(); i++)
+		{
+			if (kChunkNodes == chunks[i].kind)
+			{
+				writers[i] = new CCBIPlistWriter();
+				pool.submit(bind(&CCBIXMLEmitter::writeChunk, this, &chunks[i], writers[i], &failed[i]));
+			}
+		}
+		pool.wait();
+	}
+
+	if (failed.end() != find(failed.begin(), failed.end(), 1))
+	{
+		for (size_t i = 0; i < writers.size(); i++)
+		{
+			delete writers[i];
+		}
+		throw bad_alloc();
+	}
+
+	/*append the runs in order, with the nodes they were cut out of around them*/
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		switch (chunks[i].kind)
+		{
+		case kChunkNodeStart:
+			writeNodeStart(chunks[i].first);
+			break;
+		case kChunkNodeEnd:
+			writeNodeEnd(chunks[i].first);
+			break;
+		default:
+			mWriter.write(writers[i]->getBytes(), writers[i]->getSize());
+			delete writers[i];
+			break;
+		}
+	}
+}
+
+void CCBIXMLEmitter::planChunks(int index, int chunkNodes, vector<Chunk> &chunks) const
+{
+	/*the cut nodes whose subtree is being planned, a deep graph must not recurse*/
+	vector<int> open;
+
+	int end = mTree.nodes[index].subtreeEnd;
+	while (index < end)
+	{
+		while (!open.empty() && index >= mTree.nodes[open.back()].subtreeEnd)
+		{
+			Chunk close = { kChunkNodeEnd, open.back(), open.back() + 1 };
+			chunks.push_back(close);
+			open.pop_back();
+		}
+
+		const CCBINode &node = mTree.nodes[index];
+		if (node.subtreeEnd - index <= chunkNodes)
+		{
+			/*small subtrees join the run of their previous sibling*/
+			if (!chunks.empty() && kChunkNodes == chunks.back().kind && index == chunks.back().end
+				&& node.subtreeEnd - chunks.back().first <= chunkNodes)
+			{
+				chunks.back().end = node.subtreeEnd;
+			}
+			else
+			{
+				Chunk chunk = { kChunkNodes, index, node.subtreeEnd };
+				chunks.push_back(chunk);
+			}
+			index = node.subtreeEnd;
+			continue;
+		}
+
+		/*too large for one run: cut it below the node itself*/
+		Chunk start = { kChunkNodeStart, index, index + 1 };
+		chunks.push_back(start);
+		open.push_back(index);
+		index++;
+	}
+
+	while (!open.empty())
+	{
+		Chunk close = { kChunkNodeEnd, open.back(), open.back() + 1 };
+		chunks.push_back(close);
+		open.pop_back();
+	}
+}
+
+void CCBIXMLEmitter::writeChunk(const Chunk *pChunk, CCBIPlistWriter *pWriter, char *pFailed) const
+{
+	try
+	{
+		CCBIXMLEmitter worker(*this, *pWriter);
+		worker.writeNodes(pChunk->first, pChunk->end);
+	}
+	catch (const bad_alloc&)
+	{
+		*pFailed = 1;
+	}
+}
+
+void CCBIXMLEmitter::writeNodes(int first, int end)
+{
+	/*nodes whose children array is still open*/
+	vector<int> open;
+
+	for (int i = first; i < end; i++)
+	{
+		while (!open.empty() && i >= mTree.nodes[open.back()].subtreeEnd)
+		{
+			writeNodeEnd(open.back());
+			open.pop_back();
+		}
+
+		writeNodeStart(i);
+		if (0 != mTree.nodes[i].numChildren)
+		{
+			open.push_back(i);
+		}
+		else
+		{
+			writeNodeEnd(i);
+		}
+	}
+
+	while (!open.empty())
+	{
+		writeNodeEnd(open.back());
+		open.pop_back();
+	}
+}
+
+void CCBIXMLEmitter::writeNodeStart(int index)
+{
+	const CCBINode &node = mTree.nodes[index];
+
+	writeXMLDictStartTag();
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_KEY_BASE_CLASS));
+	writeCachedString(node.classNameIndex);
+
+	writeXMLNodegraphDefault();
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_KEY_MEMBERVARASSIGNMENTTYPE));
+	mWriter.writeInteger(node.memberVarAssignmentType);
+
+	if (node.memberVarAssignmentType != kCCBITargetTypeNone)
+	{
+		mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_KEY_MEMBERVARASSIGNMENTNAME));
+		writeCachedString(node.memberVarAssignmentNameIndex);
+	}
+
+	writeAnimatedProperties(node);
+
+	writeProperties(node);
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_KEY_CHILDREN));
+	if (0 != node.numChildren)
+	{
+		writeXMLArrayStartTag();
+	}
+	else
+	{
+		mWriter.writeLiteralLine(CCBI_XML_TAG_ARRAT_SIMPLE);
+	}
+}
+
+void CCBIXMLEmitter::writeNodeEnd(int index)
+{
+	if (0 != mTree.nodes[index].numChildren)
+	{
+		writeXMLArrayEndTag();
+	}
+
+	writeXMLDictEndTag();
+}
+
+void CCBIXMLEmitter::writeAnimatedProperties(const CCBINode &node)
+{
+	if (0 == node.numAnimatedSequences)
+	{
+		return;
+	}
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_MAIN));
+	writeXMLDictStartTag();
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "0"));
+	writeXMLDictStartTag();
+
+	for (int i = 0; i < node.numAnimatedProperties; i++)
+	{
+		const CCBIAnimatedProperty &animatedProp = mTree.animatedProperties[node.firstAnimatedProperty + i];
+
+		writeCachedKey(animatedProp.nameIndex);
+
+		writeXMLDictStartTag();
+		mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_KEYFRAMES));
+		writeXMLArrayStartTag();
+		for (int k = 0; k < animatedProp.numKeyframes; ++k)
+		{
+			writeXMLDictStartTag();
+			writeKeyframe(animatedProp, mTree.keyframes[animatedProp.firstKeyframe + k]);
+			writeXMLDictEndTag();
+		}
+		writeXMLArrayEndTag();
+
+		mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_NAME));
+		writeCachedString(animatedProp.nameIndex);
+
+		/*convert to the value used for CCB xml file*/
+		mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_TYPE));
+		mWriter.writeInteger(CCBIMainPropTypeName::getAnimatedPropTypeValue(animatedProp.type));
+
+		writeXMLDictEndTag();
+	}
+
+	writeXMLDictEndTag();
+	writeXMLDictEndTag();
+}
+
+void CCBIXMLEmitter::writeKeyframe(const CCBIAnimatedProperty &animatedProp, const CCBIKeyframe &keyframe)
+{
+	const CCBIValue *values = mTree.values.data() + keyframe.firstValue;
+	int type = animatedProp.type;
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "easing"));
+
+	writeXMLDictStartTag();
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_TYPE));
+	mWriter.writeInteger(keyframe.easingType);
+	if (CCBIReader::hasEasingOpt(keyframe.easingType))
+	{
+		mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "Opt"));
+		mWriter.writeReal(keyframe.easingOpt);
+	}
+	writeXMLDictEndTag();
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_NAME));
+	writeCachedString(animatedProp.nameIndex);
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_TIME));
+	mWriter.writeReal(keyframe.time);
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_TYPE));
+	mWriter.writeInteger(CCBIMainPropTypeName::getAnimatedPropTypeValue(type));
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_ANIMANTED_PROPERTIES_KEY_FRAME_VALUE));
+	if (type == kCCBIPropTypeCheck)
+	{
+		mWriter.writeBool(0 != values[0].i);
+	}
+	else if (type == kCCBIPropTypeByte)
+	{
+		mWriter.writeInteger(values[0].i);
+	}
+	else if (type == kCCBIPropTypeColor3)
+	{
+		writeXMLArrayStartTag();
+		mWriter.writeInteger(values[0].i);
+		mWriter.writeInteger(values[1].i);
+		mWriter.writeInteger(values[2].i);
+		writeXMLArrayEndTag();
+	}
+	else if (type == kCCBIPropTypeDegrees)
+	{
+		mWriter.writeReal(values[0].f);
+	}
+	else if (type == kCCBIPropTypeScaleLock || type == kCCBIPropTypePosition
+		|| type == kCCBIPropTypeFloatXY)
+	{
+		writeXMLArrayStartTag();
+		mWriter.writeReal(values[0].f);
+		mWriter.writeReal(values[1].f);
+		writeXMLArrayEndTag();
+	}
+	else if (type == kCCBIPropTypeSpriteFrame)
+	{
+		/*the ccb lists the sprite file before the sheet*/
+		writeXMLArrayStartTag();
+		writeCachedString(values[1].i);
+		writeCachedString(values[0].i);
+		writeXMLArrayEndTag();
+	}
+}
+
+void CCBIXMLEmitter::writeProperties(const CCBINode &node)
+{
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_PROPERTIES));
+	writeXMLArrayStartTag();
+
+	for (int i = 0; i < node.numProperties; i++)
+	{
+		writeProperty(mTree.properties[node.firstProperty + i]);
+	}
+
+	writeXMLArrayEndTag();
+}
+
+void CCBIXMLEmitter::writeProperty(const CCBIProperty &property)
+{
+	const CCBIValue *values = mTree.values.data() + property.firstValue;
+
+	writeXMLDictStartTag();
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_NAME));
+	writeCachedString(property.nameIndex);
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_TYPE));
+	mWriter.writeString(CCBIMainPropTypeName::getPropTypeName(property.type));
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE));
+	switch (property.type)
+	{
+	case kCCBIPropTypePosition:
+	case kCCBIPropTypeSize:
+	{
+		writeXMLArrayStartTag();
+		mWriter.writeReal(values[0].f);
+		mWriter.writeReal(values[1].f);
+		mWriter.writeInteger(values[2].i);
+		writeXMLArrayEndTag();
+
+		break;
+	}
+	case kCCBIPropTypeScaleLock:
+	{
+		writeXMLArrayStartTag();
+		mWriter.writeReal(values[0].f);
+		mWriter.writeReal(values[1].f);
+		mWriter.writeLiteralLine(CCBI_XML_TAG_FALSE);
+		mWriter.writeInteger(values[2].i);
+		writeXMLArrayEndTag();
+
+		break;
+	}
+	case kCCBIPropTypePoint:
+	case kCCBIPropTypePointLock:
+	case kCCBIPropTypeFloatXY:
+	case kCCBIPropTypeFloatVar:
+	{
+		writeXMLArrayStartTag();
+		mWriter.writeReal(values[0].f);
+		mWriter.writeReal(values[1].f);
+		writeXMLArrayEndTag();
+
+		break;
+	}
+	case kCCBIPropTypeFloat:
+	case kCCBIPropTypeDegrees:
+	{
+		mWriter.writeReal(values[0].f);
+
+		break;
+	}
+	case kCCBIPropTypeFloatScale:
+	{
+		writeXMLArrayStartTag();
+		mWriter.writeReal(values[0].f);
+		mWriter.writeInteger(values[1].i);
+		writeXMLArrayEndTag();
+
+		break;
+	}
+	case kCCBIPropTypeInteger:
+	case kCCBIPropTypeIntegerLabeled:
+	{
+		mWriter.writeInteger(values[0].i);
+
+		break;
+	}
+	case kCCBIPropTypeCheck:
+	{
+		mWriter.writeBool(0 != values[0].i);
+
+		break;
+	}
+	case kCCBIPropTypeSpriteFrame:
+	case kCCBIPropTypeAnimation:
+	{
+		writeXMLArrayStartTag();
+		writeCachedString(values[0].i);
+		writeCachedString(values[1].i);
+		writeXMLArrayEndTag();
+
+		break;
+	}
+	case kCCBIPropTypeTexture:
+	case kCCBIPropTypeFntFile:
+	case kCCBIPropTypeFontTTF:
+	case kCCBIPropTypeString:
+	case kCCBIPropTypeText:
+	case kCCBIPropTypeCCBIFile:
+	{
+		writeCachedString(values[0].i);
+
+		break;
+	}
+	case kCCBIPropTypeByte:
+	{
+		/*0xff is written as 0*/
+		mWriter.writeInteger(0xff == values[0].i ? 0 : values[0].i);
+
+		break;
+	}
+	case kCCBIPropTypeColor3:
+	{
+		writeXMLArrayStartTag();
+		mWriter.writeInteger(values[0].i);
+		mWriter.writeInteger(values[1].i);
+		mWriter.writeInteger(values[2].i);
+		writeXMLArrayEndTag();
+
+		break;
+	}
+	case kCCBIPropTypeColor4FVar:
+	{
+		writeXMLArrayStartTag();
+		for (int c = 0; c < 8; c++)
+		{
+			mWriter.writeReal(values[c].f);
+		}
+		writeXMLArrayEndTag();
+
+		break;
+	}
+	case kCCBIPropTypeFlip:
+	{
+		writeXMLArrayStartTag();
+		mWriter.writeBool(0 != values[0].i);
+		mWriter.writeBool(0 != values[1].i);
+		writeXMLArrayEndTag();
+
+		break;
+	}
+	case kCCBIPropTypeBlendmode:
+	{
+		writeXMLArrayStartTag();
+		mWriter.writeInteger(values[0].i);
+		mWriter.writeInteger(values[1].i);
+		writeXMLArrayEndTag();
+
+		break;
+	}
+	case kCCBIPropTypeBlock:
+	{
+		writeXMLArrayStartTag();
+		writeCachedString(values[0].i);
+		mWriter.writeInteger(values[1].i);
+		writeXMLArrayEndTag();
+
+		break;
+	}
+	case kCCBIPropTypeBlockCCControl:
+	{
+		writeXMLArrayStartTag();
+		writeCachedString(values[0].i);
+		mWriter.writeInteger(values[1].i);
+		mWriter.writeInteger(values[2].i);
+		writeXMLArrayEndTag();
+
+		break;
+	}
+	default:
+		break;
+	}
+
+	writeXMLDictEndTag();
+}
+
+void CCBIXMLEmitter::writeCachedString(int index)
+{
+	size_t length;
+	const char *pFragment = mStrings.getFragment(index, length);
+	mWriter.write(pFragment, length);
+}
+
+void CCBIXMLEmitter::writeCachedKey(int index)
+{
+	size_t length;
+	const char *pEscaped = mStrings.getEscaped(index, length);
+	mWriter.writeKey(pEscaped, length);
+}
+
+void CCBIXMLEmitter::writeXMLDeclaration()
+{
+	mWriter.writeLiteralLine(CCBI_XML_DECLARATION);
+}
+
+void CCBIXMLEmitter::writeXMLRootStartPart()
+{
+	mWriter.writeLiteralLine(CCBI_XML_ROOT_START_PART);
+}
+
+void CCBIXMLEmitter::writeXMLRootEndPart()
+{
+	mWriter.writeLiteralLine(CCBI_XML_ROOT_END_PART);
+}
+
+void CCBIXMLEmitter::writeXMLSequenceHead()
+{
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_SEQUENCE_KEY_MAIN));
+}
+
+void CCBIXMLEmitter::writeXMLArrayStartTag()
+{
+	mWriter.writeArrayStartTag();
+}
+
+void CCBIXMLEmitter::writeXMLArrayEndTag()
+{
+	mWriter.writeArrayEndTag();
+}
+
+void CCBIXMLEmitter::writeXMLDictStartTag()
+{
+	mWriter.writeDictStartTag();
+}
+
+void CCBIXMLEmitter::writeXMLDictEndTag()
+{
+	mWriter.writeDictEndTag();
+}
+
+void CCBIXMLEmitter::writeXMLNotes()
+{
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "notes"));
+	mWriter.writeLiteralLine(XML_NULL_TAG(CCBI_XML_TAG_ARRAY));
+}
+
+void CCBIXMLEmitter::writeXMLResolutions()
+{
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "resolutions"));
+	writeXMLArrayStartTag();
+	writeXMLDictStartTag();
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "centeredOrigin"));
+	mWriter.writeLiteralLine(CCBI_XML_TAG_FALSE);
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "ext"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "iphone"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "height"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_INTEGER, "640"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "name"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "iPhone Landscape"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "scale"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_REAL, "1"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "width"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_INTEGER, "400"));
+	writeXMLDictEndTag();
+	writeXMLArrayEndTag();
+}
+
+void CCBIXMLEmitter::writeXMLNodegraphHead()
+{
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_KEY_NODEGRAPH_MAIN));
+}
+
+void CCBIXMLEmitter::writeXMLHeadDefault()
+{
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "centeredOrigin"));
+	mWriter.writeLiteralLine(CCBI_XML_TAG_FALSE);
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "currentResolution"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_INTEGER, "0"));
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "currentSequenceId"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_INTEGER, "0"));
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "fileType"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "CocosBuilder"));
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "fileVersion"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_INTEGER, "4"));
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "guides"));
+	mWriter.writeLiteralLine(XML_NULL_TAG(CCBI_XML_TAG_ARRAY));
+}
+
+void CCBIXMLEmitter::writeXMLSequenceDefault()
+{
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "offset"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_REAL, "0.0"));
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "resolution"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_REAL, "30"));
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "scale"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_REAL, "512"));
+}
+
+void CCBIXMLEmitter::writeXMLNodegraphDefault()
+{
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "customClass"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, ""));
+
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "displayName"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "ccbi2ccbdefault"));
+}
+
+void CCBIXMLEmitter::writeXMLNodegraphPropDefault()
+{
+	writeXMLDictStartTag();
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_NAME));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "touchEnabled"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "platform"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "iOS"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_TYPE));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "Check"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE));
+	mWriter.writeLiteralLine(CCBI_XML_TAG_TRUE);
+	writeXMLDictEndTag();
+
+	writeXMLDictStartTag();
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_NAME));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "mouseEnabled"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, "platform"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "Mac"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_TYPE));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_STRING, "Check"));
+	mWriter.writeLiteralLine(XML_SIMPLE_ELEMENT(CCBI_XML_TAG_KEY, CCBI_NODEGRAPH_PROPERTIES_KEY_VALUE));
+	mWriter.writeLiteralLine(CCBI_XML_TAG_TRUE);
+	writeXMLDictEndTag();
+}
+
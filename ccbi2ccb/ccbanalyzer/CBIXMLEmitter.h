@@ -0,0 +1,134 @@
+#ifndef _CCBII_CCBIXMLEmitter_H_
+#define _CCBII_CCBIXMLEmitter_H_
+
+#include "CBITree.h"
+#include "CBIPlistWriter.h"
+#include "CBIXMLStringTable.h"
+
+#include <vector>
+
+/**
+* @brief Write a decoded CCBITree as a ccb xml plist
+*/
+class CCBIXMLEmitter
+{
+private:
+	const CCBITree &mTree;
+	CCBIPlistWriter &mWriter;
+	/*the string cache, escaped and rendered once, shared with the workers*/
+	CCBIXMLStringTable mOwnStrings;
+	const CCBIXMLStringTable &mStrings;
+	int mNumThreads;
+
+	/*part of the node graph: a run of sibling subtrees, or the start or end of a node*/
+	struct Chunk
+	{
+		int kind;
+		int first;
+		int end;
+	};
+
+public:
+	/*a ccb is roughly 40 times the size of its ccbi, reserve for that up front*/
+	static const size_t kOutputSizeRatio = 48;
+	/*node graphs smaller than this are written on the calling thread*/
+	static const int kParallelMinNodes = 512;
+
+	CCBIXMLEmitter(const CCBITree &tree, CCBIPlistWriter &writer);
+
+	/**
+	* @brief Threads for writing the node graph, 0 for one per core
+	*
+	* Large node graphs are cut into runs of sibling subtrees which are
+	* written into buffers of their own and appended in order, so the output
+	* is the same whatever the number of threads. The default is 1.
+	*/
+	void setNumThreads(int numThreads);
+
+	/**
+	* @brief Write the whole document
+	*/
+	void emit();
+
+	/**
+	* @brief Write the document around a node graph written by the caller
+	*
+	* emitStart() writes everything up to the node graph, emitEnd() closes
+	* the document; in between the caller writes the nodes with
+	* writeNodeStart() and writeNodeEnd(), e.g. while streaming them in.
+	*/
+	void emitStart();
+	void emitEnd();
+
+	/**
+	* @brief Write a document of selected parts instead of the ccb
+	*
+	* emitSelectionStart() opens a dict which emitEnd() closes; in between
+	* the caller writes the sequences with writeSequences(), or subtrees
+	* into a "nodes" array between writeSelectedNodesStart() and
+	* writeSelectedNodesEnd().
+	*/
+	void emitSelectionStart();
+	void writeSelectedNodesStart();
+	void writeSelectedNodesEnd();
+
+	/*everything of a node up to and including the children array start*/
+	void writeNodeStart(int index);
+	void writeNodeEnd(int index);
+
+	void writeHeader();
+	void writeSequences();
+	void writeNodeGraph();
+
+	/**
+	* @brief Write the nodes of the subtree [first, end) in pre-order
+	*/
+	void writeNodes(int first, int end);
+
+	/*ccb xml generate function list*/
+	void writeXMLDeclaration();
+	void writeXMLRootStartPart();
+	void writeXMLRootEndPart();
+
+	void writeXMLSequenceHead();
+
+	void writeXMLArrayStartTag();
+	void writeXMLArrayEndTag();
+
+	void writeXMLDictStartTag();
+	void writeXMLDictEndTag();
+
+	void writeXMLNotes();
+	void writeXMLResolutions();
+
+	/*nodegraph*/
+	void writeXMLNodegraphHead();
+
+private:
+	/*a worker writing part of the node graph with the strings of parent*/
+	CCBIXMLEmitter(const CCBIXMLEmitter &parent, CCBIPlistWriter &writer);
+
+	void writeNodesParallel(int numThreads);
+	void planChunks(int index, int chunkNodes, std::vector<Chunk> &chunks) const;
+	void writeChunk(const Chunk *pChunk, CCBIPlistWriter *pWriter, char *pFailed) const;
+
+	void writeCallbackKeyframes(const CCBISequence &sequence);
+	void writeSoundKeyframes(const CCBISequence &sequence);
+	void writeAnimatedProperties(const CCBINode &node);
+	void writeKeyframe(const CCBIAnimatedProperty &animatedProp, const CCBIKeyframe &keyframe);
+	void writeProperties(const CCBINode &node);
+	void writeProperty(const CCBIProperty &property);
+
+	void writeCachedString(int index);
+	void writeCachedKey(int index);
+
+	void writeXMLHeadDefault();
+	void writeXMLSequenceDefault();
+	void writeXMLNodegraphDefault();
+	void writeXMLNodegraphPropDefault();
+
+	CCBIXMLEmitter(const CCBIXMLEmitter&);
+	CCBIXMLEmitter& operator=(const CCBIXMLEmitter&);
+};
+
+#endif
@@ -0,0 +1,123 @@
+#include "CBIXMLStringTable.h"
+#include "ccbimapping.h"
+#include "CBIUTF8.h"
+#include "CBIEscapeScanner.h"
+
+#include <string.h>
+
+using namespace std;
+
+static const char kStringStart[] = XML_START_TAG(CCBI_XML_TAG_STRING);
+static const char kStringEnd[] = XML_END_TAG(CCBI_XML_TAG_STRING) "\n";
+static const size_t kStringStartLength = sizeof(kStringStart) - 1;
+static const size_t kStringEndLength = sizeof(kStringEnd) - 1;
+
+/*the special bytes of xml character data besides the controls and non-ASCII*/
+typedef CCBIEscapeScanner<'<', '>', '&', '"', '\''> CCBIXMLScanner;
+
+static void append(vector<char> &out, const char *pBytes, size_t length)
+{
+	out.insert(out.end(), pBytes, pBytes + length);
+}
+
+/*************************************************************************
+Implementation of CCBIXMLStringTable
+*************************************************************************/
+CCBIXMLStringTable::CCBIXMLStringTable()
+{
+}
+
+void CCBIXMLStringTable::build(const CCBITree &tree)
+{
+	int count = tree.strings.size();
+
+	size_t total = 0;
+	for (int i = 0; i < count; i++)
+	{
+		total += tree.strings[i].length + kStringStartLength + kStringEndLength;
+	}
+
+	mBytes.clear();
+	mBytes.reserve(total);
+	mOffsets.resize(count + 1);
+
+	for (int i = 0; i < count; i++)
+	{
+		CCBIStringView string = tree.getString(i);
+
+		mOffsets[i] = mBytes.size();
+		append(mBytes, kStringStart, kStringStartLength);
+		escape(string.pChars, string.length, mBytes);
+		append(mBytes, kStringEnd, kStringEndLength);
+	}
+	mOffsets[count] = mBytes.size();
+}
+
+const char* CCBIXMLStringTable::getFragment(int index, size_t &length) const
+{
+	length = mOffsets[index + 1] - mOffsets[index];
+	return &mBytes[0] + mOffsets[index];
+}
+
+const char* CCBIXMLStringTable::getEscaped(int index, size_t &length) const
+{
+	length = mOffsets[index + 1] - mOffsets[index] - kStringStartLength - kStringEndLength;
+	return &mBytes[0] + mOffsets[index] + kStringStartLength;
+}
+
+int CCBIXMLStringTable::escapeSpecial(const char *pString, size_t length, size_t &pos, char *pText)
+{
+	unsigned char c = (unsigned char)pString[pos];
+	if (c >= 0x80)
+	{
+		/*a valid sequence is copied, anything else becomes U+FFFD like in a bplist*/
+		size_t start = pos;
+		unsigned int code = CCBIUTF8::decode((const unsigned char*)pString, length, pos);
+		if (kCCBIReplacementChar == code || 0xfffe == code || 0xffff == code)
+		{
+			/*U+FFFE and U+FFFF are no xml characters either*/
+			memcpy(pText, "\xef\xbf\xbd", 3);
+			return 3;
+		}
+		memcpy(pText, pString + start, pos - start);
+		return (int)(pos - start);
+	}
+
+	pos++;
+	switch (c)
+	{
+	case '<':
+		memcpy(pText, "&lt;", 4);
+		return 4;
+	case '>':
+		memcpy(pText, "&gt;", 4);
+		return 4;
+	case '&':
+		memcpy(pText, "&amp;", 5);
+		return 5;
+	case '"':
+		memcpy(pText, "&quot;", 6);
+		return 6;
+	case '\'':
+		memcpy(pText, "&apos;", 6);
+		return 6;
+	case '\t':
+	case '\n':
+		pText[0] = (char)c;
+		return 1;
+	case '\r':
+		/*a raw CR would be normalized away by the xml parser*/
+		memcpy(pText, "&#13;", 5);
+		return 5;
+	default:
+		/*not allowed in xml 1.0 at all, not even as a character reference*/
+		memcpy(pText, "\xef\xbf\xbd", 3);
+		return 3;
+	}
+}
+
+void CCBIXMLStringTable::escape(const char *pString, size_t length, vector<char> &out)
+{
+	CCBIVectorOutput output(out);
+	CCBIXMLScanner::escape<CCBIXMLStringTable>(pString, length, output);
+}
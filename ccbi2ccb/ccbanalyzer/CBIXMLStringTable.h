@@ -0,0 +1,56 @@
+#ifndef _CCBII_CCBIXMLStringTable_H_
+#define _CCBII_CCBIXMLStringTable_H_
+
+#include <stddef.h>
+#include <vector>
+
+#include "CBITree.h"
+
+/**
+* @brief The string cache of a tree, escaped and rendered as xml once
+*
+* Every entry is turned into its final "<string>...</string>\n" bytes up
+* front, so each use is a plain copy however often the entry is written.
+* '<', '>', '&', '"' and '\'' become entities, CR becomes "&#13;" and the
+* control characters xml 1.0 can not carry become U+FFFD, as does every
+* broken UTF-8 sequence.
+*/
+class CCBIXMLStringTable
+{
+private:
+	std::vector<char> mBytes;
+	/*start of entry i's fragment, plus one entry for the end*/
+	std::vector<size_t> mOffsets;
+
+public:
+	/*the longest escape of one byte, "&quot;", longer than any UTF-8 sequence*/
+	static const int kMaxEscapeLength = 6;
+
+	CCBIXMLStringTable();
+
+	void build(const CCBITree &tree);
+
+	/**
+	* @brief The whole "<string>...</string>\n" fragment of entry index
+	*/
+	const char* getFragment(int index, size_t &length) const;
+
+	/**
+	* @brief Only the escaped text of entry index
+	*/
+	const char* getEscaped(int index, size_t &length) const;
+
+	/**
+	* @brief Append pString escaped for xml character data to out
+	*/
+	static void escape(const char *pString, size_t length, std::vector<char> &out);
+
+	/**
+	* @brief Write the escape of the special byte at pos, or the UTF-8 sequence
+	* it starts, into pText and move pos past it
+	* @return its length, at most kMaxEscapeLength
+	*/
+	static int escapeSpecial(const char *pString, size_t length, size_t &pos, char *pText);
+};
+
+#endif
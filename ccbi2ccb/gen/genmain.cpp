@@ -0,0 +1,182 @@
+/*
+* usage: ccbigen [--nodes N] [--depth D] [--fanout F] [--properties P]
+*                [--mix Type=weight,...] [--strings S] [--sequences Q]
+*                [--animated percent] [--animated-properties A]
+*                [--keyframes K] [--js] [--seed N] [--files N] <out>
+*
+* Writes a random but valid version 5 ccbi to <out>, or with --files the
+* files gen0000.ccbi ... to the directory <out>, each with the next seed.
+*
+* The graph has N nodes (default 1000), handed out level by level with F
+* children per node (default 4) down to D levels (default 8): --fanout 1
+* --depth N is a chain. Each node has P properties (default 6) of the types
+* of --mix, named as CCBIMainPropTypeName does, e.g. Position=4,Text=0;
+* every type but CCBFile has a weight of 1 by default. percent of the
+* nodes (default 20) animate A properties (default 2) with K keyframes
+* (default 4) in each of the Q sequences (default 2). The string cache has
+* the names the file needs and enough file names to make S entries
+* (default 256).
+*/
+#include "../ccbanalyzer/CBIGenerator.h"
+#include "../ccbanalyzer/CBIWriter.h"
+#include "../util/file/ssFile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+
+using namespace std;
+
+static void printUsage()
+{
+	printf("usage: ccbigen [--nodes N] [--depth D] [--fanout F] [--properties P]\n");
+	printf("               [--mix Type=weight,...] [--strings S] [--sequences Q]\n");
+	printf("               [--animated percent] [--animated-properties A]\n");
+	printf("               [--keyframes K] [--js] [--seed N] [--files N] <out.ccbi | outdir>\n");
+}
+
+/*"Position=4,Text=0": weights of the named types, the others keep theirs*/
+static bool parseMix(const char *pMix, CCBIGeneratorOptions &options)
+{
+	string mix = pMix;
+	size_t start = 0;
+	while (start < mix.size()) {
+		size_t end = mix.find(',', start);
+		if (string::npos == end) {
+			end = mix.size();
+		}
+
+		string entry = mix.substr(start, end - start);
+		size_t equals = entry.find('=');
+		if (string::npos == equals) {
+			return false;
+		}
+
+		int type = CCBIMainPropTypeName::getPropType(entry.substr(0, equals).c_str());
+		if (-1 == type) {
+			printf("unknown property type %s\n", entry.substr(0, equals).c_str());
+			return false;
+		}
+		options.typeWeights[type] = atoi(entry.c_str() + equals + 1);
+
+		start = end + 1;
+	}
+	return true;
+}
+
+static bool generateFile(const CCBIGeneratorOptions &options, const string &path)
+{
+	CCBITree tree;
+	CCBIGenerator generator(options, tree);
+	if (!generator.generate()) {
+		printf("%s\n", generator.getError().c_str());
+		return false;
+	}
+
+	CCBIWriter writer;
+	if (!writer.writeTree(tree) || !writer.flushTo(path.c_str())) {
+		printf("%s: %s\n", path.c_str(), writer.getError().empty() ? "can not write the file" : writer.getError().c_str());
+		return false;
+	}
+
+	printf("%s: %d nodes, %d properties, %d keyframes, %d strings, %lu bytes\n", path.c_str(),
+		tree.nodes.size(), tree.properties.size(), tree.keyframes.size(), tree.strings.size(),
+		(unsigned long)writer.getLength());
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	CCBIGeneratorOptions options;
+	int numFiles = 0;
+	const char *pOut = NULL;
+
+	for (int i = 1; i < argc; i++) {
+		const char *pArg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (0 == strcmp(pArg, "--js")) {
+			options.jsControlled = true;
+		}
+		else if (0 == strcmp(pArg, "--nodes") && hasValue) {
+			options.numNodes = atoi(argv[++i]);
+		}
+		else if (0 == strcmp(pArg, "--depth") && hasValue) {
+			options.maxDepth = atoi(argv[++i]);
+		}
+		else if (0 == strcmp(pArg, "--fanout") && hasValue) {
+			options.fanOut = atoi(argv[++i]);
+		}
+		else if (0 == strcmp(pArg, "--properties") && hasValue) {
+			options.propertiesPerNode = atoi(argv[++i]);
+		}
+		else if (0 == strcmp(pArg, "--mix") && hasValue) {
+			if (!parseMix(argv[++i], options)) {
+				printUsage();
+				return 2;
+			}
+		}
+		else if (0 == strcmp(pArg, "--strings") && hasValue) {
+			options.numStrings = atoi(argv[++i]);
+		}
+		else if (0 == strcmp(pArg, "--sequences") && hasValue) {
+			options.numSequences = atoi(argv[++i]);
+		}
+		else if (0 == strcmp(pArg, "--animated") && hasValue) {
+			options.animatedPercent = atoi(argv[++i]);
+		}
+		else if (0 == strcmp(pArg, "--animated-properties") && hasValue) {
+			options.animatedPropertiesPerSequence = atoi(argv[++i]);
+		}
+		else if (0 == strcmp(pArg, "--keyframes") && hasValue) {
+			options.keyframesPerProperty = atoi(argv[++i]);
+		}
+		else if (0 == strcmp(pArg, "--seed") && hasValue) {
+			options.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+		}
+		else if (0 == strcmp(pArg, "--files") && hasValue) {
+			numFiles = atoi(argv[++i]);
+		}
+		else if (0 != strncmp(pArg, "--", 2) && NULL == pOut) {
+			pOut = pArg;
+		}
+		else {
+			printUsage();
+			return 2;
+		}
+	}
+
+	if (NULL == pOut) {
+		printUsage();
+		return 2;
+	}
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	if (0 == numFiles) {
+		if (!generateFile(options, pOut)) {
+			return 1;
+		}
+	}
+	else {
+		if (!SSMakeDirectories(pOut)) {
+			printf("%s: can not create the directory\n", pOut);
+			return 1;
+		}
+
+		for (int i = 0; i < numFiles; i++) {
+			char name[32];
+			sprintf(name, "gen%04d.ccbi", i);
+			if (!generateFile(options, SSJoinPath(pOut, name))) {
+				return 1;
+			}
+			options.seed++;
+		}
+	}
+
+	long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count();
+	printf("generated in %lld ms\n", ms);
+	return 0;
+}
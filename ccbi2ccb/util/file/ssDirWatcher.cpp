@@ -0,0 +1,339 @@
+#include "ssDirWatcher.h"
+#include "ssFile.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/inotify.h>
+#include <dirent.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/*notifications read at once*/
+static const size_t kBufferSize = 64 * 1024;
+
+void SSDirWatcher::addAllFiles(const string &dir, vector<string> &files)
+{
+	SSListFiles(dir, true, files);
+}
+
+#ifdef _WIN32
+
+SSDirWatcher::SSDirWatcher()
+: mDir(INVALID_HANDLE_VALUE)
+, mEvent(NULL)
+, mReading(false)
+{
+}
+
+SSDirWatcher::~SSDirWatcher()
+{
+	close();
+}
+
+bool SSDirWatcher::open(const string &dir)
+{
+	close();
+
+	mRoot = dir;
+	mDir = CreateFileA(dir.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+	if (INVALID_HANDLE_VALUE == mDir)
+	{
+		return false;
+	}
+
+	mEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+	mOverlapped.assign(sizeof(OVERLAPPED), 0);
+	mBuffer.resize(kBufferSize / sizeof(unsigned long));
+	if (NULL == mEvent || !start())
+	{
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void SSDirWatcher::close()
+{
+	if (INVALID_HANDLE_VALUE != mDir)
+	{
+		/*the pending read must be over before its buffer goes*/
+		if (mReading && CancelIo(mDir))
+		{
+			DWORD bytes;
+			GetOverlappedResult(mDir, (OVERLAPPED*)&mOverlapped[0], &bytes, TRUE);
+		}
+		mReading = false;
+		CloseHandle(mDir);
+		mDir = INVALID_HANDLE_VALUE;
+	}
+	if (NULL != mEvent)
+	{
+		CloseHandle(mEvent);
+		mEvent = NULL;
+	}
+}
+
+bool SSDirWatcher::start()
+{
+	OVERLAPPED *pOverlapped = (OVERLAPPED*)&mOverlapped[0];
+	memset(pOverlapped, 0, sizeof(OVERLAPPED));
+	pOverlapped->hEvent = mEvent;
+	ResetEvent(mEvent);
+
+	/*one handle watches the whole tree*/
+	mReading = FALSE != ReadDirectoryChangesW(mDir, &mBuffer[0], (DWORD)(mBuffer.size() * sizeof(unsigned long)), TRUE,
+		FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE,
+		NULL, pOverlapped, NULL);
+	return mReading;
+}
+
+bool SSDirWatcher::wait(int timeoutMs, vector<string> &files)
+{
+	if (!mReading)
+	{
+		return false;
+	}
+
+	DWORD result = WaitForSingleObject(mEvent, timeoutMs < 0 ? INFINITE : (DWORD)timeoutMs);
+	if (WAIT_TIMEOUT == result)
+	{
+		return true;
+	}
+	if (WAIT_OBJECT_0 != result)
+	{
+		return false;
+	}
+
+	mReading = false;
+	DWORD bytes = 0;
+	if (!GetOverlappedResult(mDir, (OVERLAPPED*)&mOverlapped[0], &bytes, FALSE))
+	{
+		if (ERROR_NOTIFY_ENUM_DIR != GetLastError())
+		{
+			return false;
+		}
+		bytes = 0;
+	}
+
+	if (0 == bytes)
+	{
+		/*the notifications did not fit and were dropped*/
+		addAllFiles(mRoot, files);
+	}
+	else
+	{
+		const char *pAt = (const char*)&mBuffer[0];
+		for (;;)
+		{
+			const FILE_NOTIFY_INFORMATION *pInfo = (const FILE_NOTIFY_INFORMATION*)pAt;
+			if (FILE_ACTION_ADDED == pInfo->Action || FILE_ACTION_MODIFIED == pInfo->Action
+				|| FILE_ACTION_RENAMED_NEW_NAME == pInfo->Action)
+			{
+				int wideLength = (int)(pInfo->FileNameLength / sizeof(WCHAR));
+				int length = WideCharToMultiByte(CP_ACP, 0, pInfo->FileName, wideLength, NULL, 0, NULL, NULL);
+				string name(length, '\0');
+				if (0 != length)
+				{
+					WideCharToMultiByte(CP_ACP, 0, pInfo->FileName, wideLength, &name[0], length, NULL, NULL);
+				}
+
+				string path = SSJoinPath(mRoot, name);
+				if (!SSIsDirectory(path))
+				{
+					files.push_back(path);
+				}
+				else if (FILE_ACTION_MODIFIED != pInfo->Action)
+				{
+					addAllFiles(path, files);
+				}
+			}
+
+			if (0 == pInfo->NextEntryOffset)
+			{
+				break;
+			}
+			pAt += pInfo->NextEntryOffset;
+		}
+	}
+
+	return start();
+}
+
+#else
+
+#ifdef __linux__
+/*a file is done when it is closed after a write or moved in; directories are followed as they come*/
+static const unsigned int kWatchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR;
+#endif
+
+SSDirWatcher::SSDirWatcher()
+: mFd(-1)
+{
+}
+
+SSDirWatcher::~SSDirWatcher()
+{
+	close();
+}
+
+bool SSDirWatcher::open(const string &dir)
+{
+	close();
+
+#ifdef __linux__
+	mRoot = dir;
+	mFd = inotify_init();
+	if (mFd < 0)
+	{
+		return false;
+	}
+
+	addTree(dir);
+	if (mDirs.empty())
+	{
+		close();
+		return false;
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+void SSDirWatcher::close()
+{
+#ifdef __linux__
+	if (mFd >= 0)
+	{
+		::close(mFd);
+		mFd = -1;
+	}
+#endif
+	mDirs.clear();
+}
+
+void SSDirWatcher::addTree(const string &dir)
+{
+#ifdef __linux__
+	/*depth first without recursion, a deep tree must not exhaust the stack*/
+	vector<string> pending(1, dir);
+	while (!pending.empty())
+	{
+		string path = pending.back();
+		pending.pop_back();
+
+		/*a directory watched already keeps its descriptor, under its new path*/
+		int wd = inotify_add_watch(mFd, path.c_str(), kWatchMask);
+		if (wd < 0)
+		{
+			continue;
+		}
+		mDirs[wd] = path;
+
+		DIR *handle = opendir(path.c_str());
+		if (NULL == handle)
+		{
+			continue;
+		}
+		struct dirent *entry;
+		while (NULL != (entry = readdir(handle)))
+		{
+			if (0 != strcmp(entry->d_name, ".") && 0 != strcmp(entry->d_name, ".."))
+			{
+				string child = SSJoinPath(path, entry->d_name);
+				if (SSIsDirectory(child))
+				{
+					pending.push_back(child);
+				}
+			}
+		}
+		closedir(handle);
+	}
+#endif
+}
+
+bool SSDirWatcher::wait(int timeoutMs, vector<string> &files)
+{
+#ifdef __linux__
+	if (mFd < 0)
+	{
+		return false;
+	}
+
+	struct pollfd fd;
+	fd.fd = mFd;
+	fd.events = POLLIN;
+	fd.revents = 0;
+	int ready = poll(&fd, 1, timeoutMs);
+	if (ready <= 0)
+	{
+		/*a signal only cuts the wait short*/
+		return 0 == ready || EINTR == errno;
+	}
+
+	mBuffer.resize(kBufferSize / sizeof(unsigned long));
+	ssize_t length = read(mFd, &mBuffer[0], mBuffer.size() * sizeof(unsigned long));
+	if (length <= 0)
+	{
+		return length < 0 && EINTR == errno;
+	}
+
+	const char *pAt = (const char*)&mBuffer[0];
+	const char *pEnd = pAt + length;
+	while (pAt < pEnd)
+	{
+		const struct inotify_event *pEvent = (const struct inotify_event*)pAt;
+		pAt += sizeof(struct inotify_event) + pEvent->len;
+
+		if (0 != (pEvent->mask & IN_Q_OVERFLOW))
+		{
+			/*the notifications did not fit and were dropped*/
+			addAllFiles(mRoot, files);
+			continue;
+		}
+		if (0 != (pEvent->mask & IN_IGNORED))
+		{
+			mDirs.erase(pEvent->wd);
+			continue;
+		}
+
+		map<int, string>::const_iterator it = mDirs.find(pEvent->wd);
+		if (it == mDirs.end() || 0 == pEvent->len)
+		{
+			continue;
+		}
+
+		string path = SSJoinPath(it->second, pEvent->name);
+		if (0 != (pEvent->mask & IN_ISDIR))
+		{
+			/*its files may be written before the watch is in place*/
+			addTree(path);
+			addAllFiles(path, files);
+		}
+		else if (0 != (pEvent->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)))
+		{
+			files.push_back(path);
+		}
+	}
+
+	/*the watched directory itself is gone*/
+	return !mDirs.empty();
+#else
+	return false;
+#endif
+}
+
+#endif
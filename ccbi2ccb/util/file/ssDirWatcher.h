@@ -0,0 +1,62 @@
+#ifndef __SSDIRWATCHER_H_
+#define __SSDIRWATCHER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+@brief Report the files written below a directory, as the system notifies them
+
+A file is reported when it is closed after a write or moved in; the files
+of a directory moved in are reported too. When the system drops
+notifications, every file below the directory is reported instead.
+inotify on Linux, ReadDirectoryChangesW on Windows; elsewhere open() fails.
+*/
+class SSDirWatcher
+{
+private:
+	std::string mRoot;
+	/*notifications as the system writes them, aligned for its records*/
+	std::vector<unsigned long> mBuffer;
+#ifdef _WIN32
+	void *mDir;
+	void *mEvent;
+	/*the OVERLAPPED of the read, pending while mReading*/
+	std::vector<char> mOverlapped;
+	bool mReading;
+#else
+	int mFd;
+	/*watched directory of each watch descriptor*/
+	std::map<int, std::string> mDirs;
+#endif
+
+public:
+	SSDirWatcher();
+	~SSDirWatcher();
+
+	/**
+	@brief Watch dir and every directory below it, now and created later
+	*/
+	bool open(const std::string &dir);
+	void close();
+
+	/**
+	@brief Wait up to timeoutMs (-1 for ever) and append the files written meanwhile
+	@return false if the watch is broken
+	*/
+	bool wait(int timeoutMs, std::vector<std::string> &files);
+
+private:
+#ifdef _WIN32
+	bool start();
+#else
+	void addTree(const std::string &dir);
+#endif
+	void addAllFiles(const std::string &dir, std::vector<std::string> &files);
+
+	SSDirWatcher(const SSDirWatcher&);
+	SSDirWatcher& operator=(const SSDirWatcher&);
+};
+
+#endif
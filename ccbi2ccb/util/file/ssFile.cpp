@@ -0,0 +1,463 @@
+#include "ssFile.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <direct.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static bool isSeparator(char c)
+{
+#ifdef _WIN32
+	return '/' == c || '\\' == c;
+#else
+	return '/' == c;
+#endif
+}
+
+static void splitPath(const string &path, vector<string> &parts)
+{
+	size_t start = 0;
+	for (size_t i = 0; i <= path.size(); i++)
+	{
+		if (i == path.size() || isSeparator(path[i]))
+		{
+			parts.push_back(path.substr(start, i - start));
+			start = i + 1;
+		}
+	}
+}
+
+/*entries of dir without "." and "..", sorted so every listing is deterministic*/
+static void listDirectory(const string &dir, vector<string> &names)
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	HANDLE find = FindFirstFileA(SSJoinPath(dir.empty() ? "." : dir, "*").c_str(), &data);
+	if (INVALID_HANDLE_VALUE == find)
+	{
+		return;
+	}
+	do
+	{
+		string name(data.cFileName);
+		if (name != "." && name != "..")
+		{
+			names.push_back(name);
+		}
+	} while (FindNextFileA(find, &data));
+	FindClose(find);
+#else
+	DIR *handle = opendir(dir.empty() ? "." : dir.c_str());
+	if (NULL == handle)
+	{
+		return;
+	}
+	struct dirent *entry;
+	while (NULL != (entry = readdir(handle)))
+	{
+		string name(entry->d_name);
+		if (name != "." && name != "..")
+		{
+			names.push_back(name);
+		}
+	}
+	closedir(handle);
+#endif
+
+	sort(names.begin(), names.end());
+}
+
+bool SSIsDirectory(const string &path)
+{
+	struct stat st;
+	return 0 == stat(path.c_str(), &st) && 0 != (st.st_mode & S_IFDIR);
+}
+
+bool SSIsFile(const string &path)
+{
+	struct stat st;
+	return 0 == stat(path.c_str(), &st) && 0 != (st.st_mode & S_IFREG);
+}
+
+bool SSListFiles(const string &dir, bool recursive, vector<string> &files)
+{
+	if (!SSIsDirectory(dir))
+	{
+		return false;
+	}
+
+	vector<string> names;
+	listDirectory(dir, names);
+
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		string path = SSJoinPath(dir, names[i]);
+		if (SSIsDirectory(path))
+		{
+			if (recursive)
+			{
+				SSListFiles(path, true, files);
+			}
+		}
+		else
+		{
+			files.push_back(path);
+		}
+	}
+
+	return true;
+}
+
+bool SSHasWildcard(const string &path)
+{
+	return string::npos != path.find_first_of("*?");
+}
+
+bool SSMatchWildcard(const char *pPattern, const char *pName)
+{
+	/*greedy match with a single backtrack point for the last '*'*/
+	const char *star = NULL;
+	const char *retry = NULL;
+
+	while ('\0' != *pName)
+	{
+		if ('*' == *pPattern)
+		{
+			star = pPattern++;
+			retry = pName;
+		}
+		else if ('?' == *pPattern || *pPattern == *pName)
+		{
+			pPattern++;
+			pName++;
+		}
+		else if (NULL != star)
+		{
+			pPattern = star + 1;
+			pName = ++retry;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	while ('*' == *pPattern)
+	{
+		pPattern++;
+	}
+
+	return '\0' == *pPattern;
+}
+
+static void expandGlob(const string &base, const vector<string> &parts, size_t index, vector<string> &files)
+{
+	if (index == parts.size())
+	{
+		if (SSIsFile(base))
+		{
+			files.push_back(base);
+		}
+		return;
+	}
+
+	const string &part = parts[index];
+	if ("**" == part)
+	{
+		/*zero directories, then every sub directory at any depth*/
+		expandGlob(base, parts, index + 1, files);
+
+		vector<string> names;
+		listDirectory(base, names);
+		for (size_t i = 0; i < names.size(); i++)
+		{
+			string path = SSJoinPath(base, names[i]);
+			if (SSIsDirectory(path))
+			{
+				expandGlob(path, parts, index, files);
+			}
+		}
+	}
+	else if (SSHasWildcard(part))
+	{
+		vector<string> names;
+		listDirectory(base, names);
+		for (size_t i = 0; i < names.size(); i++)
+		{
+			if (SSMatchWildcard(part.c_str(), names[i].c_str()))
+			{
+				expandGlob(SSJoinPath(base, names[i]), parts, index + 1, files);
+			}
+		}
+	}
+	else
+	{
+		expandGlob(base.empty() && part.empty() ? "/" : SSJoinPath(base, part), parts, index + 1, files);
+	}
+}
+
+void SSExpandGlob(const string &pattern, vector<string> &files)
+{
+	vector<string> parts;
+	splitPath(pattern, parts);
+
+	/*an absolute pattern keeps its leading separator through the empty first part*/
+	if (!parts.empty() && parts[0].empty())
+	{
+		parts.erase(parts.begin());
+		expandGlob("/", parts, 0, files);
+		return;
+	}
+
+	expandGlob("", parts, 0, files);
+}
+
+bool SSMakeDirectories(const string &dir)
+{
+	if (dir.empty() || SSIsDirectory(dir))
+	{
+		return true;
+	}
+
+	string parent = SSDirName(dir);
+	if (parent != dir && !SSMakeDirectories(parent))
+	{
+		return false;
+	}
+
+#ifdef _WIN32
+	int result = _mkdir(dir.c_str());
+#else
+	int result = mkdir(dir.c_str(), 0755);
+#endif
+
+	/*another worker may have created it in the meantime*/
+	return 0 == result || (EEXIST == errno && SSIsDirectory(dir));
+}
+
+bool SSReadLines(const string &path, vector<string> &lines)
+{
+	ifstream in(path.c_str());
+	if (!in.is_open())
+	{
+		return false;
+	}
+
+	string line;
+	while (getline(in, line))
+	{
+		while (!line.empty() && ('\r' == line[line.size() - 1] || ' ' == line[line.size() - 1]))
+		{
+			line.erase(line.size() - 1);
+		}
+		if (!line.empty())
+		{
+			lines.push_back(line);
+		}
+	}
+
+	return true;
+}
+
+bool SSReadFile(const string &path, string &content)
+{
+	ifstream in(path.c_str(), ios::in | ios::binary);
+	if (!in.is_open())
+	{
+		return false;
+	}
+
+	in.seekg(0, ios::end);
+	streamoff length = in.tellg();
+	if (length < 0)
+	{
+		return false;
+	}
+	in.seekg(0, ios::beg);
+
+	content.resize((size_t)length);
+	if (0 != length)
+	{
+		in.read(&content[0], length);
+	}
+
+	return !in.fail();
+}
+
+bool SSFilesEqual(const string &a, const string &b)
+{
+	struct stat stA;
+	struct stat stB;
+	if (0 != stat(a.c_str(), &stA) || 0 != stat(b.c_str(), &stB) || stA.st_size != stB.st_size)
+	{
+		return false;
+	}
+
+	ifstream inA(a.c_str(), ios::in | ios::binary);
+	ifstream inB(b.c_str(), ios::in | ios::binary);
+	if (!inA.is_open() || !inB.is_open())
+	{
+		return false;
+	}
+
+	char bufferA[64 * 1024];
+	char bufferB[64 * 1024];
+	for (;;)
+	{
+		inA.read(bufferA, sizeof(bufferA));
+		inB.read(bufferB, sizeof(bufferB));
+		streamsize count = inA.gcount();
+		if (count != inB.gcount() || 0 != memcmp(bufferA, bufferB, (size_t)count))
+		{
+			return false;
+		}
+		if (0 == count)
+		{
+			return true;
+		}
+	}
+}
+
+bool SSCopyFile(const string &src, const string &dst)
+{
+	ifstream in(src.c_str(), ios::in | ios::binary);
+	if (!in.is_open())
+	{
+		return false;
+	}
+
+	ofstream out(dst.c_str(), ios::out | ios::binary | ios::trunc);
+	if (!out.is_open())
+	{
+		return false;
+	}
+
+	/*streaming an empty file would flag the output as failed*/
+	if (EOF != in.peek())
+	{
+		out << in.rdbuf();
+	}
+	out.close();
+
+	return !out.fail();
+}
+
+bool SSLinkFile(const string &src, const string &dst)
+{
+#ifdef _WIN32
+	return 0 != CreateHardLinkA(dst.c_str(), src.c_str(), NULL);
+#else
+	return 0 == link(src.c_str(), dst.c_str());
+#endif
+}
+
+bool SSReplaceFile(const string &src, const string &dst)
+{
+#ifdef _WIN32
+	return 0 != MoveFileExA(src.c_str(), dst.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+	return 0 == rename(src.c_str(), dst.c_str());
+#endif
+}
+
+bool SSRemoveFile(const string &path)
+{
+	return 0 == remove(path.c_str());
+}
+
+string SSNormalizePath(const string &path)
+{
+	vector<string> parts;
+	splitPath(path, parts);
+
+	vector<string> kept;
+	for (size_t i = 0; i < parts.size(); i++)
+	{
+		if ("." == parts[i] || (parts[i].empty() && 0 != i))
+		{
+			continue;
+		}
+		if (".." == parts[i] && !kept.empty() && ".." != kept.back() && !kept.back().empty())
+		{
+			kept.pop_back();
+			continue;
+		}
+		kept.push_back(parts[i]);
+	}
+
+	string normalized;
+	for (size_t i = 0; i < kept.size(); i++)
+	{
+		if (0 != i)
+		{
+			normalized += '/';
+		}
+		normalized += kept[i];
+	}
+
+	/*"/" alone splits into one empty part*/
+	if (1 == kept.size() && kept[0].empty())
+	{
+		return "/";
+	}
+	return normalized.empty() ? "." : normalized;
+}
+
+string SSDirName(const string &path)
+{
+	size_t i = path.size();
+	while (i > 0 && !isSeparator(path[i - 1]))
+	{
+		i--;
+	}
+
+	if (0 == i)
+	{
+		return "";
+	}
+	if (1 == i)
+	{
+		return path.substr(0, 1);
+	}
+	return path.substr(0, i - 1);
+}
+
+string SSBaseName(const string &path)
+{
+	size_t i = path.size();
+	while (i > 0 && !isSeparator(path[i - 1]))
+	{
+		i--;
+	}
+	return path.substr(i);
+}
+
+string SSJoinPath(const string &dir, const string &name)
+{
+	if (dir.empty() || "." == dir)
+	{
+		return name;
+	}
+	if (isSeparator(dir[dir.size() - 1]))
+	{
+		return dir + name;
+	}
+	return dir + "/" + name;
+}
@@ -0,0 +1,71 @@
+#ifndef __SSFILE_H_
+#define __SSFILE_H_
+
+#include <string>
+#include <vector>
+
+/**
+@brief Small portable file system helpers, paths use '/' (and '\' on Windows)
+*/
+bool SSIsDirectory(const std::string &path);
+bool SSIsFile(const std::string &path);
+
+/**
+@brief Append the regular files below dir to files, sorted by name at each level
+*/
+bool SSListFiles(const std::string &dir, bool recursive, std::vector<std::string> &files);
+
+/**
+@brief Expand a pattern with '*', '?' and '**' (any number of directories)
+*/
+void SSExpandGlob(const std::string &pattern, std::vector<std::string> &files);
+bool SSHasWildcard(const std::string &path);
+bool SSMatchWildcard(const char *pPattern, const char *pName);
+
+/**
+@brief Create dir and every missing parent of it
+*/
+bool SSMakeDirectories(const std::string &dir);
+
+/**
+@brief Read the non-empty lines of a text file, without line ends
+*/
+bool SSReadLines(const std::string &path, std::vector<std::string> &lines);
+
+/**
+@brief Read a whole file as bytes
+*/
+bool SSReadFile(const std::string &path, std::string &content);
+
+/**
+@brief True if both files exist and hold the same bytes
+*/
+bool SSFilesEqual(const std::string &a, const std::string &b);
+
+/**
+@brief Copy the bytes of src to dst, replacing dst
+*/
+bool SSCopyFile(const std::string &src, const std::string &dst);
+
+/**
+@brief Make dst a hard link to src; fails if dst exists or the file system can not link
+*/
+bool SSLinkFile(const std::string &src, const std::string &dst);
+
+/**
+@brief Move src over dst in one step, replacing dst (and not writing into it)
+*/
+bool SSReplaceFile(const std::string &src, const std::string &dst);
+
+bool SSRemoveFile(const std::string &path);
+
+/**
+@brief Drop the "." components and fold "dir/.." pairs, so one file has one spelling
+*/
+std::string SSNormalizePath(const std::string &path);
+
+std::string SSDirName(const std::string &path);
+std::string SSBaseName(const std::string &path);
+std::string SSJoinPath(const std::string &dir, const std::string &name);
+
+#endif
@@ -0,0 +1,108 @@
+#include "ssHash.h"
+
+static const unsigned long long kPrime1 = 11400714785074694791ULL;
+static const unsigned long long kPrime2 = 14029467366897019727ULL;
+static const unsigned long long kPrime3 = 1609587929392839161ULL;
+static const unsigned long long kPrime4 = 9650029242287828579ULL;
+static const unsigned long long kPrime5 = 2870177450012600261ULL;
+
+static unsigned long long rotateLeft(unsigned long long value, int count)
+{
+	return (value << count) | (value >> (64 - count));
+}
+
+/*little endian loads, so a hash does not depend on the host*/
+static unsigned long long load64(const unsigned char *p)
+{
+	return (unsigned long long)p[0] | ((unsigned long long)p[1] << 8)
+		| ((unsigned long long)p[2] << 16) | ((unsigned long long)p[3] << 24)
+		| ((unsigned long long)p[4] << 32) | ((unsigned long long)p[5] << 40)
+		| ((unsigned long long)p[6] << 48) | ((unsigned long long)p[7] << 56);
+}
+
+static unsigned long long load32(const unsigned char *p)
+{
+	return (unsigned long long)p[0] | ((unsigned long long)p[1] << 8)
+		| ((unsigned long long)p[2] << 16) | ((unsigned long long)p[3] << 24);
+}
+
+static unsigned long long hashRound(unsigned long long acc, unsigned long long input)
+{
+	acc += input * kPrime2;
+	acc = rotateLeft(acc, 31);
+	return acc * kPrime1;
+}
+
+static unsigned long long mergeRound(unsigned long long acc, unsigned long long value)
+{
+	acc ^= hashRound(0, value);
+	return acc * kPrime1 + kPrime4;
+}
+
+unsigned long long SSHash64(const void *pBytes, size_t length, unsigned long long seed)
+{
+	const unsigned char *p = (const unsigned char*)pBytes;
+	const unsigned char *end = p + length;
+	unsigned long long hash;
+
+	if (length >= 32)
+	{
+		/*four independent lanes over 32 byte stripes*/
+		unsigned long long v1 = seed + kPrime1 + kPrime2;
+		unsigned long long v2 = seed + kPrime2;
+		unsigned long long v3 = seed;
+		unsigned long long v4 = seed - kPrime1;
+
+		const unsigned char *limit = end - 32;
+		do
+		{
+			v1 = hashRound(v1, load64(p));
+			v2 = hashRound(v2, load64(p + 8));
+			v3 = hashRound(v3, load64(p + 16));
+			v4 = hashRound(v4, load64(p + 24));
+			p += 32;
+		} while (p <= limit);
+
+		hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+		hash = mergeRound(hash, v1);
+		hash = mergeRound(hash, v2);
+		hash = mergeRound(hash, v3);
+		hash = mergeRound(hash, v4);
+	}
+	else
+	{
+		hash = seed + kPrime5;
+	}
+
+	hash += (unsigned long long)length;
+
+	while (p + 8 <= end)
+	{
+		hash ^= hashRound(0, load64(p));
+		hash = rotateLeft(hash, 27) * kPrime1 + kPrime4;
+		p += 8;
+	}
+
+	if (p + 4 <= end)
+	{
+		hash ^= load32(p) * kPrime1;
+		hash = rotateLeft(hash, 23) * kPrime2 + kPrime3;
+		p += 4;
+	}
+
+	while (p < end)
+	{
+		hash ^= (*p) * kPrime5;
+		hash = rotateLeft(hash, 11) * kPrime1;
+		p++;
+	}
+
+	/*final avalanche*/
+	hash ^= hash >> 33;
+	hash *= kPrime2;
+	hash ^= hash >> 29;
+	hash *= kPrime3;
+	hash ^= hash >> 32;
+
+	return hash;
+}
@@ -0,0 +1,11 @@
+#ifndef __SSHASH_H_
+#define __SSHASH_H_
+
+#include <stddef.h>
+
+/**
+@brief 64 bit XXH64 hash of a byte range, the same on every host
+*/
+unsigned long long SSHash64(const void *pBytes, size_t length, unsigned long long seed = 0);
+
+#endif
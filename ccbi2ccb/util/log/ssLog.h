@@ -10,7 +10,4 @@ static const int kMaxLogLen = 16 * 1024;
 */
 void SSLog(const char * pszFormat, ...);
 
-
-#define ASSERT_FAIL_UNEXPECTED_PROPERTYTYPE(PROPERTYTYPE) SSLog("Unexpected property type: '%d'!\n", PROPERTYTYPE); assert(false)
-
 #endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "ssWorkerPool.h"
+
+using namespace std;
+
+SSWorkerPool::SSWorkerPool(int numThreads)
+: mRunning(0)
+, mStopping(false)
+{
+	if (numThreads <= 0)
+	{
+		numThreads = getDefaultThreadCount();
+	}
+
+	for (int i = 0; i < numThreads; i++)
+	{
+		mThreads.push_back(thread(&SSWorkerPool::workerLoop, this));
+	}
+}
+
+SSWorkerPool::~SSWorkerPool()
+{
+	{
+		lock_guard<mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mTaskReady.notify_all();
+
+	for (size_t i = 0; i < mThreads.size(); i++)
+	{
+		mThreads[i].join();
+	}
+}
+
+void SSWorkerPool::submit(const function<void()> &task)
+{
+	{
+		lock_guard<mutex> lock(mMutex);
+		mTasks.push_back(task);
+	}
+	mTaskReady.notify_one();
+}
+
+void SSWorkerPool::wait()
+{
+	unique_lock<mutex> lock(mMutex);
+	while (!mTasks.empty() || 0 != mRunning)
+	{
+		mAllDone.wait(lock);
+	}
+}
+
+int SSWorkerPool::getThreadCount() const
+{
+	return (int)mThreads.size();
+}
+
+int SSWorkerPool::getDefaultThreadCount()
+{
+	int count = (int)thread::hardware_concurrency();
+	return count > 0 ? count : 1;
+}
+
+void SSWorkerPool::workerLoop()
+{
+	unique_lock<mutex> lock(mMutex);
+	for (;;)
+	{
+		while (mTasks.empty() && !mStopping)
+		{
+			mTaskReady.wait(lock);
+		}
+		if (mTasks.empty())
+		{
+			/*stopping and nothing left to run*/
+			return;
+		}
+
+		function<void()> task = mTasks.front();
+		mTasks.pop_front();
+		mRunning++;
+
+		lock.unlock();
+		task();
+		lock.lock();
+
+		mRunning--;
+		if (mTasks.empty() && 0 == mRunning)
+		{
+			mAllDone.notify_all();
+		}
+	}
+}
@@ -0,0 +1,50 @@
+#ifndef __SSWORKERPOOL_H_
+#define __SSWORKERPOOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+@brief Fixed set of worker threads running queued tasks in submission order
+*/
+class SSWorkerPool
+{
+private:
+	std::vector<std::thread> mThreads;
+	std::deque<std::function<void()> > mTasks;
+	std::mutex mMutex;
+	std::condition_variable mTaskReady;
+	std::condition_variable mAllDone;
+	int mRunning;
+	bool mStopping;
+
+public:
+	/**
+	@param numThreads number of workers, 0 for one per hardware thread
+	*/
+	explicit SSWorkerPool(int numThreads = 0);
+	~SSWorkerPool();
+
+	void submit(const std::function<void()> &task);
+
+	/**
+	@brief Block until the queue is empty and no task is running
+	*/
+	void wait();
+
+	int getThreadCount() const;
+
+	static int getDefaultThreadCount();
+
+private:
+	void workerLoop();
+
+	SSWorkerPool(const SSWorkerPool&);
+	SSWorkerPool& operator=(const SSWorkerPool&);
+};
+
+#endif